@@ -0,0 +1,1278 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Reproducible benchmarks with small synthetic guest payloads.
+ *
+ *		Instead of booting the guest's own software, the machine is
+ *		reset and a tiny real-mode payload is loaded at 0000:7C00
+ *		and started, bypassing the BIOS. Each payload exercises one
+ *		subsystem in an endless loop, and writes a zero to port E9H
+ *		when it has done one "unit" of work (a fixed number of
+ *		instructions, or bytes moved), or 0xFF if it has to give up.
+ *
+ *		We run in max-speed mode for a fixed number of frames (so,
+ *		a fixed amount of emulated time) after a short warm-up, and
+ *		report how long that took on the host, along with the work
+ *		rate in MIPS or MB/s. The statistics registry is cleared at
+ *		the start of the measurement, so a statistics file gives the
+ *		detailed counters for the measured part only.
+ *
+ *		The devices the payloads need are set up here, using the
+ *		usual default resources: a VGA, an IDE disk on the primary
+ *		channel, a Sound Blaster at 220H/DMA 1, and an NE2000 at
+ *		300H. The configuration file decides on the rest.
+ *
+ *		The "ops" benchmark instead times a list of single opcodes
+ *		(and a few short sequences), each one in a loop of its own,
+ *		and reports the host time per instruction. Given the output
+ *		of an earlier run as a baseline, it flags tests that became
+ *		slower by more than OPS_SLOWER percent.
+ *
+ * Version:	@(#)bench.c	1.0.5	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ *		Redistribution and  use  in source  and binary forms, with
+ *		or  without modification, are permitted  provided that the
+ *		following conditions are met:
+ *
+ *		1. Redistributions of  source  code must retain the entire
+ *		   above notice, this list of conditions and the following
+ *		   disclaimer.
+ *
+ *		2. Redistributions in binary form must reproduce the above
+ *		   copyright  notice,  this list  of  conditions  and  the
+ *		   following disclaimer in  the documentation and/or other
+ *		   materials provided with the distribution.
+ *
+ *		3. Neither the  name of the copyright holder nor the names
+ *		   of  its  contributors may be used to endorse or promote
+ *		   products  derived from  this  software without specific
+ *		   prior written permission.
+ *
+ * THIS SOFTWARE  IS  PROVIDED BY THE  COPYRIGHT  HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND  ANY EXPRESS  OR  IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE  ARE  DISCLAIMED. IN  NO  EVENT  SHALL THE COPYRIGHT
+ * HOLDER OR  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL,  EXEMPLARY,  OR  CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES;  LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON  ANY
+ * THEORY OF  LIABILITY, WHETHER IN  CONTRACT, STRICT  LIABILITY, OR  TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING  IN ANY  WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <wchar.h>
+#include "emu.h"
+#include "bench.h"
+#include "stats.h"
+#include "cpu/cpu.h"
+#include "cpu/x86.h"
+#include "cpu/x86_ops.h"
+#include "machines/machine.h"
+#include "io.h"
+#include "mem.h"
+#ifdef USE_DYNAREC
+# include "cpu/codegen.h"
+#endif
+#include "plat.h"
+
+
+typedef struct {
+    const char	*name;
+    const char	*descr;
+    const uint8_t *code;			/* guest code of payload */
+    int		size;
+    void	(*setup)(void);			/* set up devices for it */
+    uint32_t	unit;				/* instructions or bytes */
+    int		mips;				/* unit is instructions */
+} bench_t;
+
+
+/* All vectors point here, so any exception or NMI aborts the run. */
+static const uint8_t bench_trap[] = {
+    0xb0, 0xff,				/* 0600: mov al,0ffh */
+    0xe6, 0xe9,				/* 0602: out 0e9h,al */
+    0xf4,				/* 0604: hlt */
+    0xeb, 0xfd				/* 0605: jmp 0604h */
+};
+
+static const uint8_t bench_cpu[] = {
+    0xfa,				/* 7c00: cli */
+    0x31, 0xc0,				/* 7c01: xor ax,ax */
+    0x8e, 0xd0,				/* 7c03: mov ss,ax */
+    0xbc, 0x00, 0x7c,			/* 7c05: mov sp,7c00h */
+    0x8e, 0xd8,				/* 7c08: mov ds,ax */
+    0x8e, 0xc0,				/* 7c0a: mov es,ax */
+    0xb9, 0x10, 0x27,			/* 7c0c: mov cx,2710h */
+    0x01, 0xd8,				/* 7c0f: add ax,bx */
+    0x31, 0xc3,				/* 7c11: xor bx,ax */
+    0x46,				/* 7c13: inc si */
+    0x4f,				/* 7c14: dec di */
+    0xe2, 0xf8,				/* 7c15: loop 7c0fh */
+    0xb0, 0x00,				/* 7c17: mov al,0 */
+    0xe6, 0xe9,				/* 7c19: out 0e9h,al */
+    0xeb, 0xef,				/* 7c1b: jmp 7c0ch */
+};
+
+static const uint8_t bench_fpu[] = {
+    0xfa,				/* 7c00: cli */
+    0x31, 0xc0,				/* 7c01: xor ax,ax */
+    0x8e, 0xd0,				/* 7c03: mov ss,ax */
+    0xbc, 0x00, 0x7c,			/* 7c05: mov sp,7c00h */
+    0x8e, 0xd8,				/* 7c08: mov ds,ax */
+    0x8e, 0xc0,				/* 7c0a: mov es,ax */
+    0xdb, 0xe3,				/* 7c0c: fninit */
+    0xc7, 0x06, 0x00, 0x7e, 0x5a, 0x5a,	/* 7c0e: mov word [7e00h],5a5ah */
+    0xdd, 0x3e, 0x00, 0x7e,		/* 7c14: fnstsw [7e00h] */
+    0x80, 0x3e, 0x00, 0x7e, 0x00,	/* 7c18: cmp byte [7e00h],0 */
+    0x75, 0x17,				/* 7c1d: jne 7c36h */
+    0xd9, 0xe8,				/* 7c1f: fld1 */
+    0xd9, 0xee,				/* 7c21: fldz */
+    0xb9, 0x10, 0x27,			/* 7c23: mov cx,2710h */
+    0xd8, 0xc1,				/* 7c26: fadd st,st(1) */
+    0xd9, 0xc0,				/* 7c28: fld st(0) */
+    0xd9, 0xfa,				/* 7c2a: fsqrt */
+    0xdd, 0xd8,				/* 7c2c: fstp st(0) */
+    0xe2, 0xf6,				/* 7c2e: loop 7c26h */
+    0xb0, 0x00,				/* 7c30: mov al,0 */
+    0xe6, 0xe9,				/* 7c32: out 0e9h,al */
+    0xeb, 0xed,				/* 7c34: jmp 7c23h */
+    0xb0, 0xff,				/* 7c36: mov al,0ffh */
+    0xe6, 0xe9,				/* 7c38: out 0e9h,al */
+    0xf4,				/* 7c3a: hlt */
+    0xeb, 0xfd,				/* 7c3b: jmp 7c3ah */
+};
+
+static const uint8_t bench_vga[] = {
+    0xfa,				/* 7c00: cli */
+    0x31, 0xc0,				/* 7c01: xor ax,ax */
+    0x8e, 0xd0,				/* 7c03: mov ss,ax */
+    0xbc, 0x00, 0x7c,			/* 7c05: mov sp,7c00h */
+    0xfc,				/* 7c08: cld */
+    0xb8, 0x00, 0xa0,			/* 7c09: mov ax,0a000h */
+    0x8e, 0xc0,				/* 7c0c: mov es,ax */
+    0x30, 0xdb,				/* 7c0e: xor bl,bl */
+    0x31, 0xff,				/* 7c10: xor di,di */
+    0x88, 0xd8,				/* 7c12: mov al,bl */
+    0x88, 0xdc,				/* 7c14: mov ah,bl */
+    0xb9, 0x00, 0x7d,			/* 7c16: mov cx,7d00h */
+    0xf3, 0xab,				/* 7c19: rep stosw */
+    0xfe, 0xc3,				/* 7c1b: inc bl */
+    0xb0, 0x00,				/* 7c1d: mov al,0 */
+    0xe6, 0xe9,				/* 7c1f: out 0e9h,al */
+    0xeb, 0xed,				/* 7c21: jmp 7c10h */
+};
+
+static const uint8_t bench_ide[] = {
+    0xfa,				/* 7c00: cli */
+    0x31, 0xc0,				/* 7c01: xor ax,ax */
+    0x8e, 0xd0,				/* 7c03: mov ss,ax */
+    0xbc, 0x00, 0x7c,			/* 7c05: mov sp,7c00h */
+    0x8e, 0xd8,				/* 7c08: mov ds,ax */
+    0x8e, 0xc0,				/* 7c0a: mov es,ax */
+    0xfc,				/* 7c0c: cld */
+    0x31, 0xdb,				/* 7c0d: xor bx,bx */
+    0xba, 0xf2, 0x01,			/* 7c0f: mov dx,1f2h */
+    0xb0, 0x80,				/* 7c12: mov al,80h */
+    0xee,				/* 7c14: out dx,al */
+    0x42,				/* 7c15: inc dx */
+    0x88, 0xd8,				/* 7c16: mov al,bl */
+    0xee,				/* 7c18: out dx,al */
+    0x42,				/* 7c19: inc dx */
+    0x88, 0xf8,				/* 7c1a: mov al,bh */
+    0xee,				/* 7c1c: out dx,al */
+    0x42,				/* 7c1d: inc dx */
+    0x30, 0xc0,				/* 7c1e: xor al,al */
+    0xee,				/* 7c20: out dx,al */
+    0x42,				/* 7c21: inc dx */
+    0xb0, 0xe0,				/* 7c22: mov al,0e0h */
+    0xee,				/* 7c24: out dx,al */
+    0x42,				/* 7c25: inc dx */
+    0xb0, 0x20,				/* 7c26: mov al,20h */
+    0xee,				/* 7c28: out dx,al */
+    0xbd, 0x80, 0x00,			/* 7c29: mov bp,80h */
+    0xba, 0xf7, 0x01,			/* 7c2c: mov dx,1f7h */
+    0xec,				/* 7c2f: in al,dx */
+    0xa8, 0x80,				/* 7c30: test al,80h */
+    0x75, 0xfb,				/* 7c32: jne 7c2fh */
+    0xa8, 0x01,				/* 7c34: test al,1 */
+    0x75, 0x1c,				/* 7c36: jne 7c54h */
+    0xa8, 0x08,				/* 7c38: test al,8 */
+    0x74, 0xf3,				/* 7c3a: je 7c2fh */
+    0xba, 0xf0, 0x01,			/* 7c3c: mov dx,1f0h */
+    0xbf, 0x00, 0x80,			/* 7c3f: mov di,8000h */
+    0xb9, 0x00, 0x01,			/* 7c42: mov cx,100h */
+    0xf3, 0x6d,				/* 7c45: rep insw */
+    0x4d,				/* 7c47: dec bp */
+    0x75, 0xe2,				/* 7c48: jne 7c2ch */
+    0x81, 0xc3, 0x80, 0x00,		/* 7c4a: add bx,80h */
+    0xb0, 0x00,				/* 7c4e: mov al,0 */
+    0xe6, 0xe9,				/* 7c50: out 0e9h,al */
+    0xeb, 0xbb,				/* 7c52: jmp 7c0fh */
+    0x09, 0xdb,				/* 7c54: or bx,bx */
+    0x74, 0x04,				/* 7c56: je 7c5ch */
+    0x31, 0xdb,				/* 7c58: xor bx,bx */
+    0xeb, 0xb3,				/* 7c5a: jmp 7c0fh */
+    0xb0, 0xff,				/* 7c5c: mov al,0ffh */
+    0xe6, 0xe9,				/* 7c5e: out 0e9h,al */
+    0xf4,				/* 7c60: hlt */
+    0xeb, 0xfd,				/* 7c61: jmp 7c60h */
+};
+
+static const uint8_t bench_sb[] = {
+    0xfa,				/* 7c00: cli */
+    0x31, 0xc0,				/* 7c01: xor ax,ax */
+    0x8e, 0xd0,				/* 7c03: mov ss,ax */
+    0xbc, 0x00, 0x7c,			/* 7c05: mov sp,7c00h */
+    0xbb, 0xff, 0xff,			/* 7c08: mov bx,0ffffh */
+    0xe6, 0x0c,				/* 7c0b: out 0ch,al */
+    0xe4, 0x03,				/* 7c0d: in al,3 */
+    0x88, 0xc4,				/* 7c0f: mov ah,al */
+    0xe4, 0x03,				/* 7c11: in al,3 */
+    0x86, 0xc4,				/* 7c13: xchg ah,al */
+    0x39, 0xd8,				/* 7c15: cmp ax,bx */
+    0x89, 0xc3,				/* 7c17: mov bx,ax */
+    0x76, 0xf0,				/* 7c19: jbe 7c0bh */
+    0xb0, 0x00,				/* 7c1b: mov al,0 */
+    0xe6, 0xe9,				/* 7c1d: out 0e9h,al */
+    0xeb, 0xea,				/* 7c1f: jmp 7c0bh */
+};
+
+static const uint8_t bench_net[] = {
+    0xfa,				/* 7c00: cli */
+    0x31, 0xc0,				/* 7c01: xor ax,ax */
+    0x8e, 0xd0,				/* 7c03: mov ss,ax */
+    0xbc, 0x00, 0x7c,			/* 7c05: mov sp,7c00h */
+    0x8e, 0xd8,				/* 7c08: mov ds,ax */
+    0x8e, 0xc0,				/* 7c0a: mov es,ax */
+    0xfc,				/* 7c0c: cld */
+    0xba, 0x0a, 0x03,			/* 7c0d: mov dx,30ah */
+    0xb0, 0xea,				/* 7c10: mov al,0eah */
+    0xee,				/* 7c12: out dx,al */
+    0x42,				/* 7c13: inc dx */
+    0xb0, 0x05,				/* 7c14: mov al,5 */
+    0xee,				/* 7c16: out dx,al */
+    0xba, 0x08, 0x03,			/* 7c17: mov dx,308h */
+    0x30, 0xc0,				/* 7c1a: xor al,al */
+    0xee,				/* 7c1c: out dx,al */
+    0x42,				/* 7c1d: inc dx */
+    0xb0, 0x40,				/* 7c1e: mov al,40h */
+    0xee,				/* 7c20: out dx,al */
+    0xba, 0x00, 0x03,			/* 7c21: mov dx,300h */
+    0xb0, 0x12,				/* 7c24: mov al,12h */
+    0xee,				/* 7c26: out dx,al */
+    0xba, 0x10, 0x03,			/* 7c27: mov dx,310h */
+    0xbe, 0x00, 0x90,			/* 7c2a: mov si,9000h */
+    0xb9, 0xf5, 0x02,			/* 7c2d: mov cx,2f5h */
+    0xf3, 0x6f,				/* 7c30: rep outsw */
+    0xb4, 0x40,				/* 7c32: mov ah,40h */
+    0xe8, 0x58, 0x00,			/* 7c34: call 7c8fh */
+    0xba, 0x05, 0x03,			/* 7c37: mov dx,305h */
+    0xb0, 0xea,				/* 7c3a: mov al,0eah */
+    0xee,				/* 7c3c: out dx,al */
+    0x42,				/* 7c3d: inc dx */
+    0xb0, 0x05,				/* 7c3e: mov al,5 */
+    0xee,				/* 7c40: out dx,al */
+    0xba, 0x00, 0x03,			/* 7c41: mov dx,300h */
+    0xb0, 0x26,				/* 7c44: mov al,26h */
+    0xee,				/* 7c46: out dx,al */
+    0xb4, 0x01,				/* 7c47: mov ah,1 */
+    0xe8, 0x43, 0x00,			/* 7c49: call 7c8fh */
+    0xba, 0x0a, 0x03,			/* 7c4c: mov dx,30ah */
+    0xb0, 0xee,				/* 7c4f: mov al,0eeh */
+    0xee,				/* 7c51: out dx,al */
+    0x42,				/* 7c52: inc dx */
+    0xb0, 0x05,				/* 7c53: mov al,5 */
+    0xee,				/* 7c55: out dx,al */
+    0xba, 0x08, 0x03,			/* 7c56: mov dx,308h */
+    0x30, 0xc0,				/* 7c59: xor al,al */
+    0xee,				/* 7c5b: out dx,al */
+    0x42,				/* 7c5c: inc dx */
+    0xb0, 0x47,				/* 7c5d: mov al,47h */
+    0xee,				/* 7c5f: out dx,al */
+    0xba, 0x00, 0x03,			/* 7c60: mov dx,300h */
+    0xb0, 0x0a,				/* 7c63: mov al,0ah */
+    0xee,				/* 7c65: out dx,al */
+    0xba, 0x10, 0x03,			/* 7c66: mov dx,310h */
+    0xbf, 0x00, 0x80,			/* 7c69: mov di,8000h */
+    0xb9, 0xf7, 0x02,			/* 7c6c: mov cx,2f7h */
+    0xf3, 0x6d,				/* 7c6f: rep insw */
+    0xb4, 0x40,				/* 7c71: mov ah,40h */
+    0xe8, 0x19, 0x00,			/* 7c73: call 7c8fh */
+    0xba, 0x00, 0x03,			/* 7c76: mov dx,300h */
+    0xb0, 0x62,				/* 7c79: mov al,62h */
+    0xee,				/* 7c7b: out dx,al */
+    0xba, 0x07, 0x03,			/* 7c7c: mov dx,307h */
+    0xb0, 0x47,				/* 7c7f: mov al,47h */
+    0xee,				/* 7c81: out dx,al */
+    0xba, 0x00, 0x03,			/* 7c82: mov dx,300h */
+    0xb0, 0x22,				/* 7c85: mov al,22h */
+    0xee,				/* 7c87: out dx,al */
+    0xb0, 0x00,				/* 7c88: mov al,0 */
+    0xe6, 0xe9,				/* 7c8a: out 0e9h,al */
+    0xe9, 0x7e, 0xff,			/* 7c8c: jmp 7c0dh */
+    0xba, 0x07, 0x03,			/* 7c8f: mov dx,307h */
+    0x31, 0xc9,				/* 7c92: xor cx,cx */
+    0xec,				/* 7c94: in al,dx */
+    0x84, 0xe0,				/* 7c95: test al,ah */
+    0x75, 0x09,				/* 7c97: jne 7ca2h */
+    0xe2, 0xf9,				/* 7c99: loop 7c94h */
+    0xb0, 0xff,				/* 7c9b: mov al,0ffh */
+    0xe6, 0xe9,				/* 7c9d: out 0e9h,al */
+    0xf4,				/* 7c9f: hlt */
+    0xeb, 0xfd,				/* 7ca0: jmp 7c9fh */
+    0x88, 0xe0,				/* 7ca2: mov al,ah */
+    0xee,				/* 7ca4: out dx,al */
+    0xc3,				/* 7ca5: ret */
+};
+
+/* Standard VGA register values for mode 13h. */
+static const uint8_t vga_seq[5] = {
+    0x03, 0x01, 0x0f, 0x00, 0x0e
+};
+static const uint8_t vga_crtc[25] = {
+    0x5f, 0x4f, 0x50, 0x82, 0x54, 0x80, 0xbf, 0x1f,
+    0x00, 0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x9c, 0x0e, 0x8f, 0x28, 0x40, 0x96, 0xb9, 0xa3,
+    0xff
+};
+static const uint8_t vga_gdc[9] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x05, 0x0f,
+    0xff
+};
+static const uint8_t vga_attr[21] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x41, 0x00, 0x0f, 0x00, 0x00
+};
+
+
+static const bench_t	*bench;			/* active benchmark */
+static int		bench_frames;		/* frames run so far */
+static uint32_t		bench_units;		/* units of work done */
+static uint32_t		bench_start;		/* host time, in ms */
+static uint64_t		bench_tmr;		/* host timer at start */
+static int		bench_error;		/* payload gave up */
+
+
+/* Set the video card up for mode 13h, like the BIOS would. */
+static void
+setup_vga(void)
+{
+    int i;
+
+    outb(0x03c2, 0x63);
+
+    /* Hold the sequencer in reset while we change it. */
+    outb(0x03c4, 0x00);
+    outb(0x03c5, 0x01);
+    for (i = 1; i < sizeof(vga_seq); i++) {
+	outb(0x03c4, i);
+	outb(0x03c5, vga_seq[i]);
+    }
+    outb(0x03c4, 0x00);
+    outb(0x03c5, vga_seq[0]);
+
+    /* Unlock CRTC registers 0-7 first. */
+    outb(0x03d4, 0x11);
+    outb(0x03d5, vga_crtc[0x11] & 0x7f);
+    for (i = 0; i < sizeof(vga_crtc); i++) {
+	outb(0x03d4, i);
+	outb(0x03d5, vga_crtc[i]);
+    }
+
+    for (i = 0; i < sizeof(vga_gdc); i++) {
+	outb(0x03ce, i);
+	outb(0x03cf, vga_gdc[i]);
+    }
+
+    /* Reset the attribute flip-flop, load it, and enable video. */
+    (void)inb(0x03da);
+    for (i = 0; i < sizeof(vga_attr); i++) {
+	outb(0x03c0, i);
+	outb(0x03c0, vga_attr[i]);
+    }
+    outb(0x03c0, 0x20);
+
+    /* A grey-scale palette, so we can see what is going on. */
+    outb(0x03c8, 0x00);
+    for (i = 0; i < 256; i++) {
+	outb(0x03c9, i >> 2);
+	outb(0x03c9, i >> 2);
+	outb(0x03c9, i >> 2);
+    }
+}
+
+
+/* The payload polls the primary IDE channel, so no interrupts. */
+static void
+setup_ide(void)
+{
+    outb(0x03f6, 0x02);
+}
+
+
+static void
+sb_cmd(uint8_t val)
+{
+    int i;
+
+    for (i = 0; i < 1000; i++)
+	if (! (inb(0x022c) & 0x80)) break;
+
+    outb(0x022c, val);
+}
+
+
+/*
+ * Start an endless 8-bit auto-init DMA playback on a Sound Blaster
+ * at 220H, DMA 1, from the 64K buffer at 10000H. The payload then
+ * just watches the DMA count register wrap.
+ */
+static void
+setup_sb(void)
+{
+    /* Reset the DSP, and drop its 0xAA reply. */
+    outb(0x0226, 0x01);
+    outb(0x0226, 0x00);
+    (void)inb(0x022a);
+
+    /* Channel 1: single mode, auto-init, memory to device. */
+    outb(0x000a, 0x05);
+    outb(0x000c, 0x00);
+    outb(0x000b, 0x59);
+    outb(0x0002, 0x00);
+    outb(0x0002, 0x00);
+    outb(0x0083, 0x01);
+    outb(0x0003, 0xff);
+    outb(0x0003, 0xff);
+    outb(0x000a, 0x01);
+
+    sb_cmd(0xd1);				/* speaker on */
+    sb_cmd(0x40);				/* 22050 Hz */
+    sb_cmd(0xd3);
+    sb_cmd(0x48);				/* 64K blocks */
+    sb_cmd(0xff);
+    sb_cmd(0xff);
+    sb_cmd(0x1c);				/* auto-init output */
+}
+
+
+/*
+ * Put an NE2000 at 300H into internal loopback mode, with a receive
+ * ring from page 46H to 80H, and the transmit buffer at page 40H.
+ */
+static void
+setup_net(void)
+{
+    /* Reset the card. */
+    outb(0x031f, inb(0x031f));
+
+    outb(0x0300, 0x21);				/* page 0, stop */
+    outb(0x030e, 0x49);				/* word transfers */
+    outb(0x030a, 0x00);
+    outb(0x030b, 0x00);
+    outb(0x030c, 0x10);				/* promiscuous */
+    outb(0x030d, 0x02);				/* internal loopback */
+    outb(0x0301, 0x46);				/* PSTART */
+    outb(0x0302, 0x80);				/* PSTOP */
+    outb(0x0303, 0x46);				/* BNRY */
+    outb(0x0304, 0x40);				/* TPSR */
+    outb(0x030f, 0x00);				/* no interrupts */
+    outb(0x0307, 0xff);
+
+    outb(0x0300, 0x61);				/* page 1, stop */
+    outb(0x0307, 0x47);				/* CURR */
+    outb(0x0300, 0x22);				/* page 0, start */
+}
+
+
+static const bench_t benchmarks[] = {
+  { "cpu", "integer loop",
+    bench_cpu, sizeof(bench_cpu), NULL, 50004, 1 },
+  { "fpu", "x87 loop",
+    bench_fpu, sizeof(bench_fpu), NULL, 50004, 1 },
+  { "vga", "mode 13h fill",
+    bench_vga, sizeof(bench_vga), setup_vga, 64000, 0 },
+  { "ide", "IDE sequential read",
+    bench_ide, sizeof(bench_ide), setup_ide, 65536, 0 },
+  { "sb", "Sound Blaster DMA playback",
+    bench_sb, sizeof(bench_sb), setup_sb, 65536, 0 },
+  { "net", "NE2000 loopback",
+    bench_net, sizeof(bench_net), setup_net, 1514, 0 },
+  { "ops", "opcode timings",
+    NULL, 0, NULL, 0, 0 },
+  { NULL }
+};
+
+
+/* Log a line of the report, and also show it on the console. */
+static void
+bench_log(const char *fmt, ...)
+{
+    char temp[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(temp, sizeof(temp), fmt, ap);
+    va_end(ap);
+
+    INFO("BENCH: %s\n", temp);
+    printf("%s\n", temp);
+    fflush(stdout);
+}
+
+
+static void
+bench_out(UNUSED(uint16_t port), uint8_t val, UNUSED(priv_t priv))
+{
+    if (val == 0x00)
+	bench_units++;
+      else
+	bench_error = 1;
+}
+
+
+/* Which CPU core is doing the work. */
+static const char *
+bench_core(void)
+{
+    if (! is286)
+	return("808x core");
+
+    return(cpu_dynarec ? "dynarec" : "interpreter");
+}
+
+
+/*
+ * Opcode timings.
+ *
+ * Each test is a short instruction sequence, repeated OPS_REPEAT
+ * times in a loop that ends with a write to OPS_PORT. The loop is
+ * preceded by a prologue that sets up the registers and, for the
+ * x87 tests, checks for and initializes the FPU. Every test gets
+ * its own code segment, so the recompiler never sees stale code.
+ * Whatever CPU model and core (8088 core, 386 interpreter, or the
+ * recompiler) are configured is what gets measured.
+ *
+ * Two numbers are reported for each test:
+ *
+ *  - "loop" is the time per instruction as the configured core runs
+ *    it, from whole frames. The time of the "empty" test (just the
+ *    loop itself) is subtracted first, so the loop, the frame and
+ *    the per-loop port write are not counted. Timers and video still
+ *    run alongside, as they would for guest code.
+ *
+ *  - "handler" calls the interpreter's handlers for one copy of the
+ *    code directly from the opcode tables, without the execution
+ *    loop, timers, interrupts or video. This is the same for the
+ *    interpreter and the recompiler (which falls back to those very
+ *    handlers), and is not available with the 808x core, which does
+ *    not use tables. The table entries each test goes through are
+ *    listed with it.
+ *
+ * Some tests also check the recompiler's CF peephole: their INC or
+ * DEC must bring CF up to date, and the flags_rebuild_c() call for
+ * that is either dead (it should nearly always be dropped again, a
+ * block can end right after the INC) or live (it must never be).
+ * The calls emitted and dropped while the test runs are counted,
+ * and shown after the timings when the recompiler is in use.
+ *
+ * To compare cores, run the timings once for each (the 808x core
+ * needs an 8088/8086 machine, the other two are the same machine
+ * with and without the recompiler), and give the output of one run
+ * as the baseline for the next one; each test then also shows how
+ * it compares to the baseline.
+ */
+#define OPS_PORT	0x00ea			/* loop done port */
+#define OPS_SEG		0x1000			/* first code segment */
+#define OPS_DATA	0x3000			/* data and stack segment */
+#define OPS_REPEAT	64			/* copies of code in loop */
+#define OPS_WARMUP	5			/* frames before measuring */
+#define OPS_FRAMES	20			/* frames measured */
+#define OPS_SLOWER	20			/* regression, percent */
+#define OPS_DIRECT	100000			/* passes for the handlers */
+#define OPS_HANDLERS	8			/* table entries per test */
+#define OPS_CF_DEAD	1			/* CF rebuild is dead */
+#define OPS_CF_LIVE	2			/* CF rebuild is live */
+
+enum {
+    OP_8086 = 0,
+    OP_186,
+    OP_386
+};
+
+typedef struct {
+    const char	*name;
+    uint8_t	level;				/* minimum CPU */
+    uint8_t	fpu;				/* needs an FPU */
+    uint8_t	count;				/* instructions in code */
+    uint8_t	len;
+    uint8_t	code[8];
+    uint8_t	cf;				/* CF peephole check */
+} bench_op_t;
+
+static const bench_op_t bench_ops[] = {
+  { "empty",      OP_8086, 0, 0, 0, { 0 } },
+  { "nop",        OP_8086, 0, 1, 1, { 0x90 } },
+  { "clc",        OP_8086, 0, 1, 1, { 0xf8 } },
+  { "mov_rr",     OP_8086, 0, 1, 2, { 0x89, 0xd8 } },
+  { "mov_ri",     OP_8086, 0, 1, 3, { 0xb8, 0x34, 0x12 } },
+  { "mov_rm",     OP_8086, 0, 1, 2, { 0x8b, 0x07 } },
+  { "mov_mr",     OP_8086, 0, 1, 2, { 0x89, 0x07 } },
+  { "add_rr",     OP_8086, 0, 1, 2, { 0x01, 0xd8 } },
+  { "adc_rr",     OP_8086, 0, 1, 2, { 0x11, 0xd8 } },
+  { "xor_rr",     OP_8086, 0, 1, 2, { 0x31, 0xd8 } },
+  { "cmp_rr",     OP_8086, 0, 1, 2, { 0x39, 0xd8 } },
+  { "add_ri",     OP_8086, 0, 1, 3, { 0x05, 0x34, 0x12 } },
+  { "add_rm",     OP_8086, 0, 1, 2, { 0x03, 0x07 } },
+  { "add_mr",     OP_8086, 0, 1, 2, { 0x01, 0x07 } },
+  { "inc_r",      OP_8086, 0, 1, 1, { 0x40 } },
+  { "inc_add",    OP_8086, 0, 2, 3, { 0x40, 0x01, 0xcb }, OPS_CF_DEAD },
+  { "inc_mov_add",OP_8086, 0, 4, 7, { 0x46, 0x89, 0xd8, 0x4f,
+				      0x83, 0xc2, 0x01 }, OPS_CF_DEAD },
+  { "inc_adc",    OP_8086, 0, 2, 3, { 0x40, 0x11, 0xcb }, OPS_CF_LIVE },
+  { "lea",        OP_8086, 0, 1, 3, { 0x8d, 0x40, 0x10 } },
+  { "xchg",       OP_8086, 0, 1, 2, { 0x87, 0xc8 } },
+  { "cbw_cwd",    OP_8086, 0, 2, 2, { 0x98, 0x99 } },
+  { "shl_r1",     OP_8086, 0, 1, 2, { 0xd1, 0xe0 } },
+  { "shl_rcl",    OP_8086, 0, 1, 2, { 0xd3, 0xe0 } },
+  { "mul",        OP_8086, 0, 1, 2, { 0xf7, 0xe3 } },
+  { "div",        OP_8086, 0, 1, 2, { 0xf7, 0xf3 } },
+  { "push_pop",   OP_8086, 0, 2, 2, { 0x50, 0x58 } },
+  { "pushf_popf", OP_8086, 0, 2, 2, { 0x9c, 0x9d } },
+  { "jmp_short",  OP_8086, 0, 1, 2, { 0xeb, 0x00 } },
+  { "loop",       OP_8086, 0, 1, 2, { 0xe2, 0x00 } },
+  { "call_ret",   OP_8086, 0, 3, 6, { 0xe8, 0x02, 0x00, 0xeb, 0x01, 0xc3 } },
+  { "mov_sr",     OP_8086, 0, 2, 4, { 0x8c, 0xd8, 0x8e, 0xd8 } },
+  { "in_port",    OP_8086, 0, 1, 2, { 0xe4, 0x61 } },
+  { "lodsw",      OP_8086, 0, 1, 1, { 0xad } },
+  { "stosw",      OP_8086, 0, 1, 1, { 0xab } },
+  { "movsw",      OP_8086, 0, 1, 1, { 0xa5 } },
+  { "cmpsw",      OP_8086, 0, 1, 1, { 0xa7 } },
+  { "rep_movsb",  OP_8086, 0, 2, 5, { 0xb9, 0x40, 0x00, 0xf3, 0xa4 } },
+  { "rep_movsw",  OP_8086, 0, 2, 5, { 0xb9, 0x40, 0x00, 0xf3, 0xa5 } },
+  { "rep_stosw",  OP_8086, 0, 2, 5, { 0xb9, 0x40, 0x00, 0xf3, 0xab } },
+  { "rol_ri",     OP_186,  0, 1, 3, { 0xc1, 0xc0, 0x03 } },
+  { "imul_rri",   OP_186,  0, 1, 3, { 0x6b, 0xc3, 0x05 } },
+  { "push_imm",   OP_186,  0, 2, 3, { 0x6a, 0x01, 0x58 } },
+  { "add_err",    OP_386,  0, 1, 3, { 0x66, 0x01, 0xd8 } },
+  { "mov_erm",    OP_386,  0, 1, 3, { 0x66, 0x8b, 0x07 } },
+  { "movzx",      OP_386,  0, 1, 3, { 0x0f, 0xb6, 0xc3 } },
+  { "bsf",        OP_386,  0, 1, 3, { 0x0f, 0xbc, 0xc3 } },
+  { "shld",       OP_386,  0, 1, 4, { 0x0f, 0xa4, 0xd8, 0x04 } },
+  { "fadd",       OP_8086, 1, 1, 2, { 0xd8, 0xc1 } },
+  { "fmul",       OP_8086, 1, 1, 2, { 0xd8, 0xc9 } },
+  { "fdiv",       OP_8086, 1, 1, 2, { 0xd8, 0xf1 } },
+  { "fsqrt",      OP_8086, 1, 1, 2, { 0xd9, 0xfa } },
+  { "fxch",       OP_8086, 1, 1, 2, { 0xd9, 0xc9 } },
+  { "fld_fstp",   OP_8086, 1, 2, 4, { 0xd9, 0xc0, 0xdd, 0xd8 } },
+  { "fild_fistp", OP_8086, 1, 2, 4, { 0xdf, 0x07, 0xdf, 0x1f } },
+  { "fsin",       OP_386,  1, 1, 2, { 0xd9, 0xfe } },
+  { NULL }
+};
+
+#define OPS_MAX	(sizeof(bench_ops) / sizeof(bench_op_t))
+
+static const uint8_t ops_prologue[] = {
+    0xfa,				/* cli */
+    0xb8, 0x00, 0x30,			/* mov ax,3000h */
+    0x8e, 0xd8,				/* mov ds,ax */
+    0x8e, 0xc0,				/* mov es,ax */
+    0x8e, 0xd0,				/* mov ss,ax */
+    0xbc, 0xfe, 0xff,			/* mov sp,0fffeh */
+    0x31, 0xf6,				/* xor si,si */
+    0x31, 0xff,				/* xor di,di */
+    0xbb, 0x00, 0x01,			/* mov bx,100h */
+    0x31, 0xd2,				/* xor dx,dx */
+    0xb9, 0x04, 0x00,			/* mov cx,4 */
+    0xfc				/* cld */
+};
+
+static const uint8_t ops_fpu[] = {
+    0xdb, 0xe3,				/* fninit */
+    0xc7, 0x06, 0x00, 0x00, 0x5a, 0x5a,	/* mov word [0],5a5ah */
+    0xdd, 0x3e, 0x00, 0x00,		/* fnstsw [0] */
+    0x80, 0x3e, 0x00, 0x00, 0x00,	/* cmp byte [0],0 */
+    0x74, 0x05,				/* je $+7 */
+    0xea, 0x00, 0x06, 0x00, 0x00,	/* jmp 0000:0600h */
+    0xd9, 0xe8,				/* fld1 */
+    0xd9, 0xe8				/* fld1 */
+};
+
+static int		ops_test;		/* current test */
+static uint8_t		ops_code[1024];		/* code of current test */
+static int		ops_loop;		/* start of its loop */
+static uint64_t		ops_tmr;		/* host timer at start */
+static uint64_t		ops_ticks[OPS_MAX];	/* host timer ticks used */
+static uint32_t		ops_loops[OPS_MAX];	/* loops done */
+static uint64_t		ops_dticks[OPS_MAX];	/* same, for the handlers */
+static uint32_t		ops_dloops[OPS_MAX];
+static uint16_t		ops_handlers[OPS_MAX][OPS_HANDLERS];
+static int		ops_nhandlers[OPS_MAX];
+static double		ops_base[OPS_MAX];	/* baseline, in ns */
+#ifdef USE_DYNAREC
+static uint32_t		ops_cfcalls[OPS_MAX];	/* CF rebuilds emitted */
+static uint32_t		ops_cfdropped[OPS_MAX];	/* and dropped again */
+#endif
+
+
+/* Can the configured CPU run this test? */
+static int
+ops_usable(const bench_op_t *op)
+{
+    switch (op->level) {
+	case OP_186:
+		return(is186 || is286);
+
+	case OP_386:
+		return(is386);
+    }
+
+    return(1);
+}
+
+
+/* Load the first test from here the CPU can run, 0 if none left. */
+static int
+ops_load(int test)
+{
+    uint8_t *code = ops_code;
+    const bench_op_t *op;
+    uint16_t seg;
+    int i, len, loop;
+
+    while ((bench_ops[test].name != NULL) && !ops_usable(&bench_ops[test]))
+	test++;
+    ops_test = test;
+
+    op = &bench_ops[test];
+    if (op->name == NULL) return(0);
+
+    memcpy(code, ops_prologue, sizeof(ops_prologue));
+    len = sizeof(ops_prologue);
+    if (op->fpu) {
+	memcpy(&code[len], ops_fpu, sizeof(ops_fpu));
+	len += sizeof(ops_fpu);
+    }
+
+    loop = ops_loop = len;
+    for (i = 0; i < OPS_REPEAT; i++) {
+	memcpy(&code[len], op->code, op->len);
+	len += op->len;
+    }
+
+    /* out 0eah,al; jmp loop */
+    code[len++] = 0xe6;
+    code[len++] = OPS_PORT;
+    i = loop - (len + 3);
+    code[len++] = 0xe9;
+    code[len++] = (i & 0xff);
+    code[len++] = ((i >> 8) & 0xff);
+
+    seg = OPS_SEG + (test * 0x40);
+    mem_write_phys_block((uint32_t)seg << 4, code, len);
+    cpu_set_start(seg, 0x0000);
+
+    bench_frames = 0;
+    bench_units = 0;
+    bench_error = 0;
+
+#ifdef USE_DYNAREC
+    /* Start counting, these are turned into deltas when done. */
+    ops_cfcalls[test] = codegen_flags_c_calls;
+    ops_cfdropped[test] = codegen_flags_c_dropped;
+#endif
+
+    return(1);
+}
+
+
+static void
+ops_out(UNUSED(uint16_t port), UNUSED(uint8_t val), UNUSED(priv_t priv))
+{
+    bench_units++;
+}
+
+
+/*
+ * Run the handlers of a test directly from the opcode tables.
+ *
+ * This dispatches one copy of the test code the way the 386 core
+ * does, over and over, with the machine state the loop left behind.
+ * The table entry for every instruction is noted on the first pass.
+ */
+static void
+ops_direct(int test)
+{
+    const bench_op_t *op = &bench_ops[test];
+    uint32_t fetch, end;
+    uint64_t tmr;
+    int n, i, pc, old_cycles;
+    uint16_t h;
+
+    ops_nhandlers[test] = 0;
+    if (!is286 || (op->len == 0)) return;
+
+    old_cycles = cycles;
+    end = ops_loop + op->len;
+
+    tmr = plat_timer_read();
+    for (n = 0; n < OPS_DIRECT; n++) {
+	cpu_state.pc = ops_loop;
+
+	while (cpu_state.pc < end) {
+		pc = cpu_state.pc;
+		cpu_state.oldpc = pc;
+		cpu_state.op32 = use32;
+		cpu_state.ea_seg = &cpu_state.seg_ds;
+		cpu_state.ssegs = 0;
+		cycles = 100000;
+
+		fetch = ops_code[pc] | (ops_code[pc + 1] << 8) |
+			(ops_code[pc + 2] << 16) |
+			((uint32_t)ops_code[pc + 3] << 24);
+		opcode = fetch & 0xff;
+
+		if ((n == 0) && (ops_nhandlers[test] < OPS_HANDLERS)) {
+			/* Prefixes, 0F and x87 go through a second table. */
+			h = opcode;
+			if ((opcode == 0x0f) || (opcode == 0x66) ||
+			    (opcode == 0xf3) || ((opcode & 0xf8) == 0xd8))
+				h = (h << 8) | ops_code[pc + 1];
+			for (i = 0; i < ops_nhandlers[test]; i++)
+				if (ops_handlers[test][i] == h) break;
+			if (i == ops_nhandlers[test])
+				ops_handlers[test][ops_nhandlers[test]++] = h;
+		}
+
+		cpu_state.pc++;
+		x86_opcodes[(opcode | cpu_state.op32) & 0x3ff](fetch >> 8);
+
+		if (cpu_state.abrt) {
+			cpu_state.abrt = 0;
+			cycles = old_cycles;
+			return;
+		}
+	}
+    }
+
+    ops_dticks[test] = plat_timer_read() - tmr;
+    ops_dloops[test] = OPS_DIRECT;
+
+    cycles = old_cycles;
+}
+
+
+/* Read the timings of an earlier run, to compare with. */
+static void
+ops_baseline(const wchar_t *fn)
+{
+    char temp[128], name[32];
+    double ns;
+    FILE *fp;
+    int i;
+
+    fp = plat_fopen(fn, L"r");
+    if (fp == NULL) {
+	ERRLOG("BENCH: unable to read baseline '%ls'\n", fn);
+	return;
+    }
+
+    while (fgets(temp, sizeof(temp), fp) != NULL) {
+	if (sscanf(temp, "%31s %lf", name, &ns) != 2) continue;
+
+	for (i = 0; bench_ops[i].name != NULL; i++) {
+		if (! strcmp(bench_ops[i].name, name)) {
+			ops_base[i] = ns;
+			break;
+		}
+	}
+    }
+
+    (void)fclose(fp);
+}
+
+
+/* Time per instruction of a test, in ns, or -1 if we have none. */
+static double
+ops_ns(uint64_t ticks, uint32_t loops, int count, double tpns)
+{
+    if ((loops == 0) || (count == 0))
+	return(-1.0);
+
+    return((double)ticks / tpns / ((double)loops * count));
+}
+
+
+static void
+ops_report(void)
+{
+    double tpns, ns, dns, empty, worst[5];
+    int i, j, k, slower, bad[5];
+    uint8_t used[3][2048];
+    int nused[3];
+    char temp[32], dtemp[32], rtemp[32], htemp[64];
+    uint32_t ms;
+    uint16_t h;
+
+    /* Work out the host timer rate over the whole run. */
+    ms = plat_timer_ms() - bench_start;
+    if (ms == 0)
+	ms = 1;
+    tpns = (double)(plat_timer_read() - bench_tmr) / ((double)ms * 1000000.0);
+
+    bench_log("%s (%s) on %s, %s, %s", bench->name, bench->descr,
+	      machine_get_name(), cpu_get_name(), bench_core());
+
+    /* The loop by itself, without any test code in it. */
+    empty = 0.0;
+    if (ops_loops[0] > 0)
+	empty = (double)ops_ticks[0] / tpns / (double)ops_loops[0];
+    bench_log("  loop overhead %.2f ns, subtracted from the loop times",
+	      empty);
+    bench_log("  %-12s %8s %8s %8s %6s  %s",
+	      "test", "loop", "handler", "baseline", "ratio", "handlers");
+
+    for (j = 0; j < 5; j++) {
+	worst[j] = 0.0;
+	bad[j] = -1;
+    }
+    memset(used, 0x00, sizeof(used));
+    nused[0] = nused[1] = nused[2] = 0;
+
+    slower = 0;
+    for (i = 1; bench_ops[i].name != NULL; i++) {
+	if (! ops_usable(&bench_ops[i])) continue;
+
+	if (ops_base[i] > 0.0)
+		sprintf(temp, "%8.2f", ops_base[i]);
+	  else
+		strcpy(temp, "       -");
+
+	/* Which table entries it went through, and count them. */
+	htemp[0] = '\0';
+	for (j = 0; j < ops_nhandlers[i]; j++) {
+		h = ops_handlers[i][j];
+		if (h > 0xff)
+			sprintf(&htemp[strlen(htemp)], " %04x", h);
+		  else
+			sprintf(&htemp[strlen(htemp)], " %02x", h);
+
+		/* x87 handlers are indexed by escape and modrm byte. */
+		k = (h <= 0xff) ? 0 : ((h >> 8) == 0x0f) ? 1 :
+		    (((h >> 8) & 0xf8) == 0xd8) ? 2 : -1;
+		if (k == 2)
+			h &= 0x07ff;
+		  else
+			h &= 0x00ff;
+		if ((k >= 0) && !used[k][h]) {
+			used[k][h] = 1;
+			nused[k]++;
+		}
+	}
+
+	dns = ops_ns(ops_dticks[i], ops_dloops[i], bench_ops[i].count, tpns);
+	if (dns >= 0.0)
+		sprintf(dtemp, "%8.2f", dns);
+	  else
+		strcpy(dtemp, "       -");
+
+	if (ops_loops[i] == 0) {
+		bench_log("  %-12s %8s %s %s %6s %s  failed",
+			  bench_ops[i].name, "-", dtemp, temp, "-", htemp);
+		continue;
+	}
+
+	ns = ((double)ops_ticks[i] / tpns / (double)ops_loops[i] - empty) /
+		(double)(OPS_REPEAT * bench_ops[i].count);
+	if (ns < 0.0)
+		ns = 0.0;
+
+	if (ops_base[i] > 0.0)
+		sprintf(rtemp, "%6.2f", ns / ops_base[i]);
+	  else
+		strcpy(rtemp, "     -");
+
+	if ((ops_base[i] > 0.0) &&
+	    (ns > ops_base[i] * (100 + OPS_SLOWER) / 100.0)) {
+		bench_log("  %-12s %8.2f %s %s %s %s  +%i%%",
+			  bench_ops[i].name, ns, dtemp, temp, rtemp, htemp,
+			  (int)((ns - ops_base[i]) * 100.0 / ops_base[i]));
+		slower++;
+	} else
+		bench_log("  %-12s %8.2f %s %s %s %s",
+			  bench_ops[i].name, ns, dtemp, temp, rtemp, htemp);
+
+	/* Keep track of the slowest ones. */
+	for (j = 0; j < 5; j++) {
+		if (ns <= worst[j]) continue;
+		for (k = 4; k > j; k--) {
+			worst[k] = worst[k - 1];
+			bad[k] = bad[k - 1];
+		}
+		worst[j] = ns;
+		bad[j] = i;
+		break;
+	}
+    }
+
+    if (is286)
+	bench_log("  handlers covered: %i one-byte, %i 0F, %i x87 escape",
+		  nused[0], nused[1], nused[2]);
+      else
+	bench_log("  handlers: none, the 808x core does not use tables");
+
+    for (j = 0; (j < 5) && (bad[j] >= 0); j++)
+	bench_log("  slowest #%i: %s, %.2f ns", j + 1,
+		  bench_ops[bad[j]].name, worst[j]);
+
+    if (slower > 0)
+	bench_log("  %i test(s) more than %i%% slower than the baseline",
+		  slower, OPS_SLOWER);
+
+#ifdef USE_DYNAREC
+    if (! cpu_dynarec) return;
+
+    /* How the CF peephole did on the tests that check it. */
+    bench_log("  CF rebuilds dropped by the recompiler:");
+    slower = 0;
+    for (i = 1; bench_ops[i].name != NULL; i++) {
+	if (!bench_ops[i].cf || !ops_usable(&bench_ops[i])) continue;
+
+	if (bench_ops[i].cf == OPS_CF_DEAD)
+		j = (ops_cfcalls[i] > 0) &&
+		    ((uint64_t)ops_cfdropped[i] * 10 >= (uint64_t)ops_cfcalls[i] * 9);
+	  else
+		j = (ops_cfcalls[i] > 0) && (ops_cfdropped[i] == 0);
+
+	bench_log("  %-12s %6u of %-6u %s", bench_ops[i].name,
+		  ops_cfdropped[i], ops_cfcalls[i],
+		  j ? "ok" : (bench_ops[i].cf == OPS_CF_DEAD) ?
+		  "expected nearly all" : "expected none");
+	if (! j)
+		slower++;
+    }
+
+    if (slower > 0)
+	bench_log("  %i CF check(s) failed", slower);
+#endif
+}
+
+
+/* Called after every frame while running the opcode timings. */
+static int
+ops_frame(void)
+{
+    /* Nothing (left) to run? */
+    if (bench_ops[ops_test].name == NULL) {
+	ops_report();
+	return(1);
+    }
+
+    if (++bench_frames == OPS_WARMUP) {
+	bench_units = 0;
+	ops_tmr = plat_timer_read();
+    }
+
+    if (!bench_error && (bench_frames < (OPS_WARMUP + OPS_FRAMES)))
+	return(0);
+
+#ifdef USE_DYNAREC
+    ops_cfcalls[ops_test] = codegen_flags_c_calls - ops_cfcalls[ops_test];
+    ops_cfdropped[ops_test] = codegen_flags_c_dropped - ops_cfdropped[ops_test];
+#endif
+
+    if (! bench_error) {
+	ops_ticks[ops_test] = plat_timer_read() - ops_tmr;
+	ops_loops[ops_test] = bench_units;
+
+	ops_direct(ops_test);
+    }
+
+    /* On to the next test, if we have any. */
+    if (ops_load(ops_test + 1))
+	return(0);
+
+    ops_report();
+
+    return(1);
+}
+
+
+static void
+bench_report(void)
+{
+    uint32_t ms = plat_timer_ms() - bench_start;
+    int frames = bench_frames - BENCH_WARMUP;
+    double secs, rate;
+
+    bench_log("%s (%s) on %s, %s, %s", bench->name, bench->descr,
+	      machine_get_name(), cpu_get_name(), bench_core());
+
+    if (bench_error) {
+	bench_log("  payload failed after %i frames", bench_frames);
+	return;
+    }
+
+    if (ms == 0)
+	ms = 1;
+    secs = (double)ms / 1000.0;
+
+    bench_log("  %i frames in %.3f sec, %.1f frames/sec (%i%%)",
+	      frames, secs, (double)frames / secs,
+	      (int)(((uint64_t)frames * 1000) / ms));
+
+    rate = ((double)bench_units * bench->unit) / secs;
+    if (bench->mips)
+	bench_log("  %.2f MIPS", rate / 1000000.0);
+      else
+	bench_log("  %.2f MB/s", rate / (1024.0 * 1024.0));
+}
+
+
+/*
+ * Select a benchmark to run instead of the guest's own software.
+ *
+ * For the opcode timings, the results of an earlier run can be
+ * given as a baseline, to flag any tests that got slower.
+ */
+int
+bench_open(const wchar_t *name, const wchar_t *base)
+{
+    char temp[32];
+    const bench_t *b;
+
+    wcstombs(temp, name, sizeof(temp));
+    temp[sizeof(temp) - 1] = '\0';
+
+    for (b = benchmarks; b->name != NULL; b++)
+	if (! strcasecmp(b->name, temp)) break;
+
+    if (b->name == NULL) {
+	ERRLOG("BENCH: unknown benchmark '%s', valid ones are:\n", temp);
+	for (b = benchmarks; b->name != NULL; b++)
+		ERRLOG("BENCH:   %-8s %s\n", b->name, b->descr);
+	return(0);
+    }
+
+    bench = b;
+
+    if ((base != NULL) && (base[0] != L'\0')) {
+	if (bench->code == NULL)
+		ops_baseline(base);
+	  else
+		ERRLOG("BENCH: baseline only used for the opcode timings\n");
+    }
+
+    /* Results are meaningless if we wait for the host clock. */
+    max_speed = 1;
+    config_ro = 1;
+
+    INFO("BENCH: running '%s' (%s)\n", bench->name, bench->descr);
+
+    return(1);
+}
+
+
+/*
+ * Load the payload into the freshly reset machine.
+ *
+ * Called at the end of a hard reset, so all devices are there. We
+ * bypass the BIOS altogether, set up the device the payload needs,
+ * and start the CPU at the payload, with a trap for all vectors.
+ */
+void
+bench_reset(void)
+{
+    uint8_t ivt[1024];
+    int i;
+
+    if (bench == NULL) return;
+
+    io_sethandler(BENCH_PORT, 1,
+		  NULL,NULL,NULL, bench_out,NULL,NULL, NULL);
+    if (bench->code == NULL)
+	io_sethandler(OPS_PORT, 1,
+		      NULL,NULL,NULL, ops_out,NULL,NULL, NULL);
+
+    for (i = 0; i < 256; i++) {
+	ivt[i*4 + 0] = 0x00;
+	ivt[i*4 + 1] = 0x06;
+	ivt[i*4 + 2] = 0x00;
+	ivt[i*4 + 3] = 0x00;
+    }
+    mem_write_phys_block(0x0000, ivt, sizeof(ivt));
+    mem_write_phys_block(0x0600, bench_trap, sizeof(bench_trap));
+
+    bench_start = plat_timer_ms();
+    bench_tmr = plat_timer_read();
+
+    /* The opcode timings load their own code. */
+    if (bench->code == NULL) {
+	memset(ops_ticks, 0x00, sizeof(ops_ticks));
+	memset(ops_loops, 0x00, sizeof(ops_loops));
+	memset(ops_dticks, 0x00, sizeof(ops_dticks));
+	memset(ops_dloops, 0x00, sizeof(ops_dloops));
+	(void)ops_load(0);
+	return;
+    }
+
+    mem_write_phys_block(BENCH_ADDR, bench->code, bench->size);
+
+    if (bench->setup != NULL)
+	bench->setup();
+
+    cpu_set_start(0x0000, BENCH_ADDR);
+
+    bench_frames = 0;
+    bench_units = 0;
+    bench_error = 0;
+}
+
+
+/*
+ * Called after every frame by the main thread.
+ *
+ * Once warmed up (so the recompiler has done most of its work), we
+ * start the clock and clear the statistics. Returns 1 when done.
+ */
+int
+bench_frame(void)
+{
+    if (bench == NULL) return(0);
+
+    if (bench->code == NULL) {
+	if (! ops_frame()) return(0);
+
+	bench = NULL;
+	return(1);
+    }
+
+    if (++bench_frames == BENCH_WARMUP) {
+	bench_units = 0;
+	bench_start = plat_timer_ms();
+	stats_reset();
+    }
+
+    if (!bench_error && (bench_frames < (BENCH_WARMUP + BENCH_FRAMES)))
+	return(0);
+
+    bench_report();
+    bench = NULL;
+
+    return(1);
+}
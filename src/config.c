@@ -12,7 +12,7 @@
  *		on Windows XP, possibly Vista and several UNIX systems.
  *		Use the -DANSI_CFG for use on these systems.
  *
- * Version:	@(#)config.c	1.0.56	2021/03/23
+ * Version:	@(#)config.c	1.0.58	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -50,6 +50,9 @@
 #include "config.h"
 #include "timer.h"
 #include "cpu/cpu.h"
+#ifdef USE_DYNAREC
+# include "cpu/codegen.h"
+#endif
 #include "nvr.h"
 #include "device.h"
 #include "machines/machine.h"
@@ -419,6 +422,9 @@ load_machine(config_t *cfg, const char *cat)
     cfg->cpu_type = config_get_int(cat, "cpu", 0);
     cfg->cpu_waitstates = config_get_int(cat, "cpu_waitstates", 0);
     cfg->cpu_use_dynarec = !!config_get_int(cat, "cpu_use_dynarec", 0);
+#ifdef USE_DYNAREC
+    codegen_evict_policy = config_get_int(cat, "cpu_recomp_policy", CODEGEN_EVICT_CLOCK);
+#endif
     cfg->enable_ext_fpu = !!config_get_int(cat, "cpu_enable_fpu", 0);
 
     cfg->mem_size = config_get_int(cat, "mem_size", 4096);
@@ -2561,7 +2567,8 @@ config_set_string(const char *cat, const char *name, const char *val)
 	ent = create_entry(section, name);
 
     ent->quoted = 1;
-    strncpy(ent->data, val, sizeof(ent->data));
+    strncpy(ent->data, val, sizeof(ent->data) - 1);
+    ent->data[sizeof(ent->data) - 1] = '\0';
     mbstowcs(ent->wdata, ent->data, sizeof_w(ent->wdata));
 }
 
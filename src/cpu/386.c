@@ -8,7 +8,7 @@
  *
  *		Implementation of 80286+ CPU interpreter.
  *
- * Version:	@(#)386.c	1.0.13	2020/12/12
+ * Version:	@(#)386.c	1.0.14	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Sarah Walker, <tommowalker@tommowalker.co.uk>
@@ -47,6 +47,7 @@
 #endif
 #include "../emu.h"
 #include "../timer.h"
+#include "../io.h"
 #include "../mem.h"
 #include "../devices/system/nmi.h"
 #include "../devices/system/pic.h"
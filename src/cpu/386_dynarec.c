@@ -8,7 +8,7 @@
  *
  *		Implementation of the CPU's dynamic recompiler.
  *
- * Version:	@(#)386_dynarec.c	1.0.14	2020/12/11
+ * Version:	@(#)386_dynarec.c	1.0.18	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -46,16 +46,19 @@
 # define INFINITY   (__builtin_inff())
 #endif
 #include "../emu.h"
+#include "../stats.h"
 #include "../timer.h"
 #include "../io.h"
 #include "cpu.h"
 #include "../mem.h"
 #include "../devices/system/nmi.h"
 #include "../devices/system/pic.h"
+#include "../plat.h"
 #include "x86.h"
 #include "x86_ops.h"
 #include "x87.h"
 #include "386_common.h"
+#include "profile.h"
 #ifdef USE_DYNAREC
 # include "codegen.h"
 #endif
@@ -545,6 +548,7 @@ void exec386_dynarec(int cycs)
         int cycdiff;
         int oldcyc;
 	uint32_t start_pc = 0;
+        codeblock_t *prev_block = NULL;
 
         int cyc_period = cycs / 2000; /*5us*/
 
@@ -568,6 +572,8 @@ void exec386_dynarec(int cycs)
                 oldcyc=cycles;
                 if (!CACHE_ON()) /*Interpret block*/
                 {
+                        prev_block = NULL;
+                        prof_mode = PROF_INTERP;
                         cpu_block_end = 0;
 			x86_was_reset = 0;
                         while (!cpu_block_end)
@@ -619,12 +625,32 @@ void exec386_dynarec(int cycs)
                 }
                 else
                 {
-                uint32_t phys_addr = get_phys(cs+cpu_state.pc);
-                int hash = HASH(phys_addr);
-                codeblock_t *block = codeblock_hash[hash];
+                uint32_t phys_addr;
+                int hash;
+                codeblock_t *block = NULL;
                 int valid_block = 0;
+                int linked = 0;
                 trap = 0;
 
+                /*If the previous block has a valid link to the block for the
+                  current CS:PC, use it and skip the full lookup.*/
+                if (prev_block)
+                        block = codeblock_link_find(prev_block, cs + cpu_state.pc, cs);
+                cpu_recomp_lookups++;
+                if (block)
+                {
+                        phys_addr = block->phys;
+                        hash = HASH(phys_addr);
+                        linked = 1;
+                        cpu_recomp_linked++;
+                }
+                else
+                {
+                        phys_addr = get_phys(cs+cpu_state.pc);
+                        hash = HASH(phys_addr);
+                        block = codeblock_hash[hash];
+                }
+
                 if (block && !cpu_state.abrt)
                 {
                         page_t *page = &pages[phys_addr >> 12];
@@ -690,28 +716,52 @@ void exec386_dynarec(int cycs)
                                 block->flags &= ~CODEBLOCK_STATIC_TOP;
                                 block->was_recompiled = 0;
                         }
+                        if (valid_block && block->was_recompiled && !(block->flags & CODEBLOCK_TRACE) &&
+                            block->hits >= CODEGEN_TRACE_THRESHOLD)
+                        {
+                                /*Block is hot, re-compile it as a trace*/
+                                block->flags |= CODEBLOCK_TRACE;
+                                block->was_recompiled = 0;
+                                cpu_recomp_traces++;
+                        }
                 }
 
+                if (valid_block && prev_block && !linked)
+                        codeblock_link_add(prev_block, block);
+                prev_block = NULL;
+
                 if (valid_block && block->was_recompiled)
                 {
                         void (*code)() = (void (*)())&block->data[BLOCK_START];
 
+                        prof_mode = PROF_DYNAREC;
+                        prof_block = block->phys;
                         codeblock_hash[hash] = block;
+                        block->hits++;
 
 inrecomp=1;
                         code();
 inrecomp=0;
                         if (!use32) cpu_state.pc &= 0xffff;
                         cpu_recomp_blocks++;
+
+                        if (!cpu_state.abrt)
+                                prev_block = block;
                 }
                 else if (valid_block && !cpu_state.abrt)
                 {
+                        uint32_t trace_endpc = 0;
+                        int trace_jumps = 0;
+                        uint64_t compile_start = plat_timer_read();
+
                         start_pc = cpu_state.pc;
                         
                         cpu_block_end = 0;
                         x86_was_reset = 0;
 
                         cpu_new_blocks++;
+                        prof_mode = PROF_RECOMPILE;
+                        prof_block = block->phys;
                         
                         codegen_block_start_recompile(block);
                         codegen_in_recompile = 1;
@@ -736,6 +786,12 @@ inrecomp=0;
                                                 
                                         codegen_generate_call(opcode, x86_opcodes[(opcode | cpu_state.op32) & 0x3ff], fetchdat, cpu_state.pc, cpu_state.pc-1);
 
+                                        /*A trace can jump backwards, keep
+                                          the end of the code range monotonic*/
+                                        if (codegen_endpc < trace_endpc)
+                                                codegen_endpc = trace_endpc;
+                                        trace_endpc = codegen_endpc;
+
                                         x86_opcodes[(opcode | cpu_state.op32) & 0x3ff](fetchdat);
 
                                         if (x86_was_reset)
@@ -744,6 +800,21 @@ inrecomp=0;
 
                                 if (!use32) cpu_state.pc &= 0xffff;
 
+                                /*In a trace, a direct JMP to code at or
+                                  after the start of the block, in the same
+                                  page, does not end the block; the trace just
+                                  continues at the target. The page masks cover
+                                  block->pc to endpc, so self-modifying code in
+                                  the target is still caught.*/
+                                if (cpu_block_end && (block->flags & CODEBLOCK_TRACE) && !cpu_state.abrt &&
+                                    (opcode == 0xeb || opcode == 0xe9) && block_pos < BLOCK_MAX &&
+                                    (cs + cpu_state.pc) >= block->pc && !(((cs + cpu_state.pc) ^ block->pc) & ~0xfff) &&
+                                    trace_jumps < CODEGEN_TRACE_JUMPS)
+                                {
+                                        cpu_block_end = 0;
+                                        trace_jumps++;
+                                }
+
                                 /*Cap source code at 4000 bytes per block; this
                                   will prevent any block from spanning more than
                                   2 pages. In practice this limit will never be
@@ -774,11 +845,15 @@ inrecomp=0;
                                 codegen_reset();
 
                         codegen_in_recompile = 0;
+
+                        stats_hist_add(&codegen_compile_stats, plat_timer_read() - compile_start);
                 }
                 else if (!cpu_state.abrt)
                 {
                         /*Mark block but do not recompile*/
                         start_pc = cpu_state.pc;
+                        cpu_recomp_misses++;
+                        prof_mode = PROF_INTERP;
 
                         cpu_block_end = 0;
                         x86_was_reset = 0;
@@ -849,6 +924,7 @@ inrecomp=0;
                 
                 if (cpu_state.abrt)
                 {
+                        prev_block = NULL;
                         flags_rebuild();
                         tempi = cpu_state.abrt;
                         cpu_state.abrt = 0;
@@ -872,7 +948,7 @@ inrecomp=0;
                 
                 if (trap)
                 {
-
+                        prev_block = NULL;
                         flags_rebuild();
                         if (msw&1)
                         {
@@ -908,6 +984,9 @@ inrecomp=0;
                         temp=pic_interrupt();
                         if (temp!=0xFF)
                         {
+                                /*Don't let interrupt entry overwrite the
+                                  links of the interrupted block.*/
+                                prev_block = NULL;
                                 CPU_BLOCK_END();
                                 flags_rebuild();
                                 if (msw&1)
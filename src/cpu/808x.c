@@ -8,7 +8,7 @@
  *
  *		808x CPU emulation.
  *
- * Version:	@(#)808x.c	1.0.24	2021/03/18
+ * Version:	@(#)808x.c	1.0.28	2026/10/18
  *
  * Authors:	Miran Grca, <mgrca8@gmail.com>
  *		Andrew Jenner (reenigne), <andrew@reenigne.org>
@@ -43,6 +43,7 @@
 #include <math.h>
 #include <wchar.h>
 #include "../emu.h"
+#include "../state.h"
 #include "cpu.h"
 #include "x86.h"
 #include "../io.h"
@@ -1463,6 +1464,10 @@ execx86(int cycs)
 opcodestart:
 	if (halt) {
 		cpu_wait(2, 0);
+
+		/* Nothing to do until an interrupt, skip ahead. */
+		if ((cpu_state.flags & I_FLAG) && !takeint)
+			cpu_idle();
 		goto on_halt;
 	}
 
@@ -2809,6 +2814,35 @@ refreshread(void)
 }
 
 
+/* Save the state private to this core. */
+void
+x86_state_save(state_t *s)
+{
+    state_put(s, halt);
+    state_put(s, in_lock);
+    state_put(s, trap);
+    state_put(s, takeint);
+    state_put(s, noint);
+}
+
+
+/* Restore the state private to this core. */
+void
+x86_state_load(state_t *s)
+{
+    state_get(s, halt);
+    state_get(s, in_lock);
+    state_get(s, trap);
+    state_get(s, takeint);
+    state_get(s, noint);
+
+    /* Refill the prefetch queue from the restored CS:IP. */
+    ovr_seg = NULL;
+    fetchcycles = 0;
+    pfq_clear();
+}
+
+
 /* Reset the CPU. */
 void
 cpu_reset(int hard)
@@ -2872,3 +2906,15 @@ cpu_reset(int hard)
 	flushmmucache();
     x86_was_reset = 1;
 }
+
+
+/* Start executing at the given real-mode address, used by the benchmarks. */
+void
+cpu_set_start(uint16_t seg, uint16_t ip)
+{
+    loadcs(seg);
+    cpu_state.pc = ip;
+    ovr_seg = NULL;
+    halt = 0;
+    pfq_clear();
+}
@@ -8,7 +8,7 @@
  *
  *		Instruction parsing and generation.
  *
- * Version:	@(#)codegen.c	1.0.3	2020/11/24
+ * Version:	@(#)codegen.c	1.0.10	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -36,9 +36,11 @@
  */
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 #include "../emu.h"
+#include "../stats.h"
 #include "../mem.h"
 #include "cpu.h"
 #include "x86.h"
@@ -63,6 +65,351 @@ void codegen_timing_set(codegen_timing_t *timing)
 }
 
 int codegen_in_recompile;
+int codegen_evict_policy = CODEGEN_EVICT_CLOCK;
+int cpu_recomp_blocks_latched;
+int cpu_recomp_lookups, cpu_recomp_lookups_latched;
+int cpu_recomp_misses, cpu_recomp_misses_latched;
+int cpu_recomp_linked, cpu_recomp_linked_latched;
+int cpu_recomp_spared, cpu_recomp_spared_latched;
+int cpu_recomp_traces, cpu_recomp_traces_latched;
+int cpu_recomp_flags_elided, cpu_recomp_flags_elided_latched;
+int cpu_recomp_arena_scans, cpu_recomp_arena_scans_latched;
+int cpu_recomp_arena_flushes, cpu_recomp_arena_flushes_latched;
+
+int codegen_flags_c_call = -1, codegen_flags_c_len, codegen_flags_c_next = -1;
+uint32_t codegen_flags_c_calls, codegen_flags_c_dropped;
+
+typedef struct
+{
+        int start, end;
+        int block;
+} arena_range_t;
+
+static int evict_hand;
+
+/*Free area of the arena currently being allocated from, and the list of free
+  areas still to be used, as found by the last codegen_arena_scan().*/
+static int arena_top, arena_end;
+static int arena_hole, arena_nholes;
+static arena_range_t arena_used[BLOCK_SIZE];
+static arena_range_t arena_holes[BLOCK_SIZE + 1];
+
+stats_t codegen_compile_stats = STATS_HISTOGRAM("dynarec.compile_ticks");
+
+static stats_t st_lookups = STATS_COUNTER("dynarec.lookups");
+static stats_t st_misses = STATS_COUNTER("dynarec.misses");
+static stats_t st_linked = STATS_COUNTER("dynarec.linked");
+static stats_t st_new = STATS_COUNTER("dynarec.new_blocks");
+static stats_t st_evicted = STATS_COUNTER("dynarec.evicted");
+static stats_t st_flags_elided = STATS_COUNTER("dynarec.flags_elided");
+static stats_t st_arena_scans = STATS_COUNTER("dynarec.arena_scans");
+static stats_t st_arena_flushes = STATS_COUNTER("dynarec.arena_flushes");
+
+/*Select the next code block to (re)use, and return its index.
+
+  With the round-robin policy this is simply the next block in the array. With
+  the CLOCK policy, blocks that were executed since the hand last passed them
+  have their hit count halved and are skipped, so hot inner loops survive cache
+  pressure while one-shot code is recycled. The sweep gives up after
+  CODEGEN_EVICT_PROBES blocks so that a cache full of hot code still makes
+  progress.*/
+int codegen_block_evict_next(void)
+{
+        int c;
+
+        if (codegen_evict_policy == CODEGEN_EVICT_RR)
+                return evict_hand = (evict_hand + 1) & BLOCK_MASK;
+
+        for (c = 0; c < CODEGEN_EVICT_PROBES; c++)
+        {
+                codeblock_t *block;
+
+                evict_hand = (evict_hand + 1) & BLOCK_MASK;
+                block = &codeblock[evict_hand];
+                if (!block->valid || !block->hits)
+                        break;
+
+                block->hits >>= 1;
+                cpu_recomp_spared++;
+        }
+
+        return evict_hand;
+}
+
+static int arena_range_cmp(const void *a, const void *b)
+{
+        return ((const arena_range_t *)a)->start - ((const arena_range_t *)b)->start;
+}
+
+/*Drop the code of the blocks in the coldest CODEGEN_ARENA_DROP bytes of the
+  arena, and make that window the only free area. Used when the arena has no
+  free area left that can hold a block; the window is much larger than one
+  block, so the cost of the scan is spread over many recompiles.
+
+  The cost of a window is the number of blocks in it plus their hit counts,
+  which are aged by the CLOCK hand in codegen_block_evict_next(), so hot code
+  keeps its place in the arena just as its block keeps its place in
+  codeblock[]. The dropped blocks stay valid, and are recompiled the next time
+  the dispatcher runs them, just as for a static TOP mismatch. This is safe
+  because generated code is only entered from the dispatcher, which checks
+  was_recompiled first, block links included.*/
+static void codegen_arena_drop(int n)
+{
+        uint32_t cost = 0, best_cost = 0xffffffff;
+        int i, j = 0, start, best = 0, best_end = 0;
+
+        for (i = 0; i < n; i++)
+        {
+                /*Window starting where the gap before block i starts.*/
+                start = i ? arena_used[i - 1].end : 0;
+                if (start + CODEGEN_ARENA_DROP > CODEGEN_ARENA_SIZE)
+                        break;
+
+                while (j < n && arena_used[j].start < start + CODEGEN_ARENA_DROP)
+                {
+                        cost += codeblock[arena_used[j].block].hits + 1;
+                        j++;
+                }
+
+                if (cost < best_cost)
+                {
+                        best_cost = cost;
+                        best = i;
+                        best_end = j;
+                }
+
+                cost -= codeblock[arena_used[i].block].hits + 1;
+        }
+
+        for (i = best; i < best_end; i++)
+                codeblock[arena_used[i].block].was_recompiled = 0;
+
+        arena_holes[0].start = best ? arena_used[best - 1].end : 0;
+        arena_holes[0].end = (best_end < n) ? arena_used[best_end].start : CODEGEN_ARENA_SIZE;
+        arena_nholes = 1;
+
+        cpu_recomp_arena_flushes++;
+}
+
+/*Find the free areas of the arena that can hold a block, that is the gaps of
+  at least BLOCK_DATA_SIZE bytes between the code of the blocks that are still
+  compiled. This picks up the space of all blocks that were evicted by the
+  CLOCK hand, invalidated by writes, or dropped for recompilation since the
+  last scan, merged with any free space next to it. If there is none, some
+  code is dropped to make room.*/
+static void codegen_arena_scan(void)
+{
+        int c, n = 0, pos = 0, end;
+
+        for (c = 0; c < BLOCK_SIZE; c++)
+        {
+                codeblock_t *block = &codeblock[c];
+
+                if (block->valid && block->was_recompiled && block->data_len)
+                {
+                        arena_used[n].start = block->data - codeblock_data;
+                        arena_used[n].end = arena_used[n].start + block->data_len;
+                        arena_used[n].block = c;
+                        n++;
+                }
+        }
+        qsort(arena_used, n, sizeof(arena_range_t), arena_range_cmp);
+
+        arena_hole = arena_nholes = 0;
+        for (c = 0; c <= n; c++)
+        {
+                end = (c < n) ? arena_used[c].start : CODEGEN_ARENA_SIZE;
+                if (end - pos >= BLOCK_DATA_SIZE)
+                {
+                        arena_holes[arena_nholes].start = pos;
+                        arena_holes[arena_nholes].end = end;
+                        arena_nholes++;
+                }
+                if (c < n && arena_used[c].end > pos)
+                        pos = arena_used[c].end;
+        }
+
+        if (!arena_nholes)
+                codegen_arena_drop(n);
+
+        cpu_recomp_arena_scans++;
+}
+
+/*Return the code area for the block about to be recompiled. Block code is
+  bump-allocated from a free area of the codeblock_data[] arena, and a block
+  may use up to BLOCK_DATA_SIZE bytes of it.
+
+  When less than that is left in the current area, allocation moves on to the
+  next free area, and once those have all been used the arena is scanned for
+  the space freed up since. Blocks that still have their code are never moved,
+  as the generated code is not position independent (it uses relative calls),
+  so this is reuse of freed space rather than compaction; the choice of which
+  blocks lose their code is left to the eviction policy where possible.*/
+uint8_t *codegen_arena_alloc(void)
+{
+        codeblock[block_current].data_len = 0;
+
+        if (arena_top + BLOCK_DATA_SIZE > arena_end)
+        {
+                if (arena_hole >= arena_nholes)
+                        codegen_arena_scan();
+
+                arena_top = arena_holes[arena_hole].start;
+                arena_end = arena_holes[arena_hole].end;
+                arena_hole++;
+        }
+
+        return &codeblock_data[arena_top];
+}
+
+/*Keep the len bytes of code just emitted at the arena top.*/
+void codegen_arena_commit(int len)
+{
+        len = (len + 15) & ~15;
+
+        codeblock[block_current].data_len = len;
+        arena_top += len;
+}
+
+void codegen_arena_reset(void)
+{
+        arena_top = 0;
+        arena_end = CODEGEN_ARENA_SIZE;
+        arena_hole = arena_nholes = 0;
+}
+
+/*Returns 1 if the instruction overwrites CF without reading it, and can not
+  fault or leave the block before it does so (register and immediate forms
+  of ADD, OR, AND, SUB, XOR, CMP and TEST).*/
+static int codegen_kills_cf(uint8_t opcode, uint32_t fetchdat)
+{
+        switch (opcode)
+        {
+                case 0x00: case 0x01: case 0x02: case 0x03: /*ADD*/
+                case 0x08: case 0x09: case 0x0a: case 0x0b: /*OR*/
+                case 0x20: case 0x21: case 0x22: case 0x23: /*AND*/
+                case 0x28: case 0x29: case 0x2a: case 0x2b: /*SUB*/
+                case 0x30: case 0x31: case 0x32: case 0x33: /*XOR*/
+                case 0x38: case 0x39: case 0x3a: case 0x3b: /*CMP*/
+                case 0x84: case 0x85: /*TEST*/
+                return (fetchdat & 0xc0) == 0xc0;
+
+                case 0x04: case 0x05: case 0x0c: case 0x0d:
+                case 0x24: case 0x25: case 0x2c: case 0x2d:
+                case 0x34: case 0x35: case 0x3c: case 0x3d:
+                case 0xa8: case 0xa9:
+                return 1;
+
+                case 0x80: case 0x81: case 0x83: /*Not ADC or SBB*/
+                return (fetchdat & 0xc0) == 0xc0 && (fetchdat & 0x38) != 0x10 && (fetchdat & 0x38) != 0x18;
+        }
+
+        return 0;
+}
+
+/*Returns 1 if the instruction does not read CF, and can not fault or leave
+  the block (NOP, LEA, MOV of an immediate and the register forms of MOV,
+  XCHG, INC and DEC). An INC or DEC here emits no flags_rebuild_c() call of
+  its own, as the last flags op is then INC/DEC.*/
+static int codegen_keeps_cf(uint8_t opcode, uint32_t fetchdat)
+{
+        switch (opcode)
+        {
+                case 0x86: case 0x87: /*XCHG*/
+                case 0x88: case 0x89: case 0x8a: case 0x8b: /*MOV*/
+                return (fetchdat & 0xc0) == 0xc0;
+
+                case 0x8d: /*LEA*/
+                return (fetchdat & 0xc0) != 0xc0;
+        }
+
+        return (opcode >= 0x40 && opcode <= 0x4f) || /*INC, DEC*/
+               (opcode >= 0x90 && opcode <= 0x97) || /*NOP, XCHG*/
+               (opcode >= 0xb0 && opcode <= 0xbf); /*MOV*/
+}
+
+/*CF peephole, called before each instruction is generated. A register INC/DEC
+  that had to bring CF up to date leaves its flags_rebuild_c() call pending.
+  The call stays pending across instructions that keep CF and were generated
+  inline, with nothing emitted between them. If an instruction that overwrites
+  CF follows, that CF was dead; turn the call into NOPs. Anything else (a CF
+  reader, a possible fault, an interpreter call or the end of the block) keeps
+  it. This only looks at straight-line code within one block, it is not a full
+  liveness analysis.*/
+void codegen_flags_c_check(uint8_t opcode, uint32_t fetchdat, int base_table)
+{
+        if (codegen_flags_c_call == -1)
+                return;
+
+        if (codegen_flags_c_next == block_pos && base_table)
+        {
+                if (codegen_kills_cf(opcode, fetchdat))
+                {
+                        memset(&codeblock[block_current].data[codegen_flags_c_call], 0x90, codegen_flags_c_len);
+                        cpu_recomp_flags_elided++;
+                        codegen_flags_c_dropped++;
+                }
+                else if (codegen_keeps_cf(opcode, fetchdat))
+                        return;
+        }
+
+        codegen_flags_c_call = codegen_flags_c_next = -1;
+}
+
+/*Latch the code cache statistics, called once per second.*/
+void codegen_stats_latch(void)
+{
+        cpu_recomp_blocks_latched = cpu_recomp_blocks;
+        cpu_recomp_lookups_latched = cpu_recomp_lookups;
+        cpu_recomp_misses_latched = cpu_recomp_misses;
+        cpu_recomp_linked_latched = cpu_recomp_linked;
+        cpu_recomp_spared_latched = cpu_recomp_spared;
+        cpu_recomp_traces_latched = cpu_recomp_traces;
+        cpu_recomp_flags_elided_latched = cpu_recomp_flags_elided;
+        cpu_recomp_evicted_latched = cpu_recomp_evicted;
+        cpu_recomp_reuse_latched = cpu_recomp_reuse;
+        cpu_recomp_removed_latched = cpu_recomp_removed;
+        cpu_recomp_arena_scans_latched = cpu_recomp_arena_scans;
+        cpu_recomp_arena_flushes_latched = cpu_recomp_arena_flushes;
+        cpu_new_blocks_latched = cpu_new_blocks;
+
+        cpu_recomp_blocks = cpu_recomp_lookups = cpu_recomp_misses = 0;
+        cpu_recomp_linked = cpu_recomp_spared = cpu_recomp_traces = 0;
+        cpu_recomp_flags_elided = 0;
+        cpu_recomp_evicted = cpu_recomp_reuse = cpu_recomp_removed = 0;
+        cpu_recomp_arena_scans = cpu_recomp_arena_flushes = 0;
+        cpu_new_blocks = 0;
+
+        /*Keep running totals in the statistics registry.*/
+        stats_register(&codegen_compile_stats);
+        stats_register(&st_lookups);
+        stats_register(&st_misses);
+        stats_register(&st_linked);
+        stats_register(&st_new);
+        stats_register(&st_evicted);
+        stats_register(&st_flags_elided);
+        stats_register(&st_arena_scans);
+        stats_register(&st_arena_flushes);
+
+        stats_add(&st_lookups, cpu_recomp_lookups_latched);
+        stats_add(&st_misses, cpu_recomp_misses_latched);
+        stats_add(&st_linked, cpu_recomp_linked_latched);
+        stats_add(&st_new, cpu_new_blocks_latched);
+        stats_add(&st_evicted, cpu_recomp_evicted_latched);
+        stats_add(&st_flags_elided, cpu_recomp_flags_elided_latched);
+        stats_add(&st_arena_scans, cpu_recomp_arena_scans_latched);
+        stats_add(&st_arena_flushes, cpu_recomp_arena_flushes_latched);
+
+        DBGLOG(1, "CODEGEN: lookups=%i misses=%i (hit %i%%) linked=%i run=%i new=%i evicted=%i reuse=%i removed=%i spared=%i traces=%i elided=%i arena=%iK scans=%i flushes=%i\n",
+               cpu_recomp_lookups_latched, cpu_recomp_misses_latched,
+               cpu_recomp_lookups_latched ? (100 - (cpu_recomp_misses_latched * 100) / cpu_recomp_lookups_latched) : 0,
+               cpu_recomp_linked_latched, cpu_recomp_blocks_latched,
+               cpu_new_blocks_latched, cpu_recomp_evicted_latched,
+               cpu_recomp_reuse_latched, cpu_recomp_removed_latched,
+               cpu_recomp_spared_latched, cpu_recomp_traces_latched,
+               cpu_recomp_flags_elided_latched, arena_top >> 10,
+               cpu_recomp_arena_scans_latched, cpu_recomp_arena_flushes_latched);
+}
 
 /* This is for compatibility with new x87 code. */
 void codegen_set_rounding_mode(int mode)
@@ -8,7 +8,7 @@
  *
  *		Definitions for the code generator.
  *
- * Version:	@(#)codegen.h	1.0.7	2020/11/18
+ * Version:	@(#)codegen.h	1.0.13	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -82,6 +82,23 @@
   avoiding most unnecessary evictions (eg when code & data are stored in the
   same page).
 */
+
+/*Number of successor links kept per block; two covers the taken and
+  not-taken exits of a conditional branch.*/
+#define CODEBLOCK_LINKS 2
+
+/*Largest host code area a single block may use.*/
+#define BLOCK_DATA_SIZE 2048
+
+/*Size of the executable arena the block code is bump-allocated from. Most
+  blocks are well under 512 bytes, so this holds about as many blocks as there
+  are entries in codeblock[]; when it fills up, the space of blocks that have
+  lost their code is reused, see codegen_arena_alloc().*/
+#define CODEGEN_ARENA_SIZE (BLOCK_SIZE * 512)
+
+/*Amount of code dropped at once when the arena has no free space left.*/
+#define CODEGEN_ARENA_DROP (CODEGEN_ARENA_SIZE / 16)
+
 typedef struct codeblock_t
 {
         uint64_t page_mask, page_mask2;
@@ -113,7 +130,27 @@ typedef struct codeblock_t
         uint32_t status;
         uint32_t flags;
 
-        uint8_t data[2048];
+        /*Serial number, bumped every time the block is deleted. Used to detect
+          stale links to this block.*/
+        uint32_t serial;
+
+        /*Number of times the compiled block was entered since the eviction
+          hand last passed it, see codegen_block_evict_next().*/
+        uint32_t hits;
+
+        /*Links to the blocks that followed this one when it last exited, so
+          the dispatcher can skip the get_phys()/hash/tree lookup. A link is
+          only followed if the target's serial still matches and no MMU flush
+          has happened since it was made (codegen_link_gen).*/
+        struct codeblock_t *link[CODEBLOCK_LINKS];
+        uint32_t link_serial[CODEBLOCK_LINKS];
+        uint32_t link_gen[CODEBLOCK_LINKS];
+        int link_next;
+
+        /*Generated code, in the codeblock_data[] arena, and the number of
+          arena bytes it occupies. Only valid while was_recompiled is set.*/
+        uint8_t *data;
+        int data_len;
 } codeblock_t;
 
 typedef struct
@@ -127,11 +164,16 @@ typedef struct
 
 
 extern codeblock_t	*codeblock;
+extern uint8_t		*codeblock_data;
 extern codeblock_t	**codeblock_hash;
 
 extern int		cpu_block_end;
 extern uint32_t		codegen_endpc;
 
+/*Bumped by codegen_flush() whenever address translation may have changed,
+  invalidating all block links at once.*/
+extern uint32_t		codegen_link_gen;
+
 /*Current physical page of block being recompiled. -1 if no recompilation taking place */
 extern int		block_current;
 extern int		block_pos;
@@ -142,6 +184,14 @@ extern uint32_t		recomp_page;
   flags_op is known and can be relied on */
 extern int		codegen_flags_changed;
 
+/*Start and length of the flags_rebuild_c() call emitted by the last register
+  INC/DEC, and the block position at which the last instruction since then
+  ended (-1 if none), see codegen_flags_c_check(). The running totals of such
+  calls and of those dropped again are never cleared, for the benchmark.*/
+extern int		codegen_flags_c_call, codegen_flags_c_len,
+			codegen_flags_c_next;
+extern uint32_t		codegen_flags_c_calls, codegen_flags_c_dropped;
+
 extern int		codegen_in_recompile;
 
 extern int		codegen_fpu_entered;
@@ -158,7 +208,17 @@ extern int		cpu_new_blocks, cpu_new_blocks_latched,
 
 extern int      	cpu_recomp_evicted, cpu_recomp_evicted_latched,
 			cpu_recomp_reuse, cpu_recomp_reuse_latched,
-			cpu_recomp_removed, cpu_recomp_removed_latched;
+			cpu_recomp_removed, cpu_recomp_removed_latched,
+			cpu_recomp_arena_scans, cpu_recomp_arena_scans_latched,
+			cpu_recomp_arena_flushes, cpu_recomp_arena_flushes_latched;
+
+extern int		cpu_recomp_blocks, cpu_recomp_blocks_latched,
+			cpu_recomp_lookups, cpu_recomp_lookups_latched,
+			cpu_recomp_misses, cpu_recomp_misses_latched,
+			cpu_recomp_linked, cpu_recomp_linked_latched,
+			cpu_recomp_spared, cpu_recomp_spared_latched,
+			cpu_recomp_traces, cpu_recomp_traces_latched,
+			cpu_recomp_flags_elided, cpu_recomp_flags_elided_latched;
 
 extern codegen_timing_t	codegen_timing_pentium;
 extern codegen_timing_t	codegen_timing_686;
@@ -183,6 +243,15 @@ extern uint32_t	op_old_pc;
 #define CODEBLOCK_HAS_FPU 1
 /*Code block is always entered with the same FPU top-of-stack*/
 #define CODEBLOCK_STATIC_TOP 2
+/*Code block has been re-compiled as a trace; direct jumps inside it were
+  followed, but each instruction is still generated on its own, there is no
+  register allocation across instructions*/
+#define CODEBLOCK_TRACE 4
+
+/*Number of hits after which a block is re-compiled as a trace, and the
+  maximum number of direct jumps followed while doing so.*/
+#define CODEGEN_TRACE_THRESHOLD 256
+#define CODEGEN_TRACE_JUMPS 8
 
 static INLINE codeblock_t *codeblock_tree_find(uint32_t phys, uint32_t __cs)
 {
@@ -244,6 +313,9 @@ static INLINE void codeblock_tree_delete(codeblock_t *block)
 {
         codeblock_t *parent = block->parent;
 
+        /*Any links pointing at this block are now stale.*/
+        block->serial++;
+
         if (!block->left && !block->right)
         {
                 /*Easy case - remove from parent*/
@@ -355,6 +427,46 @@ static INLINE void codeblock_tree_delete(codeblock_t *block)
         }
 }
 
+/*Follow a link from the block that was executed last to the block for the
+  current CS:PC. Returns NULL if there is no usable link, in which case the
+  caller falls back to the normal lookup.*/
+static INLINE codeblock_t *codeblock_link_find(codeblock_t *prev, uint32_t pc, uint32_t __cs)
+{
+        int c;
+
+        for (c = 0; c < CODEBLOCK_LINKS; c++)
+        {
+                codeblock_t *block = prev->link[c];
+
+                if (block && block->pc == pc && block->_cs == __cs &&
+                    prev->link_serial[c] == block->serial && prev->link_gen[c] == codegen_link_gen &&
+                    block->valid && !((block->status ^ cpu_cur_status) & CPU_STATUS_FLAGS) &&
+                    ((block->status & cpu_cur_status & CPU_STATUS_MASK) == (cpu_cur_status & CPU_STATUS_MASK)))
+                        return block;
+        }
+
+        return NULL;
+}
+
+static INLINE void codeblock_link_add(codeblock_t *prev, codeblock_t *block)
+{
+        int c = prev->link_next;
+
+        prev->link[c] = block;
+        prev->link_serial[c] = block->serial;
+        prev->link_gen[c] = codegen_link_gen;
+        prev->link_next = (c + 1) % CODEBLOCK_LINKS;
+}
+
+static INLINE void codeblock_link_clear(codeblock_t *block)
+{
+        int c;
+
+        for (c = 0; c < CODEBLOCK_LINKS; c++)
+                block->link[c] = NULL;
+        block->link_next = 0;
+}
+
 #define CPU_BLOCK_END() cpu_block_end = 1
 
 static INLINE void addbyte(uint8_t val)
@@ -407,9 +519,30 @@ void codegen_generate_call(uint8_t opcode, OpFn op, uint32_t fetchdat, uint32_t
 void codegen_generate_seg_restore(void);
 void codegen_set_op32(void);
 void codegen_check_flush(page_t *page, uint64_t mask, uint32_t phys_addr);
+void codegen_flags_c_check(uint8_t opcode, uint32_t fetchdat, int base_table);
 #endif
 
 
+/*Code cache eviction policies.*/
+#define CODEGEN_EVICT_RR	0	/*plain round-robin*/
+#define CODEGEN_EVICT_CLOCK	1	/*second chance, driven by block hits*/
+
+/*Maximum number of hot blocks the CLOCK hand skips before giving up.*/
+#define CODEGEN_EVICT_PROBES	16
+
+extern int	codegen_evict_policy;
+
+int codegen_block_evict_next(void);
+uint8_t *codegen_arena_alloc(void);
+void codegen_arena_commit(int len);
+void codegen_arena_reset(void);
+void codegen_stats_latch(void);
+
+#ifdef EMU_STATS_H
+/*Host time spent (re)compiling a block, in host timer ticks.*/
+extern stats_t	codegen_compile_stats;
+#endif
+
 void codegen_init(void);
 void codegen_reset(void);
 void codegen_block_init(uint32_t phys_addr);
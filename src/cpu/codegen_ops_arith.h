@@ -8,7 +8,7 @@
  *
  *		Miscellaneous instructions.
  *
- * Version:	@(#)codegen_ops_arith.h	1.0.3	2020/12/13
+ * Version:	@(#)codegen_ops_arith.h	1.0.5	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -35,11 +35,40 @@
  *   USA.
  */
 
+/*Bring CF up to date before INC/DEC replace flags_op. This is not needed
+  if the last flags op in this block was INC/DEC too, as CF is then already
+  in cpu_state.flags. For register operands the call is remembered, so that
+  codegen_flags_c_check() can drop it again if the next instruction turns out
+  to overwrite CF without reading it.*/
+static void FLAGS_REBUILD_C(int reg_op)
+{
+        int start = block_pos;
+
+        if (codegen_flags_changed)
+        {
+                switch (cpu_state.flags_op)
+                {
+                        case FLAGS_INC8: case FLAGS_INC16: case FLAGS_INC32:
+                        case FLAGS_DEC8: case FLAGS_DEC16: case FLAGS_DEC32:
+                        return;
+                }
+        }
+
+        CALL_FUNC((uintptr_t)flags_rebuild_c);
+
+        if (reg_op)
+        {
+                codegen_flags_c_call = start;
+                codegen_flags_c_len = block_pos - start;
+                codegen_flags_c_calls++;
+        }
+}
+
 static uint32_t ropINC_rw(uint8_t opcode, uint32_t fetchdat, uint32_t op_32, uint32_t op_pc, codeblock_t *block)
 {
         int host_reg;
         
-        CALL_FUNC((uintptr_t)flags_rebuild_c);
+        FLAGS_REBUILD_C(1);
         
         host_reg = LOAD_REG_W(opcode & 7);
         
@@ -58,7 +87,7 @@ static uint32_t ropINC_rl(uint8_t opcode, uint32_t fetchdat, uint32_t op_32, uin
 {
         int host_reg;
 
-        CALL_FUNC((uintptr_t)flags_rebuild_c);
+        FLAGS_REBUILD_C(1);
         
         host_reg = LOAD_REG_L(opcode & 7);
         
@@ -77,7 +106,7 @@ static uint32_t ropDEC_rw(uint8_t opcode, uint32_t fetchdat, uint32_t op_32, uin
 {
         int host_reg;
         
-        CALL_FUNC((uintptr_t)flags_rebuild_c);
+        FLAGS_REBUILD_C(1);
 
         host_reg = LOAD_REG_W(opcode & 7);
         
@@ -96,7 +125,7 @@ static uint32_t ropDEC_rl(uint8_t opcode, uint32_t fetchdat, uint32_t op_32, uin
 {
         int host_reg;
         
-        CALL_FUNC((uintptr_t)flags_rebuild_c);
+        FLAGS_REBUILD_C(1);
 
         host_reg = LOAD_REG_L(opcode & 7);
         
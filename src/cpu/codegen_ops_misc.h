@@ -8,7 +8,7 @@
  *
  *		Miscellaneous Instructions.
  *
- * Version:	@(#)codegen_ops_misc.h	1.0.3	2020/12/05
+ * Version:	@(#)codegen_ops_misc.h	1.0.4	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -74,7 +74,7 @@ static uint32_t ropFE(uint8_t opcode, uint32_t fetchdat, uint32_t op_32, uint32_
         if ((fetchdat & 0x30) != 0x00)
                 return 0;
 
-        CALL_FUNC((uintptr_t)flags_rebuild_c);
+        FLAGS_REBUILD_C((fetchdat & 0xc0) == 0xc0);
         
         if ((fetchdat & 0xc0) == 0xc0)
                 host_reg = LOAD_REG_B(fetchdat & 7);
@@ -127,7 +127,7 @@ static uint32_t ropFF_16(uint8_t opcode, uint32_t fetchdat, uint32_t op_32, uint
                 return 0;
 
         if ((fetchdat & 0x30) == 0x00)
-                CALL_FUNC((uintptr_t)flags_rebuild_c);
+                FLAGS_REBUILD_C((fetchdat & 0xc0) == 0xc0);
 
         if ((fetchdat & 0xc0) == 0xc0)
                 host_reg = LOAD_REG_W(fetchdat & 7);
@@ -220,7 +220,7 @@ static uint32_t ropFF_32(uint8_t opcode, uint32_t fetchdat, uint32_t op_32, uint
                 return 0;
 
         if ((fetchdat & 0x30) == 0x00)
-                CALL_FUNC((uintptr_t)flags_rebuild_c);
+                FLAGS_REBUILD_C((fetchdat & 0xc0) == 0xc0);
         
         if ((fetchdat & 0xc0) == 0xc0)
                 host_reg = LOAD_REG_L(fetchdat & 7);
@@ -8,7 +8,7 @@
  *
  *		Dynamic Recompiler for Intel x64 systems.
  *
- * Version:	@(#)codegen_x86-64.c	1.0.4	2020/11/24
+ * Version:	@(#)codegen_x86-64.c	1.0.7	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -76,6 +76,7 @@ uint32_t recomp_page = -1;
 int host_reg_mapping[NR_HOST_REGS];
 int host_reg_xmm_mapping[NR_HOST_XMM_REGS];
 codeblock_t *codeblock;
+uint8_t *codeblock_data;
 codeblock_t **codeblock_hash;
 int codegen_mmx_entered = 0;
 
@@ -88,6 +89,7 @@ int cpu_recomp_reuse, cpu_recomp_reuse_latched;
 int cpu_recomp_removed, cpu_recomp_removed_latched;
 
 uint32_t codegen_endpc;
+uint32_t codegen_link_gen;
 
 int codegen_block_cycles;
 static int codegen_block_ins;
@@ -108,22 +110,28 @@ void codegen_init()
 	long pagemask = ~(pagesize - 1);
 #endif
         
+        /*Block metadata is kept in its own dense array, so lookups and list
+          walks do not have to stride across the generated code. The code
+          itself is allocated from the arena at recompile time.*/
+        codeblock = mem_alloc(BLOCK_SIZE * sizeof(codeblock_t));
 #if WIN64
-        codeblock = VirtualAlloc(NULL, BLOCK_SIZE * sizeof(codeblock_t), MEM_COMMIT, PAGE_EXECUTE_READWRITE);
+        codeblock_data = VirtualAlloc(NULL, CODEGEN_ARENA_SIZE, MEM_COMMIT, PAGE_EXECUTE_READWRITE);
 #else
-        codeblock = mem_alloc(BLOCK_SIZE * sizeof(codeblock_t));
+        codeblock_data = mem_alloc(CODEGEN_ARENA_SIZE);
 #endif
         codeblock_hash = mem_alloc(HASH_SIZE * sizeof(codeblock_t *));
 
         memset(codeblock, 0, BLOCK_SIZE * sizeof(codeblock_t));
+        memset(codeblock_data, 0, CODEGEN_ARENA_SIZE);
         memset(codeblock_hash, 0, HASH_SIZE * sizeof(codeblock_t *));
 
         for (c = 0; c < BLOCK_SIZE; c++)
                 codeblock[c].valid = 0;
+        codegen_arena_reset();
 
 #if defined(__linux__) || defined(__APPLE__)
-	start = (void *)((long)codeblock & pagemask);
-	len = ((BLOCK_SIZE * sizeof(codeblock_t)) + pagesize) & pagemask;
+	start = (void *)((long)codeblock_data & pagemask);
+	len = (CODEGEN_ARENA_SIZE + pagesize) & pagemask;
 	if (mprotect(start, len, PROT_READ | PROT_WRITE | PROT_EXEC) != 0)
 	{
 		perror("mprotect");
@@ -142,6 +150,7 @@ void codegen_reset()
 
         for (c = 0; c < BLOCK_SIZE; c++)
                 codeblock[c].valid = 0;
+        codegen_arena_reset();
 }
 
 void dump_block()
@@ -287,7 +296,7 @@ void codegen_block_init(uint32_t phys_addr)
         if (!page->block[(phys_addr >> 10) & 3])
                 mem_flush_write_page(phys_addr, cs+cpu_state.pc);
 
-        block_current = (block_current + 1) & BLOCK_MASK;
+        block_current = codegen_block_evict_next();
         block = &codeblock[block_current];
 
         if (block->valid != 0)
@@ -313,6 +322,8 @@ void codegen_block_init(uint32_t phys_addr)
         block->status = cpu_cur_status;
         
         block->was_recompiled = 0;
+        codeblock_link_clear(block);
+        block->hits = 0;
 
         recomp_page = block->phys & ~0xfff;
         
@@ -333,7 +344,8 @@ void codegen_block_start_recompile(codeblock_t *block)
                 fatal("Recompile to used block!\n");
 
         block->status = cpu_cur_status;
-        
+
+        block->data = codegen_arena_alloc();
         block_pos = BLOCK_GPF_OFFSET;
 #if 0 /* OLDGPF */
 #if WIN64
@@ -381,7 +393,7 @@ void codegen_block_start_recompile(codeblock_t *block)
         addbyte(0x5b); /*POP RDX*/
         addbyte(0xC3); /*RET*/
         cpu_block_end = 0;
-        block_pos = 0; /*Entry code*/
+        block_pos = BLOCK_START; /*Entry code*/
         addbyte(0x53); /*PUSH RBX*/
         addbyte(0x55); /*PUSH RBP*/
         addbyte(0x56); /*PUSH RSI*/
@@ -415,6 +427,7 @@ void codegen_block_start_recompile(codeblock_t *block)
         recomp_page = block->phys & ~0xfff;
         
         codegen_flags_changed = 0;
+        codegen_flags_c_call = codegen_flags_c_next = -1;
         codegen_fpu_entered = 0;
         codegen_mmx_entered = 0;
         
@@ -556,8 +569,9 @@ void codegen_block_end_recompile(codeblock_t *block)
         addbyte(0x5b); /*POP RDX*/
         addbyte(0xC3); /*RET*/
         
-        if (block_pos > BLOCK_GPF_OFFSET)
+        if (block_pos > BLOCK_DATA_SIZE)
                 fatal("Over limit!\n");
+        codegen_arena_commit(block_pos);
 
         remove_from_block_list(block, block->pc);
         block->next = block->prev = NULL;
@@ -568,7 +582,8 @@ void codegen_block_end_recompile(codeblock_t *block)
 
 void codegen_flush()
 {
-        return;
+        /*Address translation may have changed, drop all block links.*/
+        codegen_link_gen++;
 }
 
 static int opcode_modrm[256] =
@@ -1114,6 +1129,8 @@ void codegen_generate_call(uint8_t opcode, OpFn op, uint32_t fetchdat, uint32_t
         }
         
 generate_call:
+        codegen_flags_c_check(opcode, fetchdat, op_table == x86_dynarec_opcodes);
+
         codegen_timing_opcode(opcode, fetchdat, op_32);
         
         if ((op_table == x86_dynarec_opcodes &&
@@ -1160,6 +1177,9 @@ generate_call:
                         codegen_block_full_ins++;
                         codegen_endpc = (cs + cpu_state.pc) + 8;
 
+                        if (codegen_flags_c_call != -1)
+                                codegen_flags_c_next = block_pos;
+
                         return;
                 }
         }
@@ -8,7 +8,7 @@
  *
  *		Definitions for the 64-bit code generator.
  *
- * Version:	@(#)codegen_x86-64.h	1.0.3	2020/12/13
+ * Version:	@(#)codegen_x86-64.h	1.0.4	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -40,18 +40,20 @@
 
 #define BLOCK_SIZE 0x4000
 #define BLOCK_MASK 0x3fff
-#define BLOCK_START 0
+/*Each block's code area starts with the GPF and exit stubs, which the
+  generated code jumps back to; the entry point follows them.*/
+#define BLOCK_START 0x30
 
 #define HASH_SIZE 0x20000
 #define HASH_MASK 0x1ffff
 
 #define HASH(l) ((l) & 0x1ffff)
 
-#define BLOCK_EXIT_OFFSET 0x7e0
+#define BLOCK_EXIT_OFFSET 0x10
 //#define BLOCK_GPF_OFFSET (BLOCK_EXIT_OFFSET - 20)
 #define BLOCK_GPF_OFFSET (BLOCK_EXIT_OFFSET - 15)
 
-#define BLOCK_MAX 1620
+#define BLOCK_MAX (BLOCK_START + 1620)
 
 enum
 {
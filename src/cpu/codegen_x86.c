@@ -8,7 +8,7 @@
  *
  *		Dynamic Recompiler for Intel 32-bit systems.
  *
- * Version:	@(#)codegen_x86.c	1.0.9	2021/03/18
+ * Version:	@(#)codegen_x86.c	1.0.12	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Sarah Walker, <tommowalker@tommowalker.co.uk>
@@ -82,6 +82,7 @@ uint32_t recomp_page = -1;
 int host_reg_mapping[NR_HOST_REGS];
 int host_reg_xmm_mapping[NR_HOST_XMM_REGS];
 codeblock_t *codeblock;
+uint8_t *codeblock_data;
 codeblock_t **codeblock_hash;
 
 
@@ -95,6 +96,7 @@ int cpu_recomp_removed, cpu_recomp_removed_latched;
 
 
 uint32_t codegen_endpc;
+uint32_t codegen_link_gen;
 
 int codegen_block_cycles;
 static int codegen_block_ins;
@@ -1183,19 +1185,29 @@ void codegen_init()
 	long pagemask = ~(pagesize - 1);
 #endif
         
+        /*Block metadata is kept in its own dense array, so lookups and list
+          walks do not have to stride across the generated code. The code
+          itself is allocated from the arena at recompile time; the extra
+          block holds the shared memory access routines, in a fixed area
+          just past the arena.*/
+        codeblock = (codeblock_t *)mem_alloc((BLOCK_SIZE+1) * sizeof(codeblock_t));
 #ifdef _WIN32
-        codeblock = (codeblock_t *)VirtualAlloc(NULL, (BLOCK_SIZE+1) * sizeof(codeblock_t), MEM_COMMIT, PAGE_EXECUTE_READWRITE);
+        codeblock_data = (uint8_t *)VirtualAlloc(NULL, CODEGEN_ARENA_SIZE + BLOCK_DATA_SIZE, MEM_COMMIT, PAGE_EXECUTE_READWRITE);
 #else
-        codeblock = (codeblock_t *)mem_alloc((BLOCK_SIZE+1) * sizeof(codeblock_t));
+        codeblock_data = (uint8_t *)mem_alloc(CODEGEN_ARENA_SIZE + BLOCK_DATA_SIZE);
 #endif
         codeblock_hash = (codeblock_t **)mem_alloc(HASH_SIZE * sizeof(codeblock_t *));
 
         memset(codeblock, 0, (BLOCK_SIZE+1) * sizeof(codeblock_t));
+        memset(codeblock_data, 0, CODEGEN_ARENA_SIZE + BLOCK_DATA_SIZE);
         memset(codeblock_hash, 0, HASH_SIZE * sizeof(codeblock_t *));
 
+        codeblock[BLOCK_SIZE].data = &codeblock_data[CODEGEN_ARENA_SIZE];
+        codegen_arena_reset();
+
 #ifdef __linux__
-	start = (void *)((long)codeblock & pagemask);
-	len = (((BLOCK_SIZE+1) * sizeof(codeblock_t)) + pagesize) & pagemask;
+	start = (void *)((long)codeblock_data & pagemask);
+	len = ((CODEGEN_ARENA_SIZE + BLOCK_DATA_SIZE) + pagesize) & pagemask;
 	if (mprotect(start, len, PROT_READ | PROT_WRITE | PROT_EXEC) != 0)
 	{
 		perror("mprotect");
@@ -1267,6 +1279,8 @@ void codegen_reset()
         memset(codeblock, 0, BLOCK_SIZE * sizeof(codeblock_t));
         memset(codeblock_hash, 0, HASH_SIZE * sizeof(codeblock_t *));
         mem_reset_page_blocks();
+
+        codegen_arena_reset();
 }
 
 void dump_block()
@@ -1412,7 +1426,7 @@ void codegen_block_init(uint32_t phys_addr)
         if (!page->block[(phys_addr >> 10) & 3])
                 mem_flush_write_page(phys_addr, cs+cpu_state.pc);
 
-        block_current = (block_current + 1) & BLOCK_MASK;
+        block_current = codegen_block_evict_next();
         block = &codeblock[block_current];
 
         if (block->valid != 0)
@@ -1438,6 +1452,8 @@ void codegen_block_init(uint32_t phys_addr)
         block->status = cpu_cur_status;
         
         block->was_recompiled = 0;
+        codeblock_link_clear(block);
+        block->hits = 0;
 
         recomp_page = block->phys & ~0xfff;
         
@@ -1459,6 +1475,7 @@ void codegen_block_start_recompile(codeblock_t *block)
 
         block->status = cpu_cur_status;
 
+        block->data = codegen_arena_alloc();
         block_pos = BLOCK_GPF_OFFSET;
 #if 0
         addbyte(0xc7); /*MOV [ESP],0*/
@@ -1491,7 +1508,7 @@ void codegen_block_start_recompile(codeblock_t *block)
         addbyte(0x5b); /*POP EDX*/
         addbyte(0xC3); /*RET*/
         cpu_block_end = 0;
-        block_pos = 0; /*Entry code*/
+        block_pos = BLOCK_START; /*Entry code*/
         addbyte(0x53); /*PUSH EBX*/
         addbyte(0x55); /*PUSH EBP*/
         addbyte(0x56); /*PUSH ESI*/
@@ -1515,6 +1532,7 @@ void codegen_block_start_recompile(codeblock_t *block)
         recomp_page = block->phys & ~0xfff;
         
         codegen_flags_changed = 0;
+        codegen_flags_c_call = codegen_flags_c_next = -1;
         codegen_fpu_entered = 0;
         codegen_mmx_entered = 0;
 
@@ -1635,8 +1653,9 @@ void codegen_block_end_recompile(codeblock_t *block)
         addbyte(0x5b); /*POP EDX*/
         addbyte(0xC3); /*RET*/
         
-        if (block_pos > BLOCK_GPF_OFFSET)
+        if (block_pos > BLOCK_DATA_SIZE)
                 fatal("Over limit!\n");
+        codegen_arena_commit(block_pos);
 
         remove_from_block_list(block, block->pc);
         block->next = block->prev = NULL;
@@ -1650,7 +1669,8 @@ void codegen_block_end_recompile(codeblock_t *block)
 
 void codegen_flush()
 {
-        return;
+        /*Address translation may have changed, drop all block links.*/
+        codegen_link_gen++;
 }
 
 static int opcode_modrm[256] =
@@ -2048,6 +2068,8 @@ void codegen_generate_call(uint8_t opcode, OpFn op, uint32_t fetchdat, uint32_t
         }
         
 generate_call:
+        codegen_flags_c_check(opcode, fetchdat, op_table == x86_dynarec_opcodes);
+
         codegen_timing_opcode(opcode, fetchdat, op_32);
 
         if ((op_table == x86_dynarec_opcodes &&
@@ -2104,6 +2126,9 @@ generate_call:
                         codegen_block_full_ins++;
                         codegen_endpc = (cs + cpu_state.pc) + 8;
 
+                        if (codegen_flags_c_call != -1)
+                                codegen_flags_c_next = block_pos;
+
                         return;
                 }
         }
@@ -8,7 +8,7 @@
  *
  *		CPU type handler.
  *
- * Version:	@(#)cpu.c	1.0.17	2021/02/15
+ * Version:	@(#)cpu.c	1.0.20	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Sarah Walker, <tommowalker@tommowalker.co.uk>
@@ -43,12 +43,17 @@
 #include <string.h>
 #include <wchar.h>
 #include "../emu.h"
+#include "../state.h"
+#include "../stats.h"
+#include "../timer.h"
 #include "cpu.h"
 #include "../device.h"
 #include "../io.h"
 #include "x86.h"
 #include "x86_ops.h"
 #include "../mem.h"
+#include "../devices/system/clk.h"
+#include "../devices/system/nmi.h"
 #include "../devices/system/pci.h"
 #include "../plat.h"
 #ifdef USE_DYNAREC
@@ -210,6 +215,15 @@ static int	cpu_turbo = -1,
 		cpu_extfpu;
 static uint32_t	cpu_speed;
 
+/* Variables for the idle detection. */
+#define IDLE_POLLS	16		/* polls before we call it idle */
+#define IDLE_CYCLES	1000		/* max cycles between two polls */
+
+static stats_t	idle_stats = STATS_COUNTER("cpu.idle_cycles");
+static uint32_t	poll_pc;
+static int	poll_cycles,
+		poll_count;
+
 #if defined(DEV_BRANCH) && defined(USE_AMD_K)
 /* Variables for the AMD "K" processors. */
 static uint64_t	ecx83_msr = 0;			/* AMD K5 and K6 MSR's. */
@@ -305,6 +319,7 @@ cpu_activate(void)
 
     /* Select the desired CPU and/or speed. */
     cpu = &cpu_list[cpu_effective];
+    stats_register(&idle_stats);
     INFO("CPU: %s [%i] speed=%lu\n", cpu->name, cpu_effective, cpu->rspeed);
 
     CPUID    = cpu->cpuid_model;
@@ -1517,6 +1532,173 @@ cpu_set_edx(void)
 }
 
 
+/* Save the processor state. */
+void
+cpu_state_save(state_t *s)
+{
+    cpu_state_t temp;
+
+    state_begin(s, "cpu", 1);
+
+    /* The EA segment is a host pointer, and only valid within an instruction. */
+    memcpy(&temp, &cpu_state, sizeof(temp));
+    temp.ea_seg = NULL;
+    state_put(s, temp);
+
+    state_put(s, CR0);
+    state_put(s, cr2);
+    state_put(s, cr3);
+    state_put(s, cr4);
+    state_put(s, dr);
+    state_put(s, gdt);
+    state_put(s, ldt);
+    state_put(s, idt);
+    state_put(s, tr);
+    state_put(s, _oldds);
+    state_put(s, tsc);
+    state_put(s, msr);
+    state_put(s, cpu_cur_status);
+    state_put(s, cpu_cache_int_enabled);
+    state_put(s, use32);
+    state_put(s, stack32);
+    state_put(s, oldcpl);
+    state_put(s, oldcs);
+    state_put(s, cgate16);
+    state_put(s, cgate32);
+    state_put(s, cpl_override);
+    state_put(s, codegen_flat_ds);
+    state_put(s, codegen_flat_ss);
+    state_put(s, nmi);
+    state_put(s, nmi_enable);
+    state_put(s, nmi_mask);
+
+    /* Model-specific registers. */
+    state_put(s, cs_msr);
+    state_put(s, esp_msr);
+    state_put(s, eip_msr);
+    state_put(s, apic_base_msr);
+    state_put(s, mtrr_cap_msr);
+    state_put(s, mtrr_physbase_msr);
+    state_put(s, mtrr_physmask_msr);
+    state_put(s, mtrr_fix64k_8000_msr);
+    state_put(s, mtrr_fix16k_8000_msr);
+    state_put(s, mtrr_fix16k_a000_msr);
+    state_put(s, mtrr_fix4k_msr);
+    state_put(s, pat_msr);
+    state_put(s, mtrr_deftype_msr);
+    state_put(s, msr_ia32_pmc);
+    state_put(s, ecx17_msr);
+    state_put(s, ecx79_msr);
+    state_put(s, ecx8x_msr);
+    state_put(s, ecx116_msr);
+    state_put(s, ecx11x_msr);
+    state_put(s, ecx11e_msr);
+    state_put(s, ecx186_msr);
+    state_put(s, ecx187_msr);
+    state_put(s, ecx1e0_msr);
+    state_put(s, ecx570_msr);
+
+    /* Cyrix configuration registers. */
+    state_put(s, ccr0);
+    state_put(s, ccr1);
+    state_put(s, ccr2);
+    state_put(s, ccr3);
+    state_put(s, ccr4);
+    state_put(s, ccr5);
+    state_put(s, ccr6);
+    state_put(s, cyrix_addr);
+
+    /* State private to the 8088/8086 core. */
+    x86_state_save(s);
+
+    state_end(s);
+}
+
+
+/* Restore the processor state. */
+int
+cpu_state_load(state_t *s)
+{
+    if (state_open(s, "cpu") != 1)
+	return(0);
+
+    state_get(s, cpu_state);
+    cpu_state.ea_seg = &cpu_state.seg_ds;
+
+    state_get(s, CR0);
+    state_get(s, cr2);
+    state_get(s, cr3);
+    state_get(s, cr4);
+    state_get(s, dr);
+    state_get(s, gdt);
+    state_get(s, ldt);
+    state_get(s, idt);
+    state_get(s, tr);
+    state_get(s, _oldds);
+    state_get(s, tsc);
+    state_get(s, msr);
+    state_get(s, cpu_cur_status);
+    state_get(s, cpu_cache_int_enabled);
+    state_get(s, use32);
+    state_get(s, stack32);
+    state_get(s, oldcpl);
+    state_get(s, oldcs);
+    state_get(s, cgate16);
+    state_get(s, cgate32);
+    state_get(s, cpl_override);
+    state_get(s, codegen_flat_ds);
+    state_get(s, codegen_flat_ss);
+    state_get(s, nmi);
+    state_get(s, nmi_enable);
+    state_get(s, nmi_mask);
+
+    state_get(s, cs_msr);
+    state_get(s, esp_msr);
+    state_get(s, eip_msr);
+    state_get(s, apic_base_msr);
+    state_get(s, mtrr_cap_msr);
+    state_get(s, mtrr_physbase_msr);
+    state_get(s, mtrr_physmask_msr);
+    state_get(s, mtrr_fix64k_8000_msr);
+    state_get(s, mtrr_fix16k_8000_msr);
+    state_get(s, mtrr_fix16k_a000_msr);
+    state_get(s, mtrr_fix4k_msr);
+    state_get(s, pat_msr);
+    state_get(s, mtrr_deftype_msr);
+    state_get(s, msr_ia32_pmc);
+    state_get(s, ecx17_msr);
+    state_get(s, ecx79_msr);
+    state_get(s, ecx8x_msr);
+    state_get(s, ecx116_msr);
+    state_get(s, ecx11x_msr);
+    state_get(s, ecx11e_msr);
+    state_get(s, ecx186_msr);
+    state_get(s, ecx187_msr);
+    state_get(s, ecx1e0_msr);
+    state_get(s, ecx570_msr);
+
+    state_get(s, ccr0);
+    state_get(s, ccr1);
+    state_get(s, ccr2);
+    state_get(s, ccr3);
+    state_get(s, ccr4);
+    state_get(s, ccr5);
+    state_get(s, ccr6);
+    state_get(s, cyrix_addr);
+
+    x86_state_load(s);
+
+    /* Throw away anything derived from the old state. */
+    cpu_update_waitstates();
+    flushmmucache();
+#ifdef USE_DYNAREC
+    codegen_reset();
+#endif
+
+    return(state_end(s));
+}
+
+
 char *
 cpu_current_pc(char *bufp)
 {
@@ -2400,6 +2582,93 @@ cpu_exec(int slice)
 }
 
 
+/*
+ * The guest is idle, waiting for an interrupt or a device.
+ *
+ * Nothing it does until the next timer fires can change the
+ * outcome, so we skip ahead to that point in emulated time,
+ * but never beyond the end of the current time slice. This
+ * keeps the guest timing exact, while saving us the host
+ * time otherwise spent running the same few instructions.
+ */
+void
+cpu_idle(void)
+{
+    tmrval_t left;
+
+    if (! idle_skip) return;
+
+    /* How far away is the next timer event? */
+    if (AT) {
+	left = timer_count - (timer_start - ((tmrval_t)cycles << TIMER_SHIFT));
+	left >>= TIMER_SHIFT;
+    } else {
+	left = timer_count - (timer_start - ((tmrval_t)cycles * cpu_clock_multi));
+	left /= cpu_clock_multi;
+    }
+    if (left > cycles)
+	left = cycles;
+    if (left <= 0) return;
+
+    cycles -= (int)left;
+
+    stats_add(&idle_stats, left);
+}
+
+
+/*
+ * Look for the guest polling a port in a tight loop.
+ *
+ * Called for every port read. Reads of the usual suspects
+ * (keyboard controller, refresh bit, video status) from the
+ * same instruction in quick succession mean the guest is busy
+ * waiting, so after a while we let it idle until the next
+ * timer event. Any other read means it is doing real work.
+ *
+ * The PIT counters are not on the list. Their values follow
+ * the elapsed cycles, not timer events, so a guest polling
+ * them (for a short delay, or to calibrate its timing) would
+ * overshoot if we skipped ahead to the next timer event.
+ */
+void
+cpu_idle_poll(uint16_t port)
+{
+    uint32_t pc;
+    int delta;
+
+    switch (port) {
+	case 0x0060:		/* keyboard controller */
+	case 0x0061:
+	case 0x0064:
+	case 0x03ba:		/* MDA/CGA/EGA status */
+	case 0x03da:
+		break;
+
+	default:
+		poll_count = 0;
+		return;
+    }
+
+    pc = cs + cpu_state.pc;
+    delta = poll_cycles - cycles;
+    if ((delta < 0) || (delta > IDLE_CYCLES)) {
+	/* Too long ago, start over here. */
+	poll_pc = pc;
+	poll_cycles = cycles;
+	poll_count = 0;
+	return;
+    }
+
+    /* Other reads inside the same loop are fine. */
+    if (pc != poll_pc) return;
+
+    if (++poll_count >= IDLE_POLLS)
+	cpu_idle();
+
+    poll_cycles = cycles;
+}
+
+
 void
 #ifdef USE_DYNAREC
 x86_setopcodes(const OpFn *opcodes, const OpFn *opcodes_0f,
@@ -8,7 +8,7 @@
  *
  *		Definitions for the CPU module.
  *
- * Version:	@(#)cpu.h	1.0.17	2021/02/15
+ * Version:	@(#)cpu.h	1.0.20	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -446,9 +446,16 @@ extern void	cpu_update_waitstates(void);
 extern char	*cpu_current_pc(char *bufp);
 extern void	cpu_set_edx(void);
 extern void	cpu_reset(int hard);
+extern void	cpu_set_start(uint16_t seg, uint16_t ip);
+#ifdef EMU_STATE_H
+extern void	cpu_state_save(state_t *);
+extern int	cpu_state_load(state_t *);
+#endif
 extern void	cpu_dumpregs(int __force);
 
 extern void	cpu_exec(int slice);
+extern void	cpu_idle(void);
+extern void	cpu_idle_poll(uint16_t port);
 
 extern void	cpu_CPUID(void);
 extern void	cpu_RDMSR(void);
@@ -0,0 +1,248 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Sampling profiler for guest code.
+ *
+ *		An emulated timer fires every PROF_PERIOD microseconds
+ *		(of emulated time), and records where the CPU is: the
+ *		CS:PC, its physical address, the CPU status flags, and
+ *		whether that code was being run by the interpreter, as
+ *		a recompiled block, or while being recompiled. Samples
+ *		for the same address are counted in a hash table, and
+ *		when the emulator exits, a report sorted by hit count
+ *		is written, showing where the guest spends its time.
+ *
+ *		Since timers only run between blocks, the address of a
+ *		dynarec sample is that of the next block to run, and
+ *		the block is the one that ran last.
+ *
+ * Version:	@(#)profile.c	1.0.2	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ *		Redistribution and  use  in source  and binary forms, with
+ *		or  without modification, are permitted  provided that the
+ *		following conditions are met:
+ *
+ *		1. Redistributions of  source  code must retain the entire
+ *		   above notice, this list of conditions and the following
+ *		   disclaimer.
+ *
+ *		2. Redistributions in binary form must reproduce the above
+ *		   copyright  notice,  this list  of  conditions  and  the
+ *		   following disclaimer in  the documentation and/or other
+ *		   materials provided with the distribution.
+ *
+ *		3. Neither the  name of the copyright holder nor the names
+ *		   of  its  contributors may be used to endorse or promote
+ *		   products  derived from  this  software without specific
+ *		   prior written permission.
+ *
+ * THIS SOFTWARE  IS  PROVIDED BY THE  COPYRIGHT  HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND  ANY EXPRESS  OR  IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE  ARE  DISCLAIMED. IN  NO  EVENT  SHALL THE COPYRIGHT
+ * HOLDER OR  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL,  EXEMPLARY,  OR  CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES;  LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON  ANY
+ * THEORY OF  LIABILITY, WHETHER IN  CONTRACT, STRICT  LIABILITY, OR  TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING  IN ANY  WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include "../emu.h"
+#include "../timer.h"
+#include "../mem.h"
+#include "../plat.h"
+#include "../machines/machine.h"
+#include "cpu.h"
+#include "profile.h"
+
+
+/* One hot spot. */
+typedef struct {
+    uint32_t	phys;				/* physical address */
+    uint32_t	pc;				/* offset in segment */
+    uint16_t	seg;				/* code segment selector */
+    uint8_t	mode;				/* PROF_xxx */
+    uint8_t	used;
+    uint32_t	status;				/* cpu_cur_status */
+    uint32_t	block;				/* dynarec block */
+    uint32_t	count;				/* number of samples */
+} prof_spot_t;
+
+
+int		prof_mode = PROF_INTERP;
+uint32_t	prof_block;
+
+
+static FILE	*prof_fp;
+static prof_spot_t *prof_spots;
+static int	prof_used;
+static uint32_t	prof_total,			/* total samples taken */
+		prof_lost;			/* samples lost (table full) */
+static tmrval_t	prof_time;
+
+
+static const char *prof_modes[] = {
+    "interp", "dynarec", "recompile"
+};
+
+
+/* Take a sample. */
+static void
+prof_sample(UNUSED(priv_t priv))
+{
+    prof_spot_t *sp;
+    uint32_t addr, hash;
+    int i;
+
+    prof_time += (tmrval_t)(PROF_PERIOD * TIMER_USEC);
+
+    /* Find the physical address without disturbing the TLB. */
+    addr = cs + cpu_state.pc;
+    if (cr0 >> 31)
+	addr = mmutranslate_noabrt(addr, 0);
+    addr &= rammask;
+
+    prof_total++;
+
+    hash = ((addr * 2654435761U) ^ (CS << 4) ^ prof_mode) & (PROF_SIZE - 1);
+    for (i = 0; i < PROF_SIZE; i++) {
+	sp = &prof_spots[(hash + i) & (PROF_SIZE - 1)];
+
+	if (! sp->used) {
+		if (prof_used >= (PROF_SIZE * 3 / 4)) break;
+		prof_used++;
+
+		sp->used = 1;
+		sp->phys = addr;
+		sp->seg = CS;
+		sp->mode = prof_mode;
+		sp->count = 0;
+	} else if ((sp->phys != addr) || (sp->seg != CS) ||
+		   (sp->mode != prof_mode))
+		continue;
+
+	sp->pc = cpu_state.pc;
+	sp->status = cpu_cur_status;
+	sp->block = (prof_mode != PROF_INTERP) ? prof_block : 0;
+	sp->count++;
+
+	return;
+    }
+
+    prof_lost++;
+}
+
+
+static int
+prof_compare(const void *a, const void *b)
+{
+    const prof_spot_t *sa = (const prof_spot_t *)a;
+    const prof_spot_t *sb = (const prof_spot_t *)b;
+
+    if (sa->count != sb->count)
+	return((sa->count < sb->count) ? 1 : -1);
+
+    return((sa->phys < sb->phys) ? -1 : (sa->phys > sb->phys));
+}
+
+
+/* Write the hot-spot report. */
+static void
+prof_report(FILE *fp)
+{
+    uint32_t mode_count[3];
+    prof_spot_t *sp;
+    int i;
+
+    /* Sort the table by hit count, unused entries last. */
+    qsort(prof_spots, PROF_SIZE, sizeof(prof_spot_t), prof_compare);
+
+    memset(mode_count, 0x00, sizeof(mode_count));
+    for (i = 0; i < prof_used; i++)
+	mode_count[prof_spots[i].mode] += prof_spots[i].count;
+
+    fprintf(fp, "# %s %s guest profile, %s on %s\n",
+	    emu_title, emu_version, cpu_get_name(), machine_get_name());
+    fprintf(fp, "# %lu samples (%lu lost), one every %i usec\n",
+	    (unsigned long)prof_total, (unsigned long)prof_lost, PROF_PERIOD);
+    for (i = 0; i < 3; i++)
+	fprintf(fp, "# %-9s %10lu  %5.1f%%\n", prof_modes[i],
+		(unsigned long)mode_count[i],
+		prof_total ? (100.0 * mode_count[i] / prof_total) : 0.0);
+    fprintf(fp, "#\n#    count      %%  phys      cs:pc          status    mode       block\n");
+
+    for (i = 0; i < prof_used; i++) {
+	sp = &prof_spots[i];
+
+	fprintf(fp, "%10lu %6.2f  %08lx  %04x:%08lx  %08lx  %-9s",
+		(unsigned long)sp->count, 100.0 * sp->count / prof_total,
+		(unsigned long)sp->phys, sp->seg, (unsigned long)sp->pc,
+		(unsigned long)sp->status, prof_modes[sp->mode]);
+	if (sp->mode != PROF_INTERP)
+		fprintf(fp, "  %08lx", (unsigned long)sp->block);
+	fprintf(fp, "\n");
+    }
+}
+
+
+/* Set up the profiler, and open the report file. */
+int
+prof_open(const wchar_t *fn)
+{
+    prof_fp = plat_fopen(fn, L"w");
+    if (prof_fp == NULL) {
+	ERRLOG("PROF: unable to create '%ls'\n", fn);
+	return(0);
+    }
+
+    prof_spots = (prof_spot_t *)mem_alloc(PROF_SIZE * sizeof(prof_spot_t));
+    memset(prof_spots, 0x00, PROF_SIZE * sizeof(prof_spot_t));
+    prof_used = 0;
+    prof_total = prof_lost = 0;
+
+    INFO("PROF: profiling guest code to '%ls'\n", fn);
+
+    return(1);
+}
+
+
+/* Add our timer again after a (hard) reset. */
+void
+prof_reset(void)
+{
+    if (prof_fp == NULL) return;
+
+    prof_time = (tmrval_t)(PROF_PERIOD * TIMER_USEC);
+    timer_add(prof_sample, NULL, &prof_time, TIMER_ALWAYS_ENABLED);
+}
+
+
+/* Write the report, and release all resources. */
+void
+prof_close(void)
+{
+    if (prof_fp == NULL) return;
+
+    prof_report(prof_fp);
+
+    (void)fclose(prof_fp);
+    prof_fp = NULL;
+
+    free(prof_spots);
+    prof_spots = NULL;
+}
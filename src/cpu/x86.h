@@ -8,7 +8,7 @@
  *
  *		Definitions for the X86 architecture.
  *
- * Version:	@(#)x86.h	1.0.3	2020/11/19
+ * Version:	@(#)x86.h	1.0.4	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -155,6 +155,10 @@ extern void	x86seg_reset(void);
 extern void	x86gpf(char *s, uint16_t error);
 
 extern void	execx86(int cycs);
+#ifdef EMU_STATE_H
+extern void	x86_state_save(state_t *);
+extern void	x86_state_load(state_t *);
+#endif
 extern void	exec386(int cycs);
 extern void	exec386_dynarec(int cycs);
 
@@ -8,7 +8,7 @@
  *
  *		Miscellaneous x86 CPU Instructions.
  *
- * Version:	@(#)x86_ops_misc.h	1.0.8	2020/12/15
+ * Version:	@(#)x86_ops_misc.h	1.0.9	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -669,6 +669,10 @@ static int opHLT(uint32_t fetchdat)
         {
                 CLOCK_CYCLES_ALWAYS(100);
                 cpu_state.pc--;
+
+                /*Nothing to do until an interrupt, skip ahead.*/
+                if (cpu_state.flags & I_FLAG)
+                        cpu_idle();
         }
         else
                 CLOCK_CYCLES(5);
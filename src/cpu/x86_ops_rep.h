@@ -8,7 +8,7 @@
  *
  *		Miscellaneous x86 CPU Instructions.
  *
- * Version:	@(#)x86_ops_rep.h	1.0.5	2020/12/11
+ * Version:	@(#)x86_ops_rep.h	1.0.6	2026/10/18
  *
  * Authors:	Sarah Walker, <tommowalker@tommowalker.co.uk>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -85,6 +85,31 @@ static int opREP_INSW_ ## size(uint32_t fetchdat)
                 CNT_REG--;                                                      \
                 cycles -= 15;                                                   \
                 reads++; writes++; total_cycles += 15;                          \
+                                                                                \
+                /*The element above has made sure the page is there, so the     \
+                  rest of it can be filled in one go if the port supports       \
+                  block transfers.*/                                            \
+                if (CNT_REG > 0 && !(cpu_state.flags & (D_FLAG | T_FLAG)))      \
+                {                                                               \
+                        uint16_t buf[2048];                                     \
+                        int max, max2, n, c;                                    \
+                                                                                \
+                        max = (0x1000 - ((es + DEST_REG) & 0xfff)) & 0xfff;     \
+                        max2 = (0x1000 - (DEST_REG & 0xfff)) & 0xfff;           \
+                        if (max2 < max) max = max2;                             \
+                        max >>= 1;                                              \
+                        if (max > CNT_REG) max = CNT_REG;                       \
+                                                                                \
+                        n = max ? inw_block(DX, buf, max) : 0;                  \
+                        for (c = 0; c < n; c++)                                 \
+                        {                                                       \
+                                writememw(es, DEST_REG, buf[c]);                \
+                                DEST_REG += 2;                                  \
+                        }                                                       \
+                        CNT_REG -= n;                                           \
+                        cycles -= 15 * n;                                       \
+                        reads += n; writes += n; total_cycles += 15 * n;        \
+                }                                                               \
         }                                                                       \
         PREFETCH_RUN(total_cycles, 1, -1, reads, 0, writes, 0, 0);              \
         if (CNT_REG > 0)                                                        \
@@ -170,6 +195,28 @@ static int opREP_OUTSW_ ## size(uint32_t fetchdat)
                 CNT_REG--;                                                      \
                 cycles -= 14;                                                   \
                 reads++; writes++; total_cycles += 14;                          \
+                                                                                \
+                /*Likewise, hand the rest of the page to the port in one go.*/  \
+                if (CNT_REG > 0 && !(cpu_state.flags & (D_FLAG | T_FLAG)))      \
+                {                                                               \
+                        uint16_t buf[2048];                                     \
+                        uint32_t base = cpu_state.ea_seg->base;                 \
+                        int max, max2, n, c;                                    \
+                                                                                \
+                        max = (0x1000 - ((base + SRC_REG) & 0xfff)) & 0xfff;    \
+                        max2 = (0x1000 - (SRC_REG & 0xfff)) & 0xfff;            \
+                        if (max2 < max) max = max2;                             \
+                        max >>= 1;                                              \
+                        if (max > CNT_REG) max = CNT_REG;                       \
+                                                                                \
+                        for (c = 0; c < max; c++)                               \
+                                buf[c] = readmemw(base, SRC_REG + (c << 1));    \
+                        n = max ? outw_block(DX, buf, max) : 0;                 \
+                        SRC_REG += n << 1;                                      \
+                        CNT_REG -= n;                                           \
+                        cycles -= 14 * n;                                       \
+                        reads += n; writes += n; total_cycles += 14 * n;        \
+                }                                                               \
         }                                                                       \
         PREFETCH_RUN(total_cycles, 1, -1, reads, 0, writes, 0, 0);              \
         if (CNT_REG > 0)                                                        \
@@ -11,7 +11,7 @@
  *
  * **TODO**	Merge the various 'add' variants, its getting too messy.
  *
- * Version:	@(#)device.c	1.0.30	2021/03/16
+ * Version:	@(#)device.c	1.0.33	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -45,6 +45,7 @@
 #include <stdlib.h>
 #include <wchar.h>
 #include "emu.h"
+#include "state.h"
 #include "config.h"
 #include "mem.h"
 #include "rom.h"
@@ -419,6 +420,122 @@ device_reset_all(int flags)
 }
 
 
+/*
+ * Stop (0) or restart (1) any threads the devices run on the host,
+ * when the process forks. Devices that have threads, but no hook
+ * for this, will leave them running, and the caller should check.
+ */
+void
+device_threads(int start)
+{
+    int c;
+
+    for (c = 0; c < DEVICE_MAX; c++) {
+	if ((devices[c] != NULL) && (devices[c]->threads != NULL))
+		devices[c]->threads(device_priv[c], start);
+    }
+}
+
+
+/*
+ * State hooks for devices that have nothing of their own to save,
+ * such as machines whose parts are all saved elsewhere. Using these
+ * marks the device as safe to include in a saved state.
+ */
+void
+device_nostate_save(UNUSED(priv_t priv), UNUSED(state_t *s))
+{
+}
+
+
+int
+device_nostate_load(UNUSED(priv_t priv), UNUSED(state_t *s), UNUSED(int version))
+{
+    return(1);
+}
+
+
+/*
+ * Save the state of all devices.
+ *
+ * All active devices must be able to save their state, or the
+ * machine would come back inconsistent when it is restored, so
+ * if any of them can not, we list them all and give up.
+ */
+int
+device_state_save(state_t *s)
+{
+    int32_t n = 0;
+    int c, bad = 0;
+
+    for (c = 0; c < DEVICE_MAX; c++) {
+	if (devices[c] == NULL) continue;
+
+	if ((devices[c]->save == NULL) || (devices[c]->load == NULL)) {
+		ERRLOG("DEVICE: '%s' can not save its state!\n",
+		       devices[c]->name);
+		bad++;
+	} else
+		n++;
+    }
+    if (bad > 0)
+	return(0);
+
+    state_begin(s, "devices", 1);
+    state_put(s, n);
+    state_end(s);
+
+    for (c = 0; c < DEVICE_MAX; c++) {
+	if ((devices[c] == NULL) || (devices[c]->save == NULL)) continue;
+
+	state_begin(s, devices[c]->name, devices[c]->state_version);
+	devices[c]->save(device_priv[c], s);
+	state_end(s);
+    }
+
+    return(1);
+}
+
+
+/* Restore the state of all devices that support it. */
+int
+device_state_load(state_t *s)
+{
+    int32_t n = 0;
+    int c, i, ver;
+
+    for (c = 0; c < DEVICE_MAX; c++)
+	if ((devices[c] != NULL) && (devices[c]->save != NULL)) n++;
+
+    if ((state_open(s, "devices") != 1) || !state_get(s, i) || !state_end(s))
+	return(0);
+    if (i != n) {
+	ERRLOG("DEVICE: state has %i devices, machine has %i!\n", i, n);
+	return(0);
+    }
+
+    for (c = 0; c < DEVICE_MAX; c++) {
+	if ((devices[c] == NULL) || (devices[c]->save == NULL)) continue;
+
+	ver = state_open(s, devices[c]->name);
+	if (ver < 0)
+		return(0);
+
+	if ((ver > devices[c]->state_version) || (devices[c]->load == NULL) ||
+	    !devices[c]->load(device_priv[c], s, ver)) {
+		ERRLOG("DEVICE: unable to restore '%s' (version %i)\n",
+		       devices[c]->name, ver);
+		return(0);
+	}
+
+	if (! state_end(s))
+		return(0);
+    }
+
+    return(1);
+}
+
+
 priv_t
 device_get_priv(const device_t *d)
 {
@@ -8,7 +8,7 @@
  *
  *		Definitions for the device handler.
  *
- * Version:	@(#)device.h	1.0.16	2021/03/16
+ * Version:	@(#)device.h	1.0.19	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -103,6 +103,8 @@ typedef struct {
     devcfg_spinner_t	spinner;
 } device_config_t;
 
+struct _state_;				// see state.h
+
 typedef struct _device_ {
     const char	*name;
     uint32_t	flags;			// system flags
@@ -123,6 +125,12 @@ typedef struct _device_ {
 #define mca_reslist	u2_reuse
 #define mach_info	u2_reuse
     const device_config_t *config;
+
+    int		state_version;		// version of saved state data
+    void	(*save)(priv_t, struct _state_ *);
+    int		(*load)(priv_t, struct _state_ *, int version);
+
+    void	(*threads)(priv_t, int start);	// stop/restart host threads
 } device_t;
 
 
@@ -146,9 +154,17 @@ extern const char	*device_get_bus_name(const device_t *);
 extern int		device_available(const device_t *);
 extern void		device_speed_changed(void);
 extern void		device_force_redraw(void);
+extern void		device_threads(int start);
 
 extern int		device_is_valid(const device_t *, int machine_flags);
 
+#ifdef EMU_STATE_H
+extern int		device_state_save(state_t *);
+extern int		device_state_load(state_t *);
+#endif
+extern void		device_nostate_save(priv_t, struct _state_ *);
+extern int		device_nostate_load(priv_t, struct _state_ *, int version);
+
 extern int		device_get_config_int(const char *name);
 extern int		device_get_config_int_ex(const char *s, int dflt);
 extern int		device_get_config_hex16(const char *name);
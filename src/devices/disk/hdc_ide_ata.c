@@ -14,7 +14,7 @@
  *		Devices currently implemented are hard disk, CD-ROM and
  *		ZIP IDE/ATAPI devices.
  *
- * Version:	@(#)hdc_ide_ata.c	1.0.38	2021/03/16
+ * Version:	@(#)hdc_ide_ata.c	1.0.40	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -48,6 +48,7 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -56,6 +57,7 @@
 #include "../../emu.h"
 #include "../../version.h"
 #include "../../timer.h"
+#include "../../state.h"
 #include "../../cpu/cpu.h"
 #include "../../io.h"
 #include "../../mem.h"
@@ -1077,6 +1079,38 @@ ide_writew(uint16_t addr, uint16_t val, priv_t priv)
 }
 
 
+/*
+ * Block write to the data port (REP OUTSW.) Everything but the last
+ * word of the sector is copied straight into the sector buffer, the
+ * last one goes through ide_write_data() so it can finish the sector.
+ */
+static int
+ide_writew_block(uint16_t addr, const uint16_t *buf, int count, priv_t priv)
+{
+    ide_board_t *dev = (ide_board_t *)priv;
+    ide_t *ide;
+    int n;
+
+    ide = ide_drives[dev->cur_dev];
+
+    if ((addr & 0x7) || (ide->type == IDE_NONE) ||
+	(ide->buffer == NULL) || (ide->command == WIN_PACKETCMD))
+	return(0);
+
+    n = (512 - ide->pos) >> 1;
+    if (n > count)
+	n = count;
+    if (n <= 0)
+	return(0);
+
+    memcpy(&ide->buffer[ide->pos >> 1], buf, (n - 1) << 1);
+    ide->pos += (n - 1) << 1;
+    ide_write_data(ide, buf[n - 1], 2);
+
+    return(n);
+}
+
+
 static void
 ide_writel(uint16_t addr, uint32_t val, priv_t priv)
 {
@@ -1743,6 +1777,34 @@ ide_readw(uint16_t addr, priv_t priv)
 }
 
 
+/* Block read from the data port (REP INSW), see ide_writew_block(). */
+static int
+ide_readw_block(uint16_t addr, uint16_t *buf, int count, priv_t priv)
+{
+    ide_board_t *dev = (ide_board_t *)priv;
+    ide_t *ide;
+    int n;
+
+    ide = ide_drives[dev->cur_dev];
+
+    if ((addr & 0x7) || (ide->buffer == NULL) ||
+	(ide->command == WIN_PACKETCMD))
+	return(0);
+
+    n = (512 - ide->pos) >> 1;
+    if (n > count)
+	n = count;
+    if (n <= 0)
+	return(0);
+
+    memcpy(buf, &ide->buffer[ide->pos >> 1], (n - 1) << 1);
+    ide->pos += (n - 1) << 1;
+    buf[n - 1] = (uint16_t)ide_read_data(ide, 2);
+
+    return(n);
+}
+
+
 static uint32_t
 ide_readl(uint16_t addr, priv_t priv)
 {
@@ -2258,6 +2320,9 @@ ide_set_handlers(uint8_t board)
 			      ide_writeb,          ide_writew, NULL,
 			      ide_boards[board]);
 	}
+	io_sethandler_block(ide_base_main[board], 1,
+			    ide_readw_block, ide_writew_block,
+			    ide_boards[board]);
 	io_sethandler(ide_base_main[board] + 1, 7,
 		      ide_readb,           NULL,       NULL,
 		      ide_writeb,          NULL,       NULL,
@@ -2587,6 +2652,120 @@ ide_reset(priv_t priv)
 }
 
 
+/*
+ * Save or restore one board and its two drives. The ATA register
+ * file (everything up to the buffer pointers) is dumped as-is, the
+ * data buffers follow so a transfer in progress can be resumed.
+ * The board callback is a timer, and restored by the timer module.
+ * ATAPI units only get their ATA side saved here.
+ */
+static int
+ide_board_state(state_t *s, int board, int load)
+{
+#define IDE_STATE(x)	if (load) state_get(s, x); else state_put(s, x)
+    ide_board_t *dev = ide_boards[board];
+    ide_t *ide;
+    int8_t here;
+    int d;
+
+    here = (dev != NULL);
+    IDE_STATE(here);
+    if (here != (dev != NULL))
+	return(0);
+    if (dev == NULL)
+	return(1);
+
+    IDE_STATE(dev->bit32);
+    IDE_STATE(dev->cur_dev);
+    IDE_STATE(dev->irq);
+
+    for (d = board << 1; d < ((board + 1) << 1); d++) {
+	ide = ide_drives[d];
+
+	here = (ide != NULL);
+	IDE_STATE(here);
+	if (here != (ide != NULL))
+		return(0);
+	if (ide == NULL)
+		continue;
+
+	if (load)
+		state_read(s, ide, offsetof(ide_t, buffer));
+	  else
+		state_write(s, ide, offsetof(ide_t, buffer));
+	IDE_STATE(ide->interrupt_drq);
+
+	here = (ide->buffer != NULL);
+	IDE_STATE(here);
+	if (here != (ide->buffer != NULL))
+		return(0);
+	if (ide->buffer != NULL) {
+		if (load)
+			state_read(s, ide->buffer, 65536 * sizeof(uint16_t));
+		  else
+			state_write(s, ide->buffer, 65536 * sizeof(uint16_t));
+	}
+
+	here = (ide->sector_buffer != NULL);
+	IDE_STATE(here);
+	if (here != (ide->sector_buffer != NULL))
+		return(0);
+	if (ide->sector_buffer != NULL) {
+		if (load)
+			state_read(s, ide->sector_buffer, 256 * 512);
+		  else
+			state_write(s, ide->sector_buffer, 256 * 512);
+	}
+    }
+#undef IDE_STATE
+
+    return(1);
+}
+
+
+static void
+ide_save(UNUSED(priv_t priv), state_t *s)
+{
+    (void)ide_board_state(s, 0, 0);
+    (void)ide_board_state(s, 1, 0);
+}
+
+
+static int
+ide_load(UNUSED(priv_t priv), state_t *s, UNUSED(int version))
+{
+    return(ide_board_state(s, 0, 1) && ide_board_state(s, 1, 1));
+}
+
+
+static void
+ide_ter_save(UNUSED(priv_t priv), state_t *s)
+{
+    (void)ide_board_state(s, 2, 0);
+}
+
+
+static int
+ide_ter_load(UNUSED(priv_t priv), state_t *s, UNUSED(int version))
+{
+    return(ide_board_state(s, 2, 1));
+}
+
+
+static void
+ide_qua_save(UNUSED(priv_t priv), state_t *s)
+{
+    (void)ide_board_state(s, 3, 0);
+}
+
+
+static int
+ide_qua_load(UNUSED(priv_t priv), state_t *s, UNUSED(int version))
+{
+    return(ide_board_state(s, 3, 1));
+}
+
+
 /* Close a standalone IDE unit. */
 static void
 ide_close(priv_t priv)
@@ -2618,7 +2797,8 @@ const device_t ide_isa_device = {
     NULL,
     ide_init, ide_close, ide_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, ide_save, ide_load
 };
 
 const device_t ide_isa_2ch_device = {
@@ -2628,7 +2808,8 @@ const device_t ide_isa_2ch_device = {
     NULL,
     ide_init, ide_close, ide_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, ide_save, ide_load
 };
 
 const device_t ide_vlb_device = {
@@ -2638,7 +2819,8 @@ const device_t ide_vlb_device = {
     NULL,
     ide_init, ide_close, ide_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, ide_save, ide_load
 };
 
 const device_t ide_vlb_2ch_device = {
@@ -2648,7 +2830,8 @@ const device_t ide_vlb_2ch_device = {
     NULL,
     ide_init, ide_close, ide_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, ide_save, ide_load
 };
 
 const device_t ide_pci_device = {
@@ -2658,7 +2841,8 @@ const device_t ide_pci_device = {
     NULL,
     ide_init, ide_close, ide_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, ide_save, ide_load
 };
 
 const device_t ide_pci_2ch_device = {
@@ -2668,7 +2852,8 @@ const device_t ide_pci_2ch_device = {
     NULL,
     ide_init, ide_close, ide_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, ide_save, ide_load
 };
 
 
@@ -2720,7 +2905,8 @@ const device_t ide_ter_device = {
     NULL,
     ide_ter_init, ide_ter_close, NULL,
     NULL, NULL, NULL, NULL,
-    ide_ter_config
+    ide_ter_config,
+    1, ide_ter_save, ide_ter_load
 };
 
 
@@ -2772,5 +2958,6 @@ const device_t ide_qua_device = {
     NULL,
     ide_qua_init, ide_qua_close, NULL,
     NULL, NULL, NULL, NULL,
-    ide_qua_config
+    ide_qua_config,
+    1, ide_qua_save, ide_qua_load
 };
@@ -8,7 +8,7 @@
  *
  *		Definitions for the hard disk image handler.
  *
- * Version:	@(#)hdd.h	1.0.17	2021/03/22
+ * Version:	@(#)hdd.h	1.0.18	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -129,6 +129,7 @@ extern uint8_t	hdd_image_get_type(uint8_t id);
 extern void	hdd_image_specify(uint8_t id, int hpc, int spt);
 extern void	hdd_image_unload(uint8_t id, int fn_preserve);
 extern void	hdd_image_close(uint8_t id);
+extern int	hdd_image_cow(void);
 extern void	hdd_image_calc_chs(uint32_t *c, uint32_t *h, uint32_t *s, uint32_t size);
 
 #ifdef USE_MINIVHD
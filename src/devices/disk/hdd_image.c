@@ -14,7 +14,7 @@
  *		merged with hdd.c, since that is the scope of hdd.c. The
  *		actual format handlers can then be in hdd_format.c etc.
  *
- * Version:	@(#)hdd_image.c	1.0.15	2021/03/18
+ * Version:	@(#)hdd_image.c	1.0.17	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -54,6 +54,7 @@
 #define HAVE_STDARG_H
 #define dbglog hdd_image_log
 #include "../../emu.h"
+#include "../../stats.h"
 #include "../../plat.h"
 #include "../../misc/random.h"
 #include "hdd.h"
@@ -67,6 +68,16 @@
 #define HDD_IMAGE_HDX 2
 #define HDD_IMAGE_VHD 3
 
+#define COW_SHIFT	6			/* 64 sectors per chunk */
+#define COW_SECTORS	(1 << COW_SHIFT)
+#define COW_MASK	(COW_SECTORS - 1)
+
+
+/* A chunk of sectors written since the image went copy-on-write. */
+typedef struct {
+    uint64_t	present;			/* bitmap of sectors held */
+    uint8_t	data[COW_SECTORS << 9];
+} cow_chunk_t;
 
 typedef struct {
     FILE	*file;
@@ -78,6 +89,9 @@ typedef struct {
 #ifdef USE_MINIVHD
     MVHDMeta	*vhd;
 #endif
+
+    cow_chunk_t	**cow;				/* copy-on-write overlay */
+    uint32_t	cow_chunks;
 } hdd_image_t;
 
 
@@ -87,6 +101,10 @@ int		hdd_image_do_log = ENABLE_HDD_LOG;
 hdd_image_t	hdd_images[HDD_NUM];
 
 
+static stats_t	hdd_read_stats = STATS_COUNTER("hdd.sectors_read");
+static stats_t	hdd_write_stats = STATS_COUNTER("hdd.sectors_written");
+
+
 void
 hdd_image_log(int level, const char *fmt, ...)
 {
@@ -233,6 +251,9 @@ hdd_image_init(void)
 
     for (i = 0; i < HDD_NUM; i++)
 	memset(&hdd_images[i], 0, sizeof(hdd_image_t));
+
+    stats_register(&hdd_read_stats);
+    stats_register(&hdd_write_stats);
 }
 
 
@@ -472,6 +493,121 @@ hdd_image_load(int id)
 }
 
 
+/* Copy any sectors written since going copy-on-write over the buffer. */
+static void
+cow_read(hdd_image_t *img, uint32_t sector, uint32_t count, uint8_t *buffer)
+{
+    cow_chunk_t *chunk;
+    uint32_t i, c;
+
+    for (i = 0; i < count; i++) {
+	c = (sector + i) >> COW_SHIFT;
+	if (c >= img->cow_chunks) break;
+
+	chunk = img->cow[c];
+	if ((chunk != NULL) &&
+	    (chunk->present & (1ULL << ((sector + i) & COW_MASK))))
+		memcpy(buffer + (i << 9),
+		       &chunk->data[((sector + i) & COW_MASK) << 9], 512);
+    }
+}
+
+
+/* Write sectors into the overlay; a NULL buffer writes zeroes. */
+static void
+cow_write(hdd_image_t *img, uint32_t sector, uint32_t count, const uint8_t *buffer)
+{
+    cow_chunk_t *chunk;
+    uint32_t i, c;
+    uint8_t *ptr;
+
+    for (i = 0; i < count; i++) {
+	c = (sector + i) >> COW_SHIFT;
+	if (c >= img->cow_chunks) break;
+
+	chunk = img->cow[c];
+	if (chunk == NULL) {
+		chunk = (cow_chunk_t *)mem_alloc(sizeof(cow_chunk_t));
+		chunk->present = 0ULL;
+		img->cow[c] = chunk;
+	}
+
+	ptr = &chunk->data[((sector + i) & COW_MASK) << 9];
+	if (buffer != NULL)
+		memcpy(ptr, buffer + (i << 9), 512);
+	  else
+		memset(ptr, 0x00, 512);
+	chunk->present |= (1ULL << ((sector + i) & COW_MASK));
+
+	img->pos = sector + i;
+    }
+}
+
+
+static void
+cow_free(hdd_image_t *img)
+{
+    uint32_t c;
+
+    if (img->cow == NULL) return;
+
+    for (c = 0; c < img->cow_chunks; c++)
+	if (img->cow[c] != NULL)
+		free(img->cow[c]);
+    free(img->cow);
+
+    img->cow = NULL;
+    img->cow_chunks = 0;
+}
+
+
+/*
+ * Switch all loaded images to copy-on-write mode.
+ *
+ * Used when the emulator is cloned (forked) into several copies
+ * of the same running machine. Each copy re-opens the images
+ * read-only, with its own file position, and keeps any sectors
+ * it writes in memory, so the copies do not see each other's
+ * writes, and the image files are never modified.
+ */
+int
+hdd_image_cow(void)
+{
+    hdd_image_t *img;
+    uint32_t sectors;
+    FILE *fp;
+    int id;
+
+    for (id = 0; id < HDD_NUM; id++) {
+	img = &hdd_images[id];
+	if (! img->loaded || (img->cow != NULL)) continue;
+
+	if (img->file == NULL) {
+		ERRLOG("HDD: image %i can not be made copy-on-write!\n", id);
+		return(0);
+	}
+
+	fp = plat_fopen(hdd[id].fn, L"rb");
+	if (fp == NULL) {
+		ERRLOG("HDD: unable to re-open image '%ls'\n", hdd[id].fn);
+		return(0);
+	}
+	(void)fclose(img->file);
+	img->file = fp;
+
+	sectors = img->last_sector + 1;
+	img->cow_chunks = (sectors + COW_MASK) >> COW_SHIFT;
+	img->cow = (cow_chunk_t **)mem_alloc(img->cow_chunks * sizeof(cow_chunk_t *));
+	memset(img->cow, 0x00, img->cow_chunks * sizeof(cow_chunk_t *));
+
+	DEBUG("HDD: image %i is now copy-on-write (%lu sectors)\n",
+	      id, (unsigned long)sectors);
+    }
+
+    return(1);
+}
+
+
 void
 hdd_image_seek(uint8_t id, uint32_t sector)
 {
@@ -491,6 +627,8 @@ hdd_image_read(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     hdd_image_t *img = &hdd_images[id];
     uint32_t i;
  
+    stats_add(&hdd_read_stats, count);
+
 #ifdef USE_MINIVHD
     if (img->type == HDD_IMAGE_VHD) {
 	int non_transferred_sectors = mvhd_read_sectors(img->vhd, sector, count, buffer);
@@ -518,6 +656,9 @@ hdd_image_read(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
 		/* Update position. */
 		img->pos = sector + i;
 	}
+
+	if (img->cow != NULL)
+		cow_read(img, sector, count, buffer);
 #ifdef USE_MINIVHD
     }
 #endif
@@ -553,11 +694,16 @@ hdd_image_read_ex(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     if ((sectors - sector) < transfer_sectors)
 	transfer_sectors = sectors - sector;
 
+    stats_add(&hdd_read_stats, count);
+
     img->pos = sector;
 
     fseeko64(img->file, ((uint64_t)sector << 9LL) + img->base, SEEK_SET);
     fread(buffer, 1, transfer_sectors << 9, img->file);
 
+    if (img->cow != NULL)
+	cow_read(img, sector, transfer_sectors, buffer);
+
     if (ferror(img->file) || (count != transfer_sectors))
 	return 1;
 
@@ -574,12 +720,19 @@ hdd_image_write(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
 #endif
     uint32_t i;
 
+    stats_add(&hdd_write_stats, count);
+
 #ifdef USE_MINIVHD
     if (img->type == HDD_IMAGE_VHD) {
 	remaining = mvhd_write_sectors(img->vhd, sector, count, buffer);
 	img->pos = sector + count - remaining - 1;
     } else {
 #endif
+	if (img->cow != NULL) {
+		cow_write(img, sector, count, buffer);
+		return;
+	}
+
 	/* Move to the desired position in the image. */
 	fseeko64(img->file, ((uint64_t)sector << 9LL) + img->base, SEEK_SET);
 
@@ -610,9 +763,16 @@ hdd_image_write_ex(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     uint32_t transfer_sectors = count;
     uint32_t sectors = hdd_sectors(id);
 
+    stats_add(&hdd_write_stats, count);
+
     if ((sectors - sector) < transfer_sectors)
 	transfer_sectors = sectors - sector;
 
+    if (img->cow != NULL) {
+	cow_write(img, sector, transfer_sectors, buffer);
+	return((count != transfer_sectors) ? 1 : 0);
+    }
+
     img->pos = sector;
 
     fseeko64(img->file, ((uint64_t)sector << 9LL) + img->base, SEEK_SET);
@@ -636,12 +796,19 @@ hdd_image_zero(uint8_t id, uint32_t sector, uint32_t count)
 #endif
     uint32_t i = 0;
 
+    stats_add(&hdd_write_stats, count);
+
 #ifdef USE_MINIVHD
     if (img->type == HDD_IMAGE_VHD) {
 	remaining = mvhd_format_sectors (img->vhd, sector, count);
 	img->pos = sector + count - remaining - 1;
     } else {
 #endif
+	if (img->cow != NULL) {
+		cow_write(img, sector, count, NULL);
+		return;
+	}
+
 	memset(empty, 0x00, sizeof(empty));
 
 	/* Move to the desired position in the image. */
@@ -674,9 +841,16 @@ hdd_image_zero_ex(uint8_t id, uint32_t sector, uint32_t count)
     uint32_t sectors = hdd_sectors(id);
     uint32_t i = 0;
 
+    stats_add(&hdd_write_stats, count);
+
     if ((sectors - sector) < transfer_sectors)
 	transfer_sectors = sectors - sector;
 
+    if (img->cow != NULL) {
+	cow_write(img, sector, transfer_sectors, NULL);
+	return((count != transfer_sectors) ? 1 : 0);
+    }
+
     memset(empty, 0x00, sizeof(empty));
 
     img->pos = sector;
@@ -728,6 +902,9 @@ hdd_image_specify(uint8_t id, int hpc, int spt)
 	hdd[id].at_hpc = hpc;
 	hdd[id].at_spt = spt;
 
+	/* Do not update the image header in copy-on-write mode. */
+	if (img->cow != NULL) return;
+
 	fseeko64(img->file, 0x20, SEEK_SET);
 
 	fwrite(&(hdd[id].at_spt), 1, 4, img->file);
@@ -758,6 +935,8 @@ hdd_image_unload(uint8_t id, int fn_preserve)
 	img->loaded = 0;
     }
 
+    cow_free(img);
+
     img->last_sector = -1;
 
     memset(hdd[id].prev_fn, 0, sizeof(hdd[id].prev_fn));
@@ -786,6 +965,8 @@ hdd_image_close(uint8_t id)
 #endif
     }
 
+    cow_free(img);
+
     memset(img, 0x00, sizeof(hdd_image_t));
 
     img->loaded = 0;
@@ -9,7 +9,7 @@
  *		Implementation of the NEC uPD-765 and compatible floppy disk
  *		controller.
  *
- * Version:	@(#)fdc.c	1.0.30	2021/05/24
+ * Version:	@(#)fdc.c	1.0.31	2026/10/18
  *
  * Authors:	Miran Grca, <mgrca8@gmail.com>
  *		Sarah Walker, <tommowalker@tommowalker.co.uk>
@@ -37,6 +37,7 @@
  */
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
@@ -45,6 +46,7 @@
 #define dbglog fdc_log
 #include "../../emu.h"
 #include "../../timer.h"
+#include "../../state.h"
 #include "../../cpu/cpu.h"
 #include "../../io.h"
 #include "../../mem.h"
@@ -2262,6 +2264,32 @@ fdc_close(priv_t priv)
 }
 
 
+/*
+ * The controller has no pointers, so everything up to its
+ * timers (which the timer module restores) goes out as-is.
+ * The media itself is re-attached from the configuration.
+ */
+static void
+fdc_save(priv_t priv, state_t *s)
+{
+    state_write(s, priv, offsetof(fdc_t, time));
+
+    fdd_state_io(s, 0);
+}
+
+
+static int
+fdc_load(priv_t priv, state_t *s, UNUSED(int version))
+{
+    if (! state_read(s, priv, offsetof(fdc_t, time)))
+	return(0);
+
+    fdd_state_io(s, 1);
+
+    return(1);
+}
+
+
 static priv_t
 fdc_init(const device_t *info, UNUSED(void *parent))
 {
@@ -2314,7 +2342,8 @@ const device_t fdc_xt_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_xt_amstrad_device = {
@@ -2324,7 +2353,8 @@ const device_t fdc_xt_amstrad_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_xt_tandy_device = {
@@ -2334,7 +2364,8 @@ const device_t fdc_xt_tandy_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_pcjr_device = {
@@ -2344,7 +2375,8 @@ const device_t fdc_pcjr_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_at_device = {
@@ -2354,7 +2386,8 @@ const device_t fdc_at_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_at_actlow_device = {
@@ -2364,7 +2397,8 @@ const device_t fdc_at_actlow_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_at_ps1_device = {
@@ -2374,7 +2408,8 @@ const device_t fdc_at_ps1_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_at_smc_device = {
@@ -2384,7 +2419,8 @@ const device_t fdc_at_smc_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_at_winbond_device = {
@@ -2394,7 +2430,8 @@ const device_t fdc_at_winbond_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_at_nsc_device = {
@@ -2404,7 +2441,8 @@ const device_t fdc_at_nsc_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_toshiba_device = {
@@ -2414,7 +2452,8 @@ const device_t fdc_toshiba_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
 
 const device_t fdc_dp8473_device = {
@@ -2424,5 +2463,6 @@ const device_t fdc_dp8473_device = {
     NULL,
     fdc_init, fdc_close, fdc_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, fdc_save, fdc_load
 };
@@ -8,7 +8,7 @@
  *
  *		Implementation of the floppy drive emulation.
  *
- * Version:	@(#)fdd.c	1.0.22	2021/02/06
+ * Version:	@(#)fdd.c	1.0.23	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -45,6 +45,7 @@
 #define dbglog fdd_log
 #include "../../emu.h"
 #include "../../timer.h"
+#include "../../state.h"
 #include "../../ui/ui.h"
 #include "../../plat.h"
 #include "fdd.h"
@@ -300,6 +301,30 @@ fdd_seek(int drive, int track_diff)
 }
 
 
+/* Save or restore the head positions of all drives. */
+void
+fdd_state_io(state_t *s, int load)
+{
+    int i;
+
+    for (i = 0; i < FDD_NUM; i++) {
+	if (load) {
+		state_get(s, fdd[i].track);
+		state_get(s, fdd[i].densel);
+		state_get(s, fdd[i].head);
+		state_get(s, motoron[i]);
+		state_get(s, fdd_changed[i]);
+	} else {
+		state_put(s, fdd[i].track);
+		state_put(s, fdd[i].densel);
+		state_put(s, fdd[i].head);
+		state_put(s, motoron[i]);
+		state_put(s, fdd_changed[i]);
+	}
+    }
+}
+
+
 int
 fdd_track0(int drive)
 {
@@ -8,7 +8,7 @@
  *
  *		Definitions for the floppy drive emulation.
  *
- * Version:	@(#)fdd.h	1.0.12	2021/02/06
+ * Version:	@(#)fdd.h	1.0.13	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -101,12 +101,15 @@ extern int	fdd_changed[FDD_NUM];
 extern int	drive_empty[FDD_NUM];
 
 
+struct _state_;				/* see state.h */
+
 extern void	fdd_log(int level, const char *fmt, ...);
 
 extern void	fdd_do_seek(int drive, int track);
 extern void	fdd_forced_seek(int drive, int track_diff);
 extern void	fdd_seek(int drive, int track_diff);
 extern int	fdd_track0(int drive);
+extern void	fdd_state_io(struct _state_ *, int load);
 extern int	fdd_getrpm(int drive);
 extern void	fdd_set_densel(int densel);
 extern int	fdd_can_read_medium(int drive);
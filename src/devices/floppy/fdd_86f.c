@@ -10,7 +10,7 @@
  *		data in the form of FM/MFM-encoded transitions) which also
  *		forms the core of the emulator's floppy disk emulation.
  *
- * Version:	@(#)fdd_86f.c	1.0.20	2021/03/18
+ * Version:	@(#)fdd_86f.c	1.0.21	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -1119,11 +1119,7 @@ d86f_get_bit(int drive, int side)
 	encoded_data |= (d86f_handler[drive].encoded_data(drive, side)[track_word] >> 8);
     }
 
-    /*
-     * In some cases, misidentification occurs so we need
-     * to make sure the surface data array is not not NULL.
-     */
-    if (d86f_has_surface_desc(drive) && dev->track_surface_data[side]) {
+    if (d86f_has_surface_desc(drive)) {
 	if (d86f_reverse_bytes(drive)) {
 		surface_data = dev->track_surface_data[side][track_word] & 0xFF;
 	} else {
@@ -1135,7 +1131,7 @@ d86f_get_bit(int drive, int side)
     current_bit = (encoded_data >> track_bit) & 1;
     dev->last_word[side] <<= 1;
 
-    if (d86f_has_surface_desc(drive) && dev->track_surface_data[side]) {
+    if (d86f_has_surface_desc(drive)) {
 	surface_bit = (surface_data >> track_bit) & 1;
 	if (! surface_bit)
 		dev->last_word[side] |= current_bit;
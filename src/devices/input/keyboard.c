@@ -8,7 +8,7 @@
  *
  *		General keyboard driver interface.
  *
- * Version:	@(#)keyboard.c	1.0.14	2019/04/26
+ * Version:	@(#)keyboard.c	1.0.15	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -44,6 +44,7 @@
 #define HAVE_STDARG_H
 #define dbglog kbd_log
 #include "../../emu.h"
+#include "../../journal.h"
 #include "../../plat.h"
 #include "../../ui/ui.h"
 #include "keyboard.h"
@@ -205,6 +206,9 @@ keyboard_input(int down, uint16_t scan)
 {
     int uiflag = 0;
 
+    /* In journal mode, input is handed to us at the next frame. */
+    if (journal_key(down, scan)) return;
+
     /* Translate E0 xx scan codes to 01xx because we use 512-byte arrays for states
        and scan code sets. */
     if ((scan >> 8) == 0xe0) {
@@ -16,7 +16,7 @@
  *		 it either will not process ctrl-alt-esc, or it will not do
  *		 ANY input.
  *
- * Version:	@(#)keyboard_at.c	1.0.32	2021/03/16
+ * Version:	@(#)keyboard_at.c	1.0.33	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -56,6 +56,7 @@
 #include "../../mem.h"
 #include "../../timer.h"
 #include "../../device.h"
+#include "../../state.h"
 #include "../system/pic.h"
 #include "../system/pit.h"
 #include "../system/ppi.h"
@@ -3242,6 +3243,74 @@ kbd_close(priv_t priv)
 }
 
 
+static void
+kbd_state_io(state_t *s, atkbd_t *dev, int load)
+{
+#define KBD_STATE(x)	if (load) state_get(s, x); else state_put(s, x)
+    KBD_STATE(dev->initialized);
+    KBD_STATE(dev->want60);
+    KBD_STATE(dev->wantirq);
+    KBD_STATE(dev->wantirq12);
+    KBD_STATE(dev->command);
+    KBD_STATE(dev->status);
+    KBD_STATE(dev->mem);
+    KBD_STATE(dev->out);
+    KBD_STATE(dev->out_new);
+    KBD_STATE(dev->out_delayed);
+    KBD_STATE(dev->secr_phase);
+    KBD_STATE(dev->mem_addr);
+    KBD_STATE(dev->input_port);
+    KBD_STATE(dev->output_port);
+    KBD_STATE(dev->old_output_port);
+    KBD_STATE(dev->key_command);
+    KBD_STATE(dev->key_wantdata);
+    KBD_STATE(dev->last_irq);
+    KBD_STATE(dev->last_scan_code);
+    KBD_STATE(dev->dtrans);
+    KBD_STATE(dev->first_write);
+    KBD_STATE(dev->refresh);
+    KBD_STATE(dev->output_locked);
+    KBD_STATE(dev->ami_stat);
+
+    KBD_STATE(key_ctrl_queue);
+    KBD_STATE(key_ctrl_queue_start);
+    KBD_STATE(key_ctrl_queue_end);
+    KBD_STATE(key_queue);
+    KBD_STATE(key_queue_start);
+    KBD_STATE(key_queue_end);
+    KBD_STATE(mouse_queue);
+    KBD_STATE(mouse_queue_start);
+    KBD_STATE(mouse_queue_end);
+    KBD_STATE(sc_or);
+    KBD_STATE(keyboard_mode);
+    KBD_STATE(keyboard_set3_flags);
+    KBD_STATE(keyboard_set3_all_repeat);
+    KBD_STATE(keyboard_set3_all_break);
+#undef KBD_STATE
+}
+
+
+static void
+kbd_save(priv_t priv, state_t *s)
+{
+    kbd_state_io(s, (atkbd_t *)priv, 0);
+}
+
+
+static int
+kbd_load(priv_t priv, state_t *s, UNUSED(int version))
+{
+    atkbd_t *dev = (atkbd_t *)priv;
+
+    kbd_state_io(s, dev, 1);
+
+    /* The scancode map follows from the restored mode. */
+    set_scancode_map(dev);
+
+    return(1);
+}
+
+
 static priv_t
 kbd_init(const device_t *info, UNUSED(void *parent))
 {
@@ -3312,7 +3381,8 @@ const device_t keyboard_at_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_at_ami_device = {
@@ -3322,7 +3392,8 @@ const device_t keyboard_at_ami_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_at_toshiba_device = {
@@ -3332,7 +3403,8 @@ const device_t keyboard_at_toshiba_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_device = {
@@ -3342,7 +3414,8 @@ const device_t keyboard_ps2_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_pci_device = {
@@ -3352,7 +3425,8 @@ const device_t keyboard_ps2_pci_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_ps1_device = {
@@ -3362,7 +3436,8 @@ const device_t keyboard_ps2_ps1_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_ps2_device = {
@@ -3372,7 +3447,8 @@ const device_t keyboard_ps2_ps2_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_acer_device = {
@@ -3386,7 +3462,8 @@ const device_t keyboard_ps2_acer_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_ami_device = {
@@ -3396,7 +3473,8 @@ const device_t keyboard_ps2_ami_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_ami_pci_device = {
@@ -3406,7 +3484,8 @@ const device_t keyboard_ps2_ami_pci_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_mca_device = {
@@ -3416,7 +3495,8 @@ const device_t keyboard_ps2_mca_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_mca_2_device = {
@@ -3426,7 +3506,8 @@ const device_t keyboard_ps2_mca_2_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_quadtel_device = {
@@ -3436,7 +3517,8 @@ const device_t keyboard_ps2_quadtel_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 const device_t keyboard_ps2_xi8088_device = {
@@ -3446,7 +3528,8 @@ const device_t keyboard_ps2_xi8088_device = {
     NULL,
     kbd_init, kbd_close, kbd_reset,
     NULL, NULL, NULL, NULL,
-    NULL
+    NULL,
+    1, kbd_save, kbd_load
 };
 
 
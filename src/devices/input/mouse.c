@@ -8,7 +8,7 @@
  *
  *		Common driver module for MOUSE devices.
  *
- * Version:	@(#)mouse.c	1.0.22	2019/05/17
+ * Version:	@(#)mouse.c	1.0.23	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -56,6 +56,7 @@
 #include "../../emu.h"
 #include "../../config.h"
 #include "../../device.h"
+#include "../../journal.h"
 #include "../../plat.h"
 #include "mouse.h"
 
@@ -171,6 +172,9 @@ mouse_poll(void)
 #endif
 
     if (mouse_func != NULL) {
+	/* Record (or replay) what we will report. */
+	journal_mouse(&mouse_x, &mouse_y, &mouse_z, &mouse_buttons);
+
     	if (! mouse_func(mouse_x,mouse_y,mouse_z,mouse_buttons, mouse_priv)) {
 		/* Poll failed, maybe port closed? */
 		mouse_close();
@@ -11,7 +11,7 @@
  * FIXME:	We should move the "receiver thread" out of the providers,
  *		and into here, really.
  *
- * Version:	@(#)network.c	1.0.23	2021/03/23
+ * Version:	@(#)network.c	1.0.25	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *
@@ -58,6 +58,7 @@
 #include "../../emu.h"
 #include "../../config.h"
 #include "../../device.h"
+#include "../../journal.h"
 #include "../../ui/ui.h"
 #include "../../plat.h"
 #include "network.h"
@@ -320,6 +321,42 @@ network_close(void)
 }
 
 
+/*
+ * Detach the card from the host network provider, but remember
+ * the card, so network_resume() can attach it again. Used when
+ * the process forks, as the provider's sockets and its polling
+ * thread can not be shared with the new process.
+ */
+void
+network_suspend(void)
+{
+    if (netdata.network == NET_NONE) return;
+
+    if (networks[netdata.network].net != NULL)
+	networks[netdata.network].net->close();
+    netdata.network = NET_NONE;
+}
+
+
+/* Attach the card to the host network provider again. */
+int
+network_resume(void)
+{
+    if ((config.network_type == NET_NONE) ||
+	(config.network_card == NET_CARD_NONE) || (netdata.mac == NULL))
+	return(0);
+
+    if (networks[config.network_type].net->reset(netdata.mac) < 0) {
+	ERRLOG("NETWORK: unable to re-open %s!\n",
+	       networks[config.network_type].net->name);
+	return(-1);
+    }
+    netdata.network = config.network_type;
+
+    return(1);
+}
+
+
 /*
  * Reset the network card(s).
  *
@@ -368,6 +405,12 @@ network_reset(void)
 void
 network_tx(uint8_t *bufp, int len)
 {
+    /* When replaying, the outside world is in the journal. */
+    if (journal_mode == JOURNAL_REPLAY) return;
+
+    /* Not attached to the host (anymore), drop it. */
+    if (netdata.network == NET_NONE) return;
+
     ui_sb_icon_update(SB_NETWORK, 1);
 
 #if defined(WALTJE) && defined(_DEBUG) && ENABLE_NETWORK_DUMP
@@ -390,6 +433,9 @@ network_tx(uint8_t *bufp, int len)
 void
 network_rx(uint8_t *bufp, int len)
 {
+    /* In journal mode, packets are handed to us at the next frame. */
+    if (journal_net(bufp, len)) return;
+
     ui_sb_icon_update(SB_NETWORK, 1);
 
 #if defined(WALTJE) && defined(_DEBUG) && ENABLE_NETWORK_DUMP
@@ -8,7 +8,7 @@
  *
  *		Definitions for the network module.
  *
- * Version:	@(#)network.h	1.0.10	2021/03/22
+ * Version:	@(#)network.h	1.0.11	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *
@@ -106,6 +106,8 @@ extern void		network_log(int level, const char *fmt, ...);
 
 extern void		network_init(void);
 extern void		network_close(void);
+extern void		network_suspend(void);
+extern int		network_resume(void);
 extern void		network_reset(void);
 extern int		network_attach(void *, uint8_t *, NETRXCB);
 extern void		network_tx(uint8_t *, int);
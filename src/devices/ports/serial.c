@@ -32,7 +32,7 @@
  *		The lower half of the driver can interface to the host system
  *		serial ports, or other channels, for real-world access.
  *
- * Version:	@(#)serial.c	1.0.20	2021/03/16
+ * Version:	@(#)serial.c	1.0.21	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *
@@ -914,6 +914,23 @@ serial_link(int port, const char *arg)
 #endif
 
 
+/* Check if any of the serial ports is linked to a host port. */
+int
+serial_linked(void)
+{
+#ifdef USE_HOST_SERIAL
+    int i;
+
+    for (i = 0; i < SERIAL_MAX; i++) {
+	if (ports[i].bh != NULL)
+		return(1);
+    }
+#endif
+
+    return(0);
+}
+
+
 /* API: clear the FIFO buffers of a serial port. */
 void
 serial_clear(priv_t arg)
@@ -8,7 +8,7 @@
  *
  *		Definitions for the SERIAL card.
  *
- * Version:	@(#)serial.h	1.0.11	2019/05/13
+ * Version:	@(#)serial.h	1.0.12	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *
@@ -87,6 +87,7 @@ extern void	serial_reset(void);
 extern void	serial_setup(int port, uint16_t addr, int8_t irq);
 extern void	*serial_attach(int port, serial_ops_t *ops, priv_t priv);
 extern int	serial_link(int port, const char *name);
+extern int	serial_linked(void);
 
 extern void	serial_clear(priv_t arg);
 extern void	serial_write(priv_t arg, uint8_t *ptr, uint8_t len);
@@ -8,7 +8,7 @@
  *
  *		Interface to the OpenAL sound processing library.
  *
- * Version:	@(#)openal.c	1.0.22	2021/03/19
+ * Version:	@(#)openal.c	1.0.25	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -55,6 +55,7 @@
 #include "../../emu.h"
 #include "../../config.h"
 #include "../../ui/ui.h"
+#include "../../stats.h"
 #include "../../plat.h"
 #include "sound.h"
 #include "midi.h"
@@ -70,6 +71,10 @@
 #endif
 
 
+static stats_t		underruns = STATS_COUNTER("sound.underruns");
+static stats_t		dropped = STATS_COUNTER("sound.dropped");
+
+
 #ifdef USE_OPENAL
 static ALuint		buffers[4],		/* front and back buffers */
 			buffers_cd[4],		/* front and back buffers */
@@ -218,6 +223,12 @@ openal_init(void)
     const char *fn = PATH_AL_DLL;
     const char *str;
     char *sp;
+#endif
+
+    stats_register(&underruns);
+    stats_register(&dropped);
+
+#ifdef USE_OPENAL
 
     /* Try loading the DLL if needed. */
     if (openal_handle == NULL) {
@@ -263,6 +274,20 @@ openal_init(void)
 }
 
 
+/* Open the output device again, after openal_close(). */
+void
+openal_restart(void)
+{
+#ifdef USE_OPENAL
+    if (openal_handle == NULL) return;
+
+    alutInit(NULL, NULL);
+#endif
+
+    openal_reset();
+}
+
+
 /* Reset the OpenAL interface and its buffers. */
 //FIXME: isnt this a major memory leak, we never free buffers!  --FvK
 void
@@ -272,7 +297,6 @@ openal_reset(void)
     float *buf = NULL, *cd_buf = NULL, *midi_buf = NULL;
     int16_t *buf_int16 = NULL, *cd_buf_int16 = NULL, *midi_buf_int16 = NULL;
     int c;
-#endif
     int init_midi = 0;
     const char *str;
 
@@ -285,8 +309,6 @@ openal_reset(void)
     (strcmp(str, "none") && strcmp(str, SYSTEM_MIDI_INT)))
            init_midi = 1;
 
-
-#ifdef USE_OPENAL
     if (config.sound_is_float) {
 	buf = (float *)mem_alloc((BUFLEN << 1) * sizeof(float));
 	cd_buf = (float *)mem_alloc((CD_BUFLEN << 1) * sizeof(float));
@@ -394,11 +416,17 @@ openal_buffer_common(void *buf, uint8_t src, int size, int freq)
     f_alGetSourcei(source[src], AL_SOURCE_STATE, &state);
 
     if (state == 0x1014) {
+	/* The source ran dry, so we were too late. */
+	stats_inc(&underruns);
+
 	f_alSourcePlay(source[src]);
     }
 
     f_alGetSourcei(source[src], AL_BUFFERS_PROCESSED, &processed);
-    if (processed >= 1) {
+    if (processed < 1) {
+	/* No free buffer, this one gets lost. */
+	stats_inc(&dropped);
+    } else {
 	gain = pow(10.0, (double)config.sound_gain / 20.0);
 	f_alListenerf(AL_GAIN, (float)gain);
 
@@ -8,7 +8,7 @@
  *
  *		Implementation of the TI SN74689 PSG sound devices.
  *
- * Version:	@(#)snd_sn76489.c	1.0.9	2019/05/13
+ * Version:	@(#)snd_sn76489.c	1.0.10	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -46,6 +46,7 @@
 #include "../../emu.h"
 #include "../../io.h"
 #include "../../device.h"
+#include "../../journal.h"
 #include "../../plat.h"
 #include "sound.h"
 #include "snd_sn76489.h"
@@ -224,13 +225,16 @@ void sn74689_set_extra_divide(sn76489_t *sn76489, int enable)
 
 void sn76489_init(sn76489_t *sn76489, uint16_t base, uint16_t size, int type, int freq)
 {
+        uint32_t seed = (uint32_t)time(NULL);
+
         sound_add_handler(sn76489_get_buffer, sn76489);
 
         sn76489->latch[0] = sn76489->latch[1] = sn76489->latch[2] = sn76489->latch[3] = 0x3FF << 6;
         sn76489->vol[0] = 0;
         sn76489->vol[1] = sn76489->vol[2] = sn76489->vol[3] = 8;
         sn76489->stat[0] = sn76489->stat[1] = sn76489->stat[2] = sn76489->stat[3] = 127;
-        srand((int)time(NULL));
+        journal_sync(JNL_SEED, &seed, sizeof(seed));
+        srand(seed);
         sn76489->count[0] = 0;
         sn76489->count[1] = (rand()&0x3FF)<<6;
         sn76489->count[2] = (rand()&0x3FF)<<6;
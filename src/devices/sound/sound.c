@@ -8,7 +8,7 @@
  *
  *		Sound emulation core.
  *
- * Version:	@(#)sound.c	1.0.21	2020/07/14
+ * Version:	@(#)sound.c	1.0.22	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -432,6 +432,34 @@ sound_close(void)
 }
 
 
+/*
+ * Stop (0) or restart (1) the host side of the sound system, that
+ * is, the CD-Audio thread and the OpenAL output. Used when the
+ * process forks, as neither can be shared with the new process.
+ */
+void
+sound_host(int start)
+{
+    if (start) {
+	openal_restart();
+
+	if (cd_thread_enable) {
+		cd_audioon = 1;
+
+		cd_event = thread_create_event();
+		cd_thread_h = thread_create(cd_thread, NULL);
+
+		thread_wait_event(cd_start_event, -1);
+		thread_reset_event(cd_start_event);
+	}
+    } else {
+	cd_thread_end();
+
+	openal_close();
+    }
+}
+
+
 void
 sound_cd_stop(void)
 {
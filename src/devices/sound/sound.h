@@ -8,7 +8,7 @@
  *
  *		Definitions for the Sound Emulation core.
  *
- * Version:	@(#)sound.h	1.0.13	2021/06/03
+ * Version:	@(#)sound.h	1.0.14	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -109,12 +109,14 @@ extern void	sound_reset(void);
 extern void	sound_init(void);
 extern void	sound_close(void);
 
+extern void	sound_host(int start);
 extern void	sound_cd_stop(void);
 extern void	sound_cd_set_volume(unsigned int vol_l, unsigned int vol_r);
 
 extern void	openal_close(void);
 extern void	openal_init(void);
 extern void	openal_reset(void);
+extern void	openal_restart(void);
 extern void	openal_buffer(void *buf);
 extern void	openal_buffer_cd(void *buf);
 extern void	openal_buffer_midi(void *buf, uint32_t size);
@@ -8,7 +8,7 @@
  *
  *		Implementation of the Intel DMA controllers.
  *
- * Version:	@(#)dma.c	1.0.12	2019/05/17
+ * Version:	@(#)dma.c	1.0.15	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -41,6 +41,8 @@
 #include <string.h>
 #include <wchar.h>
 #include "../../emu.h"
+#include "../../state.h"
+#include "../../stats.h"
 #include "../../cpu/cpu.h"
 #include "../../cpu/x86.h"
 #include "../../mem.h"
@@ -73,6 +75,9 @@ static struct {
     int	is_ps2;
 } dma_ps2;
 
+static stats_t	dma_isa_bytes = STATS_COUNTER("dma.isa_bytes");
+static stats_t	dma_bm_bytes = STATS_COUNTER("dma.busmaster_bytes");
+
 
 #define DMA_PS2_IOA		(1 << 0)
 #define DMA_PS2_XFER_MEM_TO_IO	(1 << 2)
@@ -674,6 +679,9 @@ dma_reset(void)
 {
     int c;
 
+    stats_register(&dma_isa_bytes);
+    stats_register(&dma_bm_bytes);
+
     dma_wp = dma16_wp = 0;
     dma_m = 0;
 
@@ -840,6 +848,7 @@ dma_channel_read(int channel)
     }
 
     dma_stat_rq |= (1 << channel);
+    stats_add(&dma_isa_bytes, dma_c->size + 1);
 
     dma_c->cc--;
     if (dma_c->cc < 0) {
@@ -921,6 +930,7 @@ dma_channel_write(int channel, uint16_t val)
     }
 
     dma_stat_rq |= (1 << channel);
+    stats_add(&dma_isa_bytes, dma_c->size + 1);
 
     dma_c->cc--;
     if (dma_c->cc < 0) {
@@ -953,29 +963,63 @@ dma_mode(int channel)
 void
 DMAPageRead(uint32_t PhysAddress, uint8_t *DataRead, uint32_t TotalSize)
 {
-    uint32_t i = 0;
-
-#if 0
-    memcpy(DataRead, &ram[PhysAddress], TotalSize);
-#else
-    for (i = 0; i < TotalSize; i++)
-	DataRead[i] = mem_readb_phys(PhysAddress + i);
-#endif
+    stats_add(&dma_bm_bytes, TotalSize);
+
+    mem_read_phys_block(PhysAddress, DataRead, TotalSize);
 }
 
 
 void
 DMAPageWrite(uint32_t PhysAddress, const uint8_t *DataWrite, uint32_t TotalSize)
 {
-    uint32_t i = 0;
+    stats_add(&dma_bm_bytes, TotalSize);
+
+    mem_write_phys_block(PhysAddress, DataWrite, TotalSize);
+}
+
+
+void
+dma_state_save(state_t *s)
+{
+    state_begin(s, "dma", 1);
+
+    state_put(s, dma);
+    state_put(s, dmaregs);
+    state_put(s, dma16regs);
+    state_put(s, dmapages);
+    state_put(s, dma_wp);
+    state_put(s, dma16_wp);
+    state_put(s, dma_m);
+    state_put(s, dma_stat);
+    state_put(s, dma_stat_rq);
+    state_put(s, dma_stat_rq_pc);
+    state_put(s, dma_command);
+    state_put(s, dma16_command);
+    state_put(s, dma_ps2);
+
+    state_end(s);
+}
 
-#if 0
-    mem_invalidate_range(PhysAddress, PhysAddress + TotalSize - 1);
-    memcpy(&ram[PhysAddress], DataWrite, TotalSize);
-#else
-    for (i = 0; i < TotalSize; i++)
-	mem_writeb_phys(PhysAddress + i, DataWrite[i]);
 
-    mem_invalidate_range(PhysAddress, PhysAddress + TotalSize - 1);
-#endif
+int
+dma_state_load(state_t *s)
+{
+    if (state_open(s, "dma") != 1)
+	return(0);
+
+    state_get(s, dma);
+    state_get(s, dmaregs);
+    state_get(s, dma16regs);
+    state_get(s, dmapages);
+    state_get(s, dma_wp);
+    state_get(s, dma16_wp);
+    state_get(s, dma_m);
+    state_get(s, dma_stat);
+    state_get(s, dma_stat_rq);
+    state_get(s, dma_stat_rq_pc);
+    state_get(s, dma_command);
+    state_get(s, dma16_command);
+    state_get(s, dma_ps2);
+
+    return(state_end(s));
 }
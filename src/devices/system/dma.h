@@ -8,7 +8,7 @@
  *
  *		Definitions for the Intel DMA controller.
  *
- * Version:	@(#)dma.h	1.0.4	2019/05/17
+ * Version:	@(#)dma.h	1.0.5	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -86,5 +86,10 @@ extern void	dma_alias_set(void);
 extern void	dma_alias_remove(void);
 extern void	dma_alias_remove_piix(void);
 
+#ifdef EMU_STATE_H
+extern void	dma_state_save(state_t *);
+extern int	dma_state_load(state_t *);
+#endif
+
 
 #endif	/*EMU_DMA_H*/
@@ -189,7 +189,7 @@
  *		including the later update (DS12887A) which implemented a
  *		"century" register to be compatible with Y2K.
  *
- * Version:	@(#)nvr_at.c	1.0.25	2021/03/19
+ * Version:	@(#)nvr_at.c	1.0.26	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -226,6 +226,7 @@
 #include <wchar.h>
 #include <time.h>
 #include "../../emu.h"
+#include "../../state.h"
 #include "../../config.h"
 #include "../../timer.h"
 #include "../../cpu/cpu.h"
@@ -941,6 +942,48 @@ nvr_at_init(const device_t *info, UNUSED(void *parent))
 }
 
 
+/* Save the RTC chip state; the NVR core saves the registers. */
+static void
+nvr_at_save(priv_t priv, state_t *s)
+{
+    local_t *dev = (local_t *)priv;
+
+    state_put(s, dev->cent);
+    state_put(s, dev->dflt);
+    state_put(s, dev->read_addr);
+    state_put(s, dev->stat);
+    state_put(s, dev->addr);
+    state_put(s, dev->wp);
+    state_put(s, dev->bank);
+    state_put(s, dev->count);
+    state_put(s, dev->state);
+    state_put(s, dev->ptimer);
+    state_put(s, dev->utimer);
+    state_put(s, dev->ecount);
+}
+
+
+static int
+nvr_at_load(priv_t priv, state_t *s, UNUSED(int version))
+{
+    local_t *dev = (local_t *)priv;
+
+    state_get(s, dev->cent);
+    state_get(s, dev->dflt);
+    state_get(s, dev->read_addr);
+    state_get(s, dev->stat);
+    state_get(s, dev->addr);
+    state_get(s, dev->wp);
+    state_get(s, dev->bank);
+    state_get(s, dev->count);
+    state_get(s, dev->state);
+    state_get(s, dev->ptimer);
+    state_get(s, dev->utimer);
+
+    return(state_get(s, dev->ecount));
+}
+
+
 const device_t at_nvr_old_device = {
     "Old PC/AT NVRAM (no century)",
     DEVICE_ISA | DEVICE_AT,
@@ -950,7 +993,8 @@ const device_t at_nvr_old_device = {
     NULL,
     nvr_at_recalc,
     NULL, NULL,
-    NULL
+    NULL,
+    1, nvr_at_save, nvr_at_load
 };
 
 const device_t at_nvr_device = {
@@ -962,7 +1006,8 @@ const device_t at_nvr_device = {
     NULL,
     nvr_at_recalc,
     NULL, NULL,
-    NULL
+    NULL,
+    1, nvr_at_save, nvr_at_load
 };
 
 const device_t ibmat_nvr_device = {
@@ -974,7 +1019,8 @@ const device_t ibmat_nvr_device = {
     NULL,
     nvr_at_recalc,
     NULL, NULL,
-    NULL
+    NULL,
+    1, nvr_at_save, nvr_at_load
 };
 
 const device_t amstrad_nvr_device = {
@@ -986,7 +1032,8 @@ const device_t amstrad_nvr_device = {
     NULL,
     nvr_at_recalc,
     NULL, NULL,
-    NULL
+    NULL,
+    1, nvr_at_save, nvr_at_load
 };
 
 const device_t ps_nvr_device = {
@@ -998,7 +1045,8 @@ const device_t ps_nvr_device = {
     NULL,
     nvr_at_recalc,
     NULL, NULL,
-    NULL
+    NULL,
+    1, nvr_at_save, nvr_at_load
 };
 
 const device_t piix4_nvr_device = {
@@ -1010,7 +1058,8 @@ const device_t piix4_nvr_device = {
     NULL,
     nvr_at_recalc,
     NULL, NULL,
-    NULL
+    NULL,
+    1, nvr_at_save, nvr_at_load
 };
 
 const device_t ls486e_nvr_device = {
@@ -1022,7 +1071,8 @@ const device_t ls486e_nvr_device = {
     NULL,
     nvr_at_recalc,
     NULL, NULL,
-    NULL
+    NULL,
+    1, nvr_at_save, nvr_at_load
 };
 
 const device_t via_nvr_device = {
@@ -1034,7 +1084,8 @@ const device_t via_nvr_device = {
     NULL,
     nvr_at_recalc,
     NULL, NULL,
-    NULL
+    NULL,
+    1, nvr_at_save, nvr_at_load
 };
 
 
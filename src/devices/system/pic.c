@@ -8,7 +8,7 @@
  *
  *		Implementation of Intel 8259 interrupt controller.
  *
- * Version:	@(#)pic.c	1.0.10	2021/02/17
+ * Version:	@(#)pic.c	1.0.11	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -41,6 +41,7 @@
 #include <string.h>
 #include <wchar.h>
 #include "../../emu.h"
+#include "../../state.h"
 #include "../../timer.h"
 #include "../../io.h"
 #include "../../cpu/cpu.h"
@@ -736,3 +737,40 @@ pic_dump(void)
     if (AT)
 	DEBUG("PIC2 : MASK %02X PEND %02X INS %02X LEVEL %02X VECTOR %02X CASCADE %02X\n", pic2.mask, pic2.pend, pic2.ins, (pic2.icw1 & 8) ? 1 : 0, pic2.vector, pic2.icw3);
 }
+
+
+void
+pic_state_save(state_t *s)
+{
+    state_begin(s, "pic", 1);
+
+    state_put(s, pic);
+    state_put(s, pic2);
+    state_put(s, pic_current);
+    state_put(s, pic_pending);
+    state_put(s, pic_pend);
+    state_put(s, shadow);
+    state_put(s, intclear);
+    state_put(s, keywaiting);
+
+    state_end(s);
+}
+
+
+int
+pic_state_load(state_t *s)
+{
+    if (state_open(s, "pic") != 1)
+	return(0);
+
+    state_get(s, pic);
+    state_get(s, pic2);
+    state_get(s, pic_current);
+    state_get(s, pic_pending);
+    state_get(s, pic_pend);
+    state_get(s, shadow);
+    state_get(s, intclear);
+    state_get(s, keywaiting);
+
+    return(state_end(s));
+}
@@ -8,7 +8,7 @@
  *
  *		Definitions for the Intel 8259 module.
  *
- * Version:	@(#)pic.h	1.0.4	2021/02/17
+ * Version:	@(#)pic.h	1.0.5	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -77,5 +77,10 @@ extern void	pic_dump(void);
 
 extern void	pic_set_shadow(int sh);
 
+#ifdef EMU_STATE_H
+extern void	pic_state_save(state_t *);
+extern int	pic_state_load(state_t *);
+#endif
+
 
 #endif	/*EMU_PIC_H*/
@@ -13,7 +13,7 @@
  *		B4 to 40, two writes to 43, then two reads
  *			- value _does_ change!
  *
- * Version:	@(#)pit.c	1.0.18	2021/03/18
+ * Version:	@(#)pit.c	1.0.19	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -47,6 +47,7 @@
 #include <string.h>
 #include <wchar.h>
 #include "../../emu.h"
+#include "../../state.h"
 #include "../../timer.h"
 #include "../../cpu/cpu.h"
 #include "../../io.h"
@@ -688,3 +689,61 @@ pit_set_out_func(PIT *dev, int t, void (*func)(int new_out, int old_out))
 {
     dev->funcs[t] = func;
 }
+
+
+/* Save or restore one PIT, skipping the host pointers. */
+static void
+pit_state_io(state_t *s, PIT *dev, int load)
+{
+#define PIT_STATE(x)	if (load) state_get(s, x); else state_put(s, x)
+    PIT_STATE(dev->l);
+    PIT_STATE(dev->c);
+    PIT_STATE(dev->m);
+    PIT_STATE(dev->ctrl);
+    PIT_STATE(dev->ctrls);
+    PIT_STATE(dev->wp);
+    PIT_STATE(dev->rm);
+    PIT_STATE(dev->wm);
+    PIT_STATE(dev->rl);
+    PIT_STATE(dev->thit);
+    PIT_STATE(dev->delay);
+    PIT_STATE(dev->rereadlatch);
+    PIT_STATE(dev->gate);
+    PIT_STATE(dev->out);
+    PIT_STATE(dev->running);
+    PIT_STATE(dev->enabled);
+    PIT_STATE(dev->newcount);
+    PIT_STATE(dev->count);
+    PIT_STATE(dev->using_timer);
+    PIT_STATE(dev->initial);
+    PIT_STATE(dev->latched);
+    PIT_STATE(dev->disabled);
+    PIT_STATE(dev->read_status);
+    PIT_STATE(dev->do_read_status);
+#undef PIT_STATE
+}
+
+
+void
+pit_state_save(state_t *s)
+{
+    state_begin(s, "pit", 1);
+
+    pit_state_io(s, &pit, 0);
+    pit_state_io(s, &pit2, 0);
+
+    state_end(s);
+}
+
+
+int
+pit_state_load(state_t *s)
+{
+    if (state_open(s, "pit") != 1)
+	return(0);
+
+    pit_state_io(s, &pit, 1);
+    pit_state_io(s, &pit2, 1);
+
+    return(state_end(s));
+}
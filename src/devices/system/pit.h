@@ -8,7 +8,7 @@
  *
  *		Definitions for Intel 8253 timer module.
  *
- * Version:	@(#)pit.h	1.0.8	2019/05/17
+ * Version:	@(#)pit.h	1.0.9	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -90,5 +90,10 @@ extern void	pit_set_using_timer(PIT *pit, int t, int using_timer);
 extern void	pit_set_out_func(PIT *pit, int t, void (*func)(int new_out, int old_out));
 extern void	pit_clock(PIT *dev, int t);
 
+#ifdef EMU_STATE_H
+extern void	pit_state_save(state_t *);
+extern int	pit_state_load(state_t *);
+#endif
+
 
 #endif	/*EMU_PIT_H*/
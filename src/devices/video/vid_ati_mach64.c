@@ -8,7 +8,7 @@
  *
  *		ATi Mach64 graphics card emulation.
  *
- * Version:	@(#)vid_ati_mach64.c	1.0.22	2020/11/01
+ * Version:	@(#)vid_ati_mach64.c	1.0.23	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -1184,17 +1184,17 @@ void mach64_start_line(mach64_t *mach64)
 #define WRITE(addr, width)      if (width == 0)                                                         \
                                 {                                                                       \
                                         svga->vram[(addr) & mach64->vram_mask] = dest_dat;                             \
-                                        svga->changedvram[((addr) & mach64->vram_mask) >> 12] = changeframecount;      \
+                                        svga_mark_changed(svga, (addr) & mach64->vram_mask);                           \
                                 }                                                                       \
                                 else if (width == 1)                                                    \
                                 {                                                                       \
                                         *(uint16_t *)&svga->vram[((addr) << 1) & mach64->vram_mask] = dest_dat;          \
-                                        svga->changedvram[(((addr) << 1) & mach64->vram_mask) >> 12] = changeframecount; \
+                                        svga_mark_changed(svga, ((addr) << 1) & mach64->vram_mask);                      \
                                 }                                                                       \
                                 else if (width == 2)                                                    \
                                 {                                                                       \
                                         *(uint32_t *)&svga->vram[((addr) << 2) & mach64->vram_mask] = dest_dat;          \
-                                        svga->changedvram[(((addr) << 2) & mach64->vram_mask) >> 12] = changeframecount; \
+                                        svga_mark_changed(svga, ((addr) << 2) & mach64->vram_mask);                      \
                                 }                                                                                               \
                                 else                                                                                            \
                                 {                                                                                               \
@@ -1202,7 +1202,7 @@ void mach64_start_line(mach64_t *mach64)
                                                 svga->vram[((addr) >> 3) & mach64->vram_mask] |= 1 << (((addr) & 7));             \
                                         else                                                                                    \
                                                 svga->vram[((addr) >> 3) & mach64->vram_mask] &= ~(1 << (((addr) & 7)));          \
-                                        svga->changedvram[(((addr) >> 3) & mach64->vram_mask) >> 12] = changeframecount;        \
+                                        svga_mark_changed(svga, ((addr) >> 3) & mach64->vram_mask);                             \
                                 }
 
 void mach64_blit(uint32_t cpu_dat, int count, mach64_t *mach64)
@@ -8,7 +8,7 @@
  *
  *		Emulation of Cirrus Logic cards.
  *
- * Version:	@(#)vid_cl54xx.c	1.0.41	2021/03/19
+ * Version:	@(#)vid_cl54xx.c	1.0.42	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -2093,7 +2093,7 @@ gd54xx_write_modes45(svga_t *svga, uint8_t val, uint32_t addr)
 		break;
     }
 
-    svga->changedvram[addr >> 12] = changeframecount;
+    svga_mark_changed(svga, addr);
 }
 
 
@@ -3366,7 +3366,7 @@ gd54xx_pattern_copy(gd54xx_t *dev)
 				gd54xx_blit(dev, bitmask, dst, target, (x < dev->blt.pattern_x));
 		}
 		pixel = (pixel + 1) & 7;
-		svga->changedvram[((dsta + x) & svga->vram_mask) >> 12] = changeframecount;
+		svga_mark_changed(svga, (dsta + x) & svga->vram_mask);
 	}
 	pattern_y = (pattern_y + 1) & 7;
 	dsta += dev->blt.dst_pitch;
@@ -3439,7 +3439,7 @@ mem_sys_src(gd54xx_t *dev, uint32_t cpu_dat, uint32_t count)
 		if (dev->blt.mode & CIRRUS_BLTMODE_COLOREXPAND)
 			dev->blt.xx_count = (dev->blt.xx_count + 1) % dev->blt.pixel_width;
 
-		svga->changedvram[(dev->blt.dst_addr_backup & svga->vram_mask) >> 12] = changeframecount;
+		svga_mark_changed(svga, dev->blt.dst_addr_backup & svga->vram_mask);
 
 		if (!dev->blt.xx_count) {
 			/* 1 mask bit = 1 blitted pixel */
@@ -3504,7 +3504,7 @@ gd54xx_normal_blit(uint32_t count, gd54xx_t *dev, svga_t *svga)
 	count--;
 
 	dst = svga->vram[dst_addr & svga->vram_mask];
-	svga->changedvram[(dst_addr & svga->vram_mask) >> 12] = changeframecount;
+	svga_mark_changed(svga, dst_addr & svga->vram_mask);
 
 	gd54xx_rop(dev, (uint8_t *) &dst, (uint8_t *) &dst, (const uint8_t *) &src);
 
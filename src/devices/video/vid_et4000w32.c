@@ -12,7 +12,7 @@
  *
  * FIXME:	Note the madness on line 1163, fix that somehow?  --FvK
  *
- * Version:	@(#)vid_et4000w32.c	1.0.25	2020/12/02
+ * Version:	@(#)vid_et4000w32.c	1.0.26	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -618,7 +618,7 @@ static void et4000w32p_mmu_write(uint32_t addr, uint8_t val, priv_t priv)
                         if ((addr&0x1fff) + et4000->mmu.base[bank] < svga->vram_max)
                         {
                                 svga->vram[(addr & 0x1fff) + et4000->mmu.base[bank]] = val;
-                                svga->changedvram[((addr & 0x1fff) + et4000->mmu.base[bank]) >> 12] = changeframecount;
+                                svga_mark_changed(svga, (addr & 0x1fff) + et4000->mmu.base[bank]);
                         }
                 }
                 break;
@@ -915,7 +915,7 @@ static void et4000w32_blit(int count, uint32_t mix, uint32_t sdat, int cpu_input
                         if (!(et4000->acl.internal.ctrl_routing & 0x40))
                         {
                                 svga->vram[et4000->acl.dest_addr & 0x1fffff] = out;
-                                svga->changedvram[(et4000->acl.dest_addr & 0x1fffff) >> 12] = changeframecount;
+                                svga_mark_changed(svga, et4000->acl.dest_addr & 0x1fffff);
                         }
                         else
                         {
@@ -1032,7 +1032,7 @@ static void et4000w32_blit(int count, uint32_t mix, uint32_t sdat, int cpu_input
                         if (!(et4000->acl.internal.ctrl_routing & 0x40))
                         {
                                 svga->vram[et4000->acl.dest_addr & 0x1fffff] = out;
-                                svga->changedvram[(et4000->acl.dest_addr & 0x1fffff) >> 12] = changeframecount;
+                                svga_mark_changed(svga, et4000->acl.dest_addr & 0x1fffff);
                         }
                         else
                         {
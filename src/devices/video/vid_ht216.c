@@ -8,7 +8,7 @@
  *
  *		Video7 VGA 1024i emulation.
  *
- * Version:	@(#)vid_ht216.c	1.0.7	2020/01/20
+ * Version:	@(#)vid_ht216.c	1.0.8	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -280,7 +280,7 @@ dm_write(ht216_t *dev, uint32_t addr, uint8_t cpu_dat, uint8_t cpu_dat_unexpande
     if (addr >= svga->vram_max)
 	return;
 
-    svga->changedvram[addr >> 12] = changeframecount;
+    svga_mark_changed(svga, addr);
 
     switch (dev->ht_regs[0xfe] & HT_REG_FE_FBMC) {
 	case 0x00:
@@ -523,7 +523,7 @@ dm_extalu_write(ht216_t *dev, uint32_t addr, uint8_t cpu_dat, uint8_t bit_mask,
     bg = extalu(dev->ht_regs[0xce] & 0xf,  input_a, input_b);
     output = (fg & rop_select) | (bg & ~rop_select);
     svga->vram[addr] = (svga->vram[addr] & ~bit_mask) | (output & bit_mask);
-    svga->changedvram[addr >> 12] = changeframecount;
+    svga_mark_changed(svga, addr);
 }
 
 
@@ -10,7 +10,7 @@
  *
  * NOTE:	ROM images need more/better organization per chipset.
  *
- * Version:	@(#)vid_s3.c	1.0.24	2021/02/22
+ * Version:	@(#)vid_s3.c	1.0.26	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -213,6 +213,7 @@ typedef struct {
 
     thread_t *fifo_thread;
     event_t *wake_fifo_thread;
+    volatile int fifo_quit;
     event_t *fifo_not_full_event;
 
     int blitter_busy;
@@ -1005,11 +1006,13 @@ static void fifo_thread(void *param)
 {
 	s3_t *s3 = (s3_t *)param;
 	
-	while (1)
+	while (!s3->fifo_quit)
 	{
 		thread_set_event(s3->fifo_not_full_event);
 		thread_wait_event(s3->wake_fifo_thread, -1);
 		thread_reset_event(s3->wake_fifo_thread);
+		if (s3->fifo_quit)
+			break;
 		s3->blitter_busy = 1;
 		while (!FIFO_EMPTY)
 		{
@@ -2289,17 +2292,17 @@ static void polygon_setup(s3_t *s3)
 #define WRITE(addr)     if (s3->bpp == 0)									       \
 			{											       \
 				svga->vram[(addr) & s3->vram_mask] = dest_dat;					  \
-				svga->changedvram[((addr) & s3->vram_mask) >> 12] = changeframecount;		   \
+				svga_mark_changed(svga, (addr) & s3->vram_mask);				  \
 			}											       \
 			else if (s3->bpp == 1)									  \
 			{											       \
 				vram_w[(addr) & (s3->vram_mask >> 1)] = dest_dat;				       \
-				svga->changedvram[((addr) & (s3->vram_mask >> 1)) >> 11] = changeframecount;	    \
+				svga_mark_changed(svga, ((addr) & (s3->vram_mask >> 1)) << 1);			       \
 			}											       \
 			else											    \
 			{											       \
 				vram_l[(addr) & (s3->vram_mask >> 2)] = dest_dat;				       \
-				svga->changedvram[((addr) & (s3->vram_mask >> 2)) >> 10] = changeframecount;	    \
+				svga_mark_changed(svga, ((addr) & (s3->vram_mask >> 2)) << 2);			       \
 			}
 
 int s3_accel_count(s3_t *s3)
@@ -3568,6 +3571,27 @@ static void s3_close(priv_t priv)
 	free(s3);
 }
 
+/* Stop (0) or restart (1) the FIFO thread, when the process forks. */
+static void s3_threads(priv_t priv, int start)
+{
+	s3_t *s3 = (s3_t *)priv;
+
+	if (start)
+	{
+		s3->fifo_quit = 0;
+		s3->fifo_thread = thread_create(fifo_thread, s3);
+	}
+	else
+	{
+		s3_wait_fifo_idle(s3);
+
+		s3->fifo_quit = 1;
+		wake_fifo_thread(s3);
+		thread_wait(s3->fifo_thread, -1);
+		s3->fifo_thread = NULL;
+	}
+}
+
 static void s3_speed_changed(priv_t priv)
 {
 	s3_t *s3 = (s3_t *)priv;
@@ -3708,7 +3732,9 @@ const device_t s3_orchid_86c911_isa_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_orchid_86c911_config
+    s3_orchid_86c911_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_v7mirage_86c801_isa_device = {
@@ -3721,7 +3747,9 @@ const device_t s3_v7mirage_86c801_isa_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_9fx_config
+    s3_9fx_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_onboard_86c801_isa_device = {
@@ -3734,7 +3762,9 @@ const device_t s3_onboard_86c801_isa_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    NULL
+    NULL,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_phoenix_86c805_vlb_device = {
@@ -3747,7 +3777,9 @@ const device_t s3_phoenix_86c805_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_9fx_config
+    s3_9fx_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_onboard_86c805_vlb_device = {
@@ -3760,7 +3792,9 @@ const device_t s3_onboard_86c805_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    NULL
+    NULL,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_metheus_86c928_isa_device = {
@@ -3773,7 +3807,9 @@ const device_t s3_metheus_86c928_isa_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_metheus_86c928_vlb_device = {
@@ -3786,7 +3822,9 @@ const device_t s3_metheus_86c928_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 const device_t s3_bahamas64_vlb_device = {
     "Paradise Bahamas 64 (S3 Vision864)",
@@ -3798,7 +3836,9 @@ const device_t s3_bahamas64_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_bahamas64_pci_device = {
@@ -3811,7 +3851,9 @@ const device_t s3_bahamas64_pci_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_onboard_86c864_vlb_device = {
@@ -3824,7 +3866,9 @@ const device_t s3_onboard_86c864_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_9fx_config
+    s3_9fx_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_diamond_stealth64_964_vlb_device = {
@@ -3837,7 +3881,9 @@ const device_t s3_diamond_stealth64_964_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_diamond_stealth64_964_pci_device = {
@@ -3850,7 +3896,9 @@ const device_t s3_diamond_stealth64_964_pci_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_9fx_vlb_device = {
@@ -3863,7 +3911,9 @@ const device_t s3_9fx_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_9fx_config
+    s3_9fx_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_9fx_pci_device = {
@@ -3876,7 +3926,9 @@ const device_t s3_9fx_pci_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_9fx_config
+    s3_9fx_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_phoenix_trio32_vlb_device = {
@@ -3889,7 +3941,9 @@ const device_t s3_phoenix_trio32_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_phoenix_trio32_config
+    s3_phoenix_trio32_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_phoenix_trio32_pci_device = {
@@ -3902,7 +3956,9 @@ const device_t s3_phoenix_trio32_pci_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_phoenix_trio32_config
+    s3_phoenix_trio32_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_phoenix_trio64_vlb_device = {
@@ -3915,7 +3971,9 @@ const device_t s3_phoenix_trio64_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_phoenix_trio64_pci_device = {
@@ -3928,7 +3986,9 @@ const device_t s3_phoenix_trio64_pci_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_phoenix_trio64_onboard_pci_device = {
@@ -3941,7 +4001,9 @@ const device_t s3_phoenix_trio64_onboard_pci_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_phoenix_trio64_onboard_config
+    s3_phoenix_trio64_onboard_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_phoenix_vision864_vlb_device = {
@@ -3954,7 +4016,9 @@ const device_t s3_phoenix_vision864_vlb_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_phoenix_vision864_pci_device = {
@@ -3967,7 +4031,9 @@ const device_t s3_phoenix_vision864_pci_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_diamond_stealth64_vlb_device = {
@@ -3979,7 +4045,10 @@ const device_t s3_diamond_stealth64_vlb_device = {
     NULL,
     s3_speed_changed,
     s3_force_redraw,
-    s3_config
+    NULL,
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
 
 const device_t s3_diamond_stealth64_pci_device = {
@@ -3992,5 +4061,7 @@ const device_t s3_diamond_stealth64_pci_device = {
     s3_speed_changed,
     s3_force_redraw,
     NULL,
-    s3_config
+    s3_config,
+    0, NULL, NULL,
+    s3_threads
 };
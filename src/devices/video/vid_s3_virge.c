@@ -8,7 +8,7 @@
  *
  *		S3 ViRGE emulation.
  *
- * Version:	@(#)vid_s3_virge.c	1.0.23	2021/03/19
+ * Version:	@(#)vid_s3_virge.c	1.0.24	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -2008,16 +2008,16 @@ static void s3_virge_mmio_write_l(uint32_t addr, uint32_t val, priv_t priv)
                 {                                                                               \
                         case 0: /*8 bpp*/                                                       \
                         vram[addr & svga->vram_mask] = val;                                     \
-                        virge->svga.changedvram[(addr & svga->vram_mask) >> 12] = changeframecount;    \
+                        svga_mark_changed(&virge->svga, addr & svga->vram_mask);                       \
                         break;                                                                  \
                         case 1: /*16 bpp*/                                                      \
                         *(uint16_t *)&vram[addr & svga->vram_mask] = val;                       \
-                        virge->svga.changedvram[(addr & svga->vram_mask) >> 12] = changeframecount;    \
+                        svga_mark_changed(&virge->svga, addr & svga->vram_mask);                       \
                         break;                                                                  \
                         case 2: /*24 bpp*/                                                      \
                         *(uint32_t *)&vram[addr & svga->vram_mask] = (val & 0xffffff) |         \
                                                               (vram[(addr + 3) & svga->vram_mask] << 24);  \
-                        virge->svga.changedvram[(addr & svga->vram_mask) >> 12] = changeframecount;    \
+                        svga_mark_changed(&virge->svga, addr & svga->vram_mask);                       \
                         break;                                                                  \
                 }                                                                               \
         } while (0)
@@ -3184,7 +3184,7 @@ static void tri(virge_t *virge, s3d_t *s3d_tri, s3d_state_t *state, int yc, int3
                                 }
                         }
 
-                        virge->svga.changedvram[(dest_offset & svga->vram_mask) >> 12] = changeframecount;
+                        svga_mark_changed(&virge->svga, dest_offset & svga->vram_mask);
 
                         dest_addr = dest_offset + (x * (bpp + 1));
                         z_addr = z_offset + (x << 1);
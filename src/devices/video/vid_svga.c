@@ -11,7 +11,7 @@
  *		This is intended to be used by another VGA/SVGA driver,
  *		and not as a card in it's own right.
  *
- * Version:	@(#)vid_svga.c	1.0.30	2021/02/11
+ * Version:	@(#)vid_svga.c	1.0.37	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -52,6 +52,9 @@
 #include "../../mem.h"
 #include "../../rom.h"
 #include "../../timer.h"
+#include "../../state.h"
+#include "../../stats.h"
+#include "../../plat.h"
 #include "../system/clk.h"
 #include "video.h"
 #include "vid_svga.h"
@@ -68,6 +71,28 @@ uint8_t		svga_rotate[8][256];
   only SVGA device.*/
 static svga_t	*svga_pri;
 
+/* The render worker, used if lines are rendered on their own thread. */
+struct svga_worker {
+    svga_t	state;			/* copy of the display state */
+    uint8_t	*changed;		/* copy of the dirty pages */
+    int		nchanged;
+
+    svga_line_t	*lines;			/* lines being rendered */
+    int		nlines;
+
+    volatile int busy;
+    event_t	*busy_ev;
+
+    thread_t	*thread;
+    event_t	*wake_ev;
+    volatile int quit;			/* thread should exit */
+};
+
+static stats_t	render_time = STATS_HISTOGRAM("video.render_ticks");
+
+#define STAMP_SWEEP	64		/* frames to age all VRAM stamps */
+#define STAMP_MASK	((1 << SVGA_STAMP_SHIFT) - 1)
+
 
 void svga_doblit(int y1, int y2, int wx, int wy, svga_t *svga);
 
@@ -81,6 +106,8 @@ svga_get_pri(void)
 void
 svga_set_override(svga_t *svga, int val)
 {
+    svga_sync(svga);
+
     if (svga->override && !val)
 	svga->fullchange = changeframecount;
     svga->override = val;
@@ -93,6 +120,9 @@ svga_out(uint16_t addr, uint8_t val, priv_t priv)
     uint8_t indx, o;
     int c;
 
+    /* Lines already displayed still use the old settings. */
+    svga_flush(svga);
+
     switch (addr) {
 	case 0x3ba:
 	case 0x3da:
@@ -430,11 +460,138 @@ svga_set_ramdac_type(svga_t *svga, int type)
 }
 
 
+/*
+ * Save or restore the generic VGA state: the register files, the
+ * DAC, the latches and banking, and the video memory. Cards with
+ * extended registers save those themselves, after this. Timing
+ * values follow from the CRTC and are recalculated on load.
+ */
+static int
+svga_state_io(svga_t *svga, state_t *s, int load)
+{
+#define SVGA_STATE(x)	if (load) state_get(s, x); else state_put(s, x)
+    uint32_t len;
+
+    SVGA_STATE(svga->crtc);
+    SVGA_STATE(svga->gdcreg);
+    SVGA_STATE(svga->attrregs);
+    SVGA_STATE(svga->seqregs);
+    SVGA_STATE(svga->egapal);
+    SVGA_STATE(svga->crtcreg);
+    SVGA_STATE(svga->gdcaddr);
+    SVGA_STATE(svga->attrff);
+    SVGA_STATE(svga->attr_palette_enable);
+    SVGA_STATE(svga->attraddr);
+    SVGA_STATE(svga->seqaddr);
+    SVGA_STATE(svga->miscout);
+    SVGA_STATE(svga->cgastat);
+    SVGA_STATE(svga->scrblank);
+    SVGA_STATE(svga->plane_mask);
+    SVGA_STATE(svga->writemask);
+    SVGA_STATE(svga->colourcompare);
+    SVGA_STATE(svga->colournocare);
+    SVGA_STATE(svga->dac_mask);
+    SVGA_STATE(svga->dac_status);
+    SVGA_STATE(svga->fc);
+
+    SVGA_STATE(svga->dac_addr);
+    SVGA_STATE(svga->dac_pos);
+    SVGA_STATE(svga->dac_r);
+    SVGA_STATE(svga->dac_g);
+    SVGA_STATE(svga->ramdac_type);
+    SVGA_STATE(svga->vgapal);
+    SVGA_STATE(svga->pallook);
+    SVGA_STATE(svga->overscan_color);
+
+    SVGA_STATE(svga->readmode);
+    SVGA_STATE(svga->writemode);
+    SVGA_STATE(svga->readplane);
+    SVGA_STATE(svga->chain4);
+    SVGA_STATE(svga->chain2_write);
+    SVGA_STATE(svga->chain2_read);
+    SVGA_STATE(svga->oddeven_page);
+    SVGA_STATE(svga->oddeven_chain);
+    SVGA_STATE(svga->set_reset_disabled);
+    SVGA_STATE(svga->fast);
+    SVGA_STATE(svga->latch);
+    SVGA_STATE(svga->charseta);
+    SVGA_STATE(svga->charsetb);
+    SVGA_STATE(svga->write_bank);
+    SVGA_STATE(svga->read_bank);
+    SVGA_STATE(svga->extra_banks);
+    SVGA_STATE(svga->banked_mask);
+    SVGA_STATE(svga->ma_latch);
+    SVGA_STATE(svga->hwcursor);
+    SVGA_STATE(svga->dac_hwcursor);
+    SVGA_STATE(svga->overlay);
+
+    /* Everything the card can address, which may be less than it has. */
+    len = svga->vram_mask + 1;
+    SVGA_STATE(len);
+    if (len != (svga->vram_mask + 1)) {
+	ERRLOG("SVGA: state has %lu bytes of VRAM, card has %lu!\n",
+	       (unsigned long)len, (unsigned long)(svga->vram_mask + 1));
+	return(0);
+    }
+    if (load)
+	return(state_read(s, svga->vram, len));
+    state_write(s, svga->vram, len);
+#undef SVGA_STATE
+
+    return(1);
+}
+
+
+void
+svga_state_save(svga_t *svga, state_t *s)
+{
+    /* Let the renderer finish with VRAM first. */
+    svga_sync(svga);
+
+    (void)svga_state_io(svga, s, 0);
+}
+
+
+int
+svga_state_load(svga_t *svga, state_t *s)
+{
+    svga_sync(svga);
+
+    if (! svga_state_io(svga, s, 1))
+	return(0);
+
+    switch (svga->gdcreg[6] & 0x0c) {
+	case 0x00: /*128k at A0000*/
+		mem_map_set_addr(&svga->mapping, 0xa0000, 0x20000);
+		break;
+
+	case 0x04: /*64k at A0000*/
+		mem_map_set_addr(&svga->mapping, 0xa0000, 0x10000);
+		break;
+
+	case 0x08: /*32k at B0000*/
+		mem_map_set_addr(&svga->mapping, 0xb0000, 0x08000);
+		break;
+
+	case 0x0c: /*32k at B8000*/
+		mem_map_set_addr(&svga->mapping, 0xb8000, 0x08000);
+		break;
+    }
+
+    svga_recalctimings(svga);
+    svga->fullchange = changeframecount;
+
+    return(1);
+}
+
+
 void
 svga_recalctimings(svga_t *svga)
 {
     double crtcconst, _dispontime, _dispofftime, disptime;
 
+    svga_flush(svga);
+
     svga->vtotal = svga->crtc[6];
     svga->dispend = svga->crtc[0x12];
     svga->vsyncstart = svga->crtc[0x10];
@@ -589,6 +746,353 @@ svga_recalctimings(svga_t *svga)
 }
 
 
+/*
+ * Start a new frame for the VRAM stamps.
+ *
+ * The stamps are only 8 bits, so one that is left alone for
+ * long enough would look recent again. Every frame, we age a
+ * part of them, so none ever gets older than 128 frames.
+ */
+static void
+stamp_frame(svga_t *svga)
+{
+    int len = (svga->vram_mask + 1) >> SVGA_STAMP_SHIFT;
+    int c, end;
+
+    svga->stamp++;
+
+    c = svga->stamp_sweep;
+    end = MIN(c + (len + STAMP_SWEEP - 1) / STAMP_SWEEP, len);
+    for (; c < end; c++) {
+	if ((uint8_t)(svga->stamp - svga->vram_stamp[c]) >= STAMP_SWEEP)
+		svga->vram_stamp[c] = svga->stamp - STAMP_SWEEP;
+    }
+    svga->stamp_sweep = (end < len) ? end : 0;
+}
+
+
+/*
+ * Has anything in this part of VRAM changed lately?
+ *
+ * Used by the renderers to skip lines that did not change in
+ * the last few frames. We start a few bytes early, to catch
+ * word and dword writes that straddle into the range.
+ */
+int
+svga_changed(svga_t *svga, uint32_t addr, int len)
+{
+    uint32_t a, end;
+
+    if (svga->fullchange) return(1);
+
+    end = addr + len;
+    a = (addr < 3) ? 0 : (addr - 3);
+    for (a &= ~STAMP_MASK; a < end; a += (1 << SVGA_STAMP_SHIFT)) {
+	if ((uint8_t)(svga->stamp - svga->vram_stamp[(a & svga->vram_display_mask) >> SVGA_STAMP_SHIFT]) < changeframecount)
+		return(1);
+    }
+
+    return(0);
+}
+
+
+/* Add a run of drawn lines to the list of changed areas. */
+static void
+rect_add(svga_t *svga, int y, int h)
+{
+    blit_rect_t *r;
+    int c, lo, hi;
+
+    if (svga->nrects > 0) {
+	/* Lines mostly come in order, so try the last run first. */
+	r = &svga->rects[svga->nrects - 1];
+	if ((y <= (r->y + r->h + 1)) && ((y + h + 1) >= r->y)) {
+		hi = MAX(r->y + r->h, y + h);
+		r->y = MIN(r->y, y);
+		r->h = hi - r->y;
+		return;
+	}
+
+	if (svga->nrects == BLIT_RECTS) {
+		/* Too many, just make it one big area. */
+		lo = y;
+		hi = y + h;
+		for (c = 0; c < svga->nrects; c++) {
+			lo = MIN(lo, svga->rects[c].y);
+			hi = MAX(hi, svga->rects[c].y + svga->rects[c].h);
+		}
+		svga->rects[0].y = lo;
+		svga->rects[0].h = hi - lo;
+		svga->nrects = 1;
+		return;
+	}
+    }
+
+    r = &svga->rects[svga->nrects++];
+    r->y = y;
+    r->h = h;
+}
+
+
+/* Render a scanline, and remember it if anything was drawn. */
+static void
+draw_line(svga_t *svga, void (*render)(struct svga_t *))
+{
+    int first = svga->firstline_draw;
+    int last = svga->lastline_draw;
+
+    render(svga);
+
+    if ((svga->firstline_draw != first) || (svga->lastline_draw != last))
+	rect_add(svga, svga->displine, 1);
+}
+
+
+/*
+ * Render a batch of scanlines.
+ *
+ * The renderers work on the live raster state, so we load
+ * each line's copy of it in turn, and put back the current
+ * state when done.
+ */
+static void
+render_lines(svga_t *svga, svga_line_t *lines, int nlines)
+{
+    svga_line_t *l, *end;
+    int displine, sc, con, scrollcache;
+    uint32_t ma;
+
+    displine = svga->displine;
+    sc = svga->sc;
+    con = svga->con;
+    scrollcache = svga->scrollcache;
+    ma = svga->ma;
+
+    end = &lines[nlines];
+    for (l = lines; l < end; l++) {
+	svga->displine = l->displine;
+	svga->sc = l->sc;
+	svga->con = l->con;
+	svga->scrollcache = l->scrollcache;
+	svga->ma = l->ma;
+
+	draw_line(svga, l->render);
+    }
+
+    svga->displine = displine;
+    svga->sc = sc;
+    svga->con = con;
+    svga->scrollcache = scrollcache;
+    svga->ma = ma;
+}
+
+
+static void
+worker_thread(void *param)
+{
+    struct svga_worker *w = (struct svga_worker *)param;
+    uint64_t start;
+
+    while (! w->quit) {
+	thread_wait_event(w->wake_ev, -1);
+	thread_reset_event(w->wake_ev);
+
+	if (w->quit) break;
+
+	start = plat_timer_read();
+
+	render_lines(&w->state, w->lines, w->nlines);
+
+	stats_hist_add(&render_time, plat_timer_read() - start);
+
+	w->busy = 0;
+	thread_set_event(w->busy_ev);
+    }
+}
+
+
+/* Wait for the worker, and pick up the lines it has drawn. */
+static void
+worker_wait(svga_t *svga)
+{
+    struct svga_worker *w = svga->worker;
+    int c;
+
+    while (w->busy)
+	thread_wait_event(w->busy_ev, -1);
+
+    thread_reset_event(w->busy_ev);
+
+    if (w->state.firstline_draw < svga->firstline_draw)
+	svga->firstline_draw = w->state.firstline_draw;
+    if (w->state.lastline_draw > svga->lastline_draw)
+	svga->lastline_draw = w->state.lastline_draw;
+    w->state.firstline_draw = 2000;
+    w->state.lastline_draw = 0;
+
+    for (c = 0; c < w->state.nrects; c++)
+	rect_add(svga, w->state.rects[c].y, w->state.rects[c].h);
+    w->state.nrects = 0;
+}
+
+
+/*
+ * Hand the queued lines to the worker.
+ *
+ * It gets its own copy of the display state, including the
+ * palette and the dirty pages, so we can go on running the
+ * raster (and the guest) while it renders them. Only VRAM
+ * itself is shared.
+ */
+static void
+worker_start(svga_t *svga)
+{
+    struct svga_worker *w = svga->worker;
+    svga_line_t *temp;
+
+    /* It can only do one batch at a time. */
+    worker_wait(svga);
+
+    memcpy(&w->state, svga, sizeof(svga_t));
+    if (svga->map8 == svga->pallook)
+	w->state.map8 = w->state.pallook;
+    memcpy(w->changed, svga->changedvram, w->nchanged);
+    w->state.changedvram = w->changed;
+    w->state.firstline_draw = 2000;
+    w->state.lastline_draw = 0;
+    w->state.nrects = 0;
+
+    /* Swap the line buffers, and start a new batch. */
+    temp = w->lines;
+    w->lines = svga->lines;
+    w->nlines = svga->nlines;
+    svga->lines = temp;
+    svga->nlines = 0;
+
+    w->busy = 1;
+    thread_set_event(w->wake_ev);
+}
+
+
+static void
+worker_init(svga_t *svga, int vramsize)
+{
+    struct svga_worker *w;
+
+    w = (struct svga_worker *)mem_alloc(sizeof(struct svga_worker));
+    memset(w, 0x00, sizeof(struct svga_worker));
+    w->nchanged = vramsize >> 12;
+    w->changed = (uint8_t *)mem_alloc(w->nchanged);
+    w->lines = (svga_line_t *)mem_alloc(SVGA_LINES * sizeof(svga_line_t));
+    w->state.firstline_draw = 2000;
+
+    w->wake_ev = thread_create_event();
+    w->busy_ev = thread_create_event();
+    w->thread = thread_create(worker_thread, w);
+
+    stats_register(&render_time);
+
+    svga->worker = w;
+}
+
+
+static void
+worker_close(svga_t *svga)
+{
+    struct svga_worker *w = svga->worker;
+
+    worker_wait(svga);
+
+    /* Tell the thread to stop, and wait for it to do so. */
+    w->quit = 1;
+    thread_set_event(w->wake_ev);
+    thread_wait(w->thread, -1);
+
+    thread_destroy_event(w->busy_ev);
+    thread_destroy_event(w->wake_ev);
+
+    free(w->lines);
+    free(w->changed);
+    free(w);
+
+    svga->worker = NULL;
+}
+
+
+/*
+ * Stop (0) or restart (1) the render worker of the active card,
+ * if it has one. Used when the process forks, as threads do not
+ * survive that.
+ */
+void
+svga_threads(int start)
+{
+    struct svga_worker *w;
+
+    if ((svga_pri == NULL) || (svga_pri->worker == NULL)) return;
+    w = svga_pri->worker;
+
+    if (start) {
+	w->quit = 0;
+	w->thread = thread_create(worker_thread, w);
+    } else {
+	svga_sync(svga_pri);
+
+	w->quit = 1;
+	thread_set_event(w->wake_ev);
+	thread_wait(w->thread, -1);
+	w->thread = NULL;
+    }
+}
+
+
+/* Render all scanlines queued up so far. */
+void
+svga_flush(svga_t *svga)
+{
+    if (svga->nlines == 0) return;
+
+    if (svga->worker != NULL)
+	worker_start(svga);
+    else
+	render_lines(svga, svga->lines, svga->nlines);
+
+    svga->nlines = 0;
+}
+
+
+/* Make sure all queued lines have been drawn. */
+void
+svga_sync(svga_t *svga)
+{
+    svga_flush(svga);
+
+    if (svga->worker != NULL)
+	worker_wait(svga);
+}
+
+
+/* Queue up the current scanline for rendering. */
+static void
+svga_queue(svga_t *svga)
+{
+    svga_line_t *l;
+
+    /* Keep the worker busy while the raster moves on. */
+    if ((svga->nlines == SVGA_LINES) ||
+	((svga->worker != NULL) && (svga->nlines >= SVGA_CHUNK)))
+	svga_flush(svga);
+
+    l = &svga->lines[svga->nlines++];
+    l->render = svga->render;
+    l->displine = svga->displine;
+    l->sc = svga->sc;
+    l->con = svga->con;
+    l->scrollcache = svga->scrollcache;
+    l->ma = svga->ma;
+}
+
+
 void
 svga_poll(priv_t priv)
 {
@@ -652,10 +1156,20 @@ svga_poll(priv_t priv)
 		if (svga->hwcursor_on || svga->dac_hwcursor_on  || svga->overlay_on) {
 			svga->changedvram[svga->ma >> 12] = svga->changedvram[(svga->ma >> 12) + 1] =
 							    svga->interlace ? 3 : 2;
+			for (x = 0; x < 8192; x += (1 << SVGA_STAMP_SHIFT))
+				svga->vram_stamp[((svga->ma + x) & svga->vram_mask) >> SVGA_STAMP_SHIFT] = svga->stamp;
 		}
 
-		if (!svga->override)
-			svga->render(svga);
+		if (!svga->override) {
+			if (vid_batch && !svga->hwcursor_on &&
+			    !svga->dac_hwcursor_on && !svga->overlay_on) {
+				/* Just remember the line, render it later. */
+				svga_queue(svga);
+			} else {
+				svga_flush(svga);
+				draw_line(svga, svga->render);
+			}
+		}
 
 		if (svga->overlay_on) {
 			if (!svga->override)
@@ -739,6 +1253,9 @@ svga_poll(priv_t priv)
 			svga->scrollcache = 0;
 	}
 	if (svga->vc == svga->dispend) {
+		/* All lines of this frame have been displayed. */
+		svga_flush(svga);
+
 		if (svga->vblank_start)
 			svga->vblank_start(svga);
 		svga->dispon=0;
@@ -755,6 +1272,7 @@ svga_poll(priv_t priv)
 			if (svga->changedvram[x]) 
 				svga->changedvram[x]--;
 		}
+		stamp_frame(svga);
 		if (svga->fullchange) 
 			svga->fullchange--;
 	}
@@ -771,6 +1289,8 @@ svga_poll(priv_t priv)
 		wx = x;
 		wy = svga->lastline - svga->firstline;
 
+		svga_sync(svga);
+
 		if (!svga->override && (wx > 0) && (wy > 0))
 			svga_doblit(svga->firstline_draw, svga->lastline_draw + 1, wx, wy, svga);
 
@@ -779,6 +1299,7 @@ svga_poll(priv_t priv)
 
 		svga->firstline_draw = 2000;
 		svga->lastline_draw = 0;
+		svga->nrects = 0;
 
 		svga->oddeven ^= 1;
 
@@ -873,6 +1394,11 @@ svga_init(svga_t *svga, priv_t priv, int vramsize,
     svga->vram_display_mask = svga->vram_mask = vramsize - 1;
     svga->decode_mask = 0x7fffff;
     svga->changedvram = (uint8_t *)mem_alloc(vramsize >> 12);
+    svga->lines = (svga_line_t *)mem_alloc(SVGA_LINES * sizeof(svga_line_t));
+    svga->vram_stamp = (uint8_t *)mem_alloc(vramsize >> SVGA_STAMP_SHIFT);
+    memset(svga->vram_stamp, 0x00, vramsize >> SVGA_STAMP_SHIFT);
+    if (vid_batch > 1)
+	worker_init(svga, vramsize);
     svga->recalctimings_ex = recalctimings_ex;
     svga->video_in  = video_in;
     svga->video_out = video_out;
@@ -894,6 +1420,9 @@ svga_init(svga_t *svga, priv_t priv, int vramsize,
     svga->ramdac_type = RAMDAC_6BIT;
 
     svga->map8 = svga->pallook;
+
+    svga_pixel_init();
+
     return 0;
 }
 
@@ -901,6 +1430,11 @@ svga_init(svga_t *svga, priv_t priv, int vramsize,
 void
 svga_close(svga_t *svga)
 {
+    if (svga->worker != NULL)
+	worker_close(svga);
+
+    free(svga->lines);
+    free(svga->vram_stamp);
     free(svga->changedvram);
     free(svga->vram);
 
@@ -994,7 +1528,7 @@ svga_write_common(uint32_t addr, uint8_t val, uint8_t linear, priv_t priv)
 
     addr &= svga->vram_mask;
 
-    svga->changedvram[addr >> 12] = changeframecount;
+    svga_mark_changed(svga, addr);
 
     /* standard VGA latched access */
     count =4;
@@ -1250,7 +1784,7 @@ svga_doblit(int y1, int y2, int wx, int wy, svga_t *svga)
 {
     int y_add = (enable_overscan) ? overscan_y : 0;
     int x_add = (enable_overscan) ? 16 : 0;
-    int i, j;
+    int i, j, resized = 0;
 	int xs_temp, ys_temp;
 
     svga->frames++;
@@ -1281,6 +1815,7 @@ svga_doblit(int y1, int y2, int wx, int wy, svga_t *svga)
 	ysize = ys_temp;
 
 	set_screen_size(xsize+x_add,ysize+y_add);
+	resized = 1;
 
 	if (video_force_resize_get())
 		video_force_resize_set(0);
@@ -1309,6 +1844,19 @@ svga_doblit(int y1, int y2, int wx, int wy, svga_t *svga)
 	}
     }
 
+    /*
+     * Tell the blitter which lines we actually drew, unless
+     * all of it has to be redone anyway.
+     */
+    if (!svga->override && !resized && (svga->nrects > 0) &&
+	(!enable_overscan || suppress_overscan)) {
+	for (i = 0; i < svga->nrects; i++) {
+		svga->rects[i].x = 0;
+		svga->rects[i].w = xsize + x_add;
+	}
+	video_blit_rects(svga->rects, svga->nrects);
+    }
+
     video_blit_start(0, 32, 0, y1, y2 + y_add, xsize + x_add, ysize + y_add);
 }
 
@@ -1327,7 +1875,7 @@ svga_writeb_linear(uint32_t addr, uint8_t val, priv_t priv)
     if (addr >= svga->vram_max)
 	return;
     addr &= svga->vram_mask;
-    svga->changedvram[addr >> 12] = changeframecount;
+    svga_mark_changed(svga, addr);
     *(uint8_t *)&svga->vram[addr] = val;
 }
 
@@ -1356,7 +1904,7 @@ svga_writew_common(uint32_t addr, uint16_t val, uint8_t linear, priv_t priv)
     if (addr >= svga->vram_max)
 	return;
     addr &= svga->vram_mask;
-    svga->changedvram[addr >> 12] = changeframecount;
+    svga_mark_changed(svga, addr);
     *(uint16_t *)&svga->vram[addr] = val;
 }
 
@@ -1402,7 +1950,7 @@ svga_writel_common(uint32_t addr, uint32_t val, uint8_t linear, priv_t priv)
 	return;
     addr &= svga->vram_mask;
 
-    svga->changedvram[addr >> 12] = changeframecount;
+    svga_mark_changed(svga, addr);
     *(uint32_t *)&svga->vram[addr] = val;
 }
 
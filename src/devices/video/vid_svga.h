@@ -8,7 +8,7 @@
  *
  *		Definitions for the generic SVGA driver.
  *
- * Version:	@(#)vid_svga.h	1.0.12	2021/02/03
+ * Version:	@(#)vid_svga.h	1.0.17	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -52,6 +52,27 @@ typedef struct {
     uint32_t addr, pitch;
 } hwcursor_t;
 
+/* A scanline waiting to be rendered. */
+struct svga_t;
+typedef struct {
+    void	(*render)(struct svga_t *svga);
+    int		displine, sc, con,
+		scrollcache;
+    uint32_t	ma;
+} svga_line_t;
+
+#define SVGA_LINES	2048		/* max lines per batch */
+#define SVGA_CHUNK	64		/* lines per batch for the worker */
+
+#define SVGA_STAMP_SHIFT 6		/* 64 bytes of VRAM per stamp */
+
+/* Mark the VRAM byte at 'a' as changed. */
+#define svga_mark_changed(svga, a)					\
+	do {								\
+		(svga)->changedvram[(a) >> 12] = changeframecount;	\
+		(svga)->vram_stamp[(a) >> SVGA_STAMP_SHIFT] = (svga)->stamp; \
+	} while (0)
+
 typedef union {
     uint64_t	q;
     uint32_t	d[2];
@@ -145,6 +166,17 @@ typedef struct svga_t
 
     priv_t	ramdac,
 		clock_gen;
+
+    svga_line_t	*lines;			/* batched scanlines */
+    int		nlines;
+    struct svga_worker *worker;		/* render thread, if any */
+
+    uint8_t	*vram_stamp;		/* frame of last write */
+    uint8_t	stamp;			/* current frame */
+    int		stamp_sweep;
+
+    blit_rect_t	rects[BLIT_RECTS];	/* lines drawn this frame */
+    int		nrects;
 } svga_t;
 
 
@@ -155,6 +187,10 @@ extern int	svga_init(svga_t *svga, priv_t, int memsize,
 			  void (*hwcursor_draw)(struct svga_t *svga, int displine),
 			  void (*overlay_draw)(struct svga_t *svga, int displine));
 extern void	svga_recalctimings(svga_t *svga);
+extern void	svga_flush(svga_t *svga);
+extern void	svga_sync(svga_t *svga);
+extern void	svga_threads(int start);
+extern int	svga_changed(svga_t *svga, uint32_t addr, int len);
 extern void	svga_close(svga_t *svga);
 uint8_t		svga_read(uint32_t addr, priv_t);
 uint16_t	svga_readw(uint32_t addr, priv_t);
@@ -182,6 +218,10 @@ extern void	svga_set_override(svga_t *svga, int val);
 extern void	svga_set_ramdac_type(svga_t *svga, int type);
 extern void	svga_close(svga_t *svga);
 
+struct _state_;				/* see state.h */
+extern void	svga_state_save(svga_t *svga, struct _state_ *);
+extern int	svga_state_load(svga_t *svga, struct _state_ *);
+
 extern uint32_t	svga_mask_addr(uint32_t addr, svga_t *svga);
 extern uint32_t	svga_mask_changedaddr(uint32_t addr, svga_t *svga);
 
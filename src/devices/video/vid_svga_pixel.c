@@ -0,0 +1,391 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Scanline pixel format converters for the SVGA renderers.
+ *
+ *		These convert a run of 15, 16, 24 or 32 bpp pixels from
+ *		VRAM into the 32-bit screen format in one go. On x86 hosts,
+ *		SSE2 and AVX2 versions are used if the host CPU has them;
+ *		otherwise, the plain C versions are used.
+ *
+ *		The 15 and 16 bpp versions compute the same values as the
+ *		video_15to32 and video_16to32 tables, which scale each color
+ *		component as (c * 255) / max. The divide is done with a
+ *		multiply by a "magic" reciprocal and a shift, which gives
+ *		exact results for all values of c.
+ *
+ * Version:	@(#)vid_svga_pixel.c	1.0.2	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ *		Redistribution and  use  in source  and binary forms, with
+ *		or  without modification, are permitted  provided that the
+ *		following conditions are met:
+ *
+ *		1. Redistributions of  source  code must retain the entire
+ *		   above notice, this list of conditions and the following
+ *		   disclaimer.
+ *
+ *		2. Redistributions in binary form must reproduce the above
+ *		   copyright  notice,  this list  of  conditions  and  the
+ *		   following disclaimer in  the documentation and/or other
+ *		   materials provided with the distribution.
+ *
+ *		3. Neither the  name of the copyright holder nor the names
+ *		   of  its  contributors may be used to endorse or promote
+ *		   products  derived from  this  software without specific
+ *		   prior written permission.
+ *
+ * THIS SOFTWARE  IS  PROVIDED BY THE  COPYRIGHT  HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND  ANY EXPRESS  OR  IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE  ARE  DISCLAIMED. IN  NO  EVENT  SHALL THE COPYRIGHT
+ * HOLDER OR  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL,  EXEMPLARY,  OR  CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES;  LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON  ANY
+ * THEORY OF  LIABILITY, WHETHER IN  CONTRACT, STRICT  LIABILITY, OR  TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING  IN ANY  WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+#include "../../emu.h"
+#include "../../timer.h"
+#include "../../mem.h"
+#include "video.h"
+#include "vid_svga.h"
+#include "vid_svga_render.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+# define USE_SIMD
+# define TARGET_SSE2	__attribute__((target("sse2")))
+# define TARGET_AVX2	__attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+# define USE_SIMD
+# define TARGET_SSE2	/*nothing*/
+# define TARGET_AVX2	/*nothing*/
+# include <intrin.h>
+#endif
+#ifdef USE_SIMD
+# include <immintrin.h>
+#endif
+
+
+void	(*svga_line_15to32)(pel_t *dst, const uint8_t *src, int n);
+void	(*svga_line_16to32)(pel_t *dst, const uint8_t *src, int n);
+void	(*svga_line_24to32)(pel_t *dst, const uint8_t *src, int n);
+void	(*svga_line_32to32)(pel_t *dst, const uint8_t *src, int n);
+
+
+static void
+line_15to32(pel_t *dst, const uint8_t *src, int n)
+{
+    const uint16_t *s = (const uint16_t *)src;
+    int i;
+
+    for (i = 0; i < n; i++)
+	dst[i].val = video_15to32[s[i]];
+}
+
+
+static void
+line_16to32(pel_t *dst, const uint8_t *src, int n)
+{
+    const uint16_t *s = (const uint16_t *)src;
+    int i;
+
+    for (i = 0; i < n; i++)
+	dst[i].val = video_16to32[s[i]];
+}
+
+
+static void
+line_24to32(pel_t *dst, const uint8_t *src, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++, src += 3)
+	dst[i].val = src[0] | (src[1] << 8) | (src[2] << 16);
+}
+
+
+static void
+line_32to32(pel_t *dst, const uint8_t *src, int n)
+{
+    const uint32_t *s = (const uint32_t *)src;
+    int i;
+
+    for (i = 0; i < n; i++)
+	dst[i].val = s[i] & 0x00ffffff;
+}
+
+
+#ifdef USE_SIMD
+/*
+ * Magic numbers for (c * 255) / 31 and (c * 255) / 63, done
+ * as a high-half multiply of (c * 255) and a shift.
+ */
+#define MUL5	8457
+#define SHR5	2
+#define MUL6	8323
+#define SHR6	3
+
+
+/* Scale 16-bit lanes of 5 or 6 bit values to 8 bits. */
+#define SCALE128(v, m, s)	\
+	_mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(v, k255), m), s)
+#define SCALE256(v, m, s)	\
+	_mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_mullo_epi16(v, k255), m), s)
+
+
+static TARGET_SSE2 void
+line_15to32_sse2(pel_t *dst, const uint8_t *src, int n)
+{
+    const __m128i k255 = _mm_set1_epi16(255);
+    const __m128i m5 = _mm_set1_epi16(MUL5);
+    const __m128i c31 = _mm_set1_epi16(31);
+    __m128i x, r, g, b;
+    int i;
+
+    for (i = 0; (i + 8) <= n; i += 8) {
+	x = _mm_loadu_si128((const __m128i *)&src[i << 1]);
+
+	b = SCALE128(_mm_and_si128(x, c31), m5, SHR5);
+	g = SCALE128(_mm_and_si128(_mm_srli_epi16(x, 5), c31), m5, SHR5);
+	r = SCALE128(_mm_and_si128(_mm_srli_epi16(x, 10), c31), m5, SHR5);
+
+	/* Low half is blue and green, high half is red. */
+	b = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+	_mm_storeu_si128((__m128i *)&dst[i], _mm_unpacklo_epi16(b, r));
+	_mm_storeu_si128((__m128i *)&dst[i + 4], _mm_unpackhi_epi16(b, r));
+    }
+
+    line_15to32(&dst[i], &src[i << 1], n - i);
+}
+
+
+static TARGET_SSE2 void
+line_16to32_sse2(pel_t *dst, const uint8_t *src, int n)
+{
+    const __m128i k255 = _mm_set1_epi16(255);
+    const __m128i m5 = _mm_set1_epi16(MUL5);
+    const __m128i m6 = _mm_set1_epi16(MUL6);
+    const __m128i c31 = _mm_set1_epi16(31);
+    const __m128i c63 = _mm_set1_epi16(63);
+    __m128i x, r, g, b;
+    int i;
+
+    for (i = 0; (i + 8) <= n; i += 8) {
+	x = _mm_loadu_si128((const __m128i *)&src[i << 1]);
+
+	b = SCALE128(_mm_and_si128(x, c31), m5, SHR5);
+	g = SCALE128(_mm_and_si128(_mm_srli_epi16(x, 5), c63), m6, SHR6);
+	r = SCALE128(_mm_srli_epi16(x, 11), m5, SHR5);
+
+	b = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+	_mm_storeu_si128((__m128i *)&dst[i], _mm_unpacklo_epi16(b, r));
+	_mm_storeu_si128((__m128i *)&dst[i + 4], _mm_unpackhi_epi16(b, r));
+    }
+
+    line_16to32(&dst[i], &src[i << 1], n - i);
+}
+
+
+static TARGET_SSE2 void
+line_32to32_sse2(pel_t *dst, const uint8_t *src, int n)
+{
+    const __m128i mask = _mm_set1_epi32(0x00ffffff);
+    __m128i x;
+    int i;
+
+    for (i = 0; (i + 4) <= n; i += 4) {
+	x = _mm_loadu_si128((const __m128i *)&src[i << 2]);
+	_mm_storeu_si128((__m128i *)&dst[i], _mm_and_si128(x, mask));
+    }
+
+    line_32to32(&dst[i], &src[i << 2], n - i);
+}
+
+
+static TARGET_AVX2 void
+line_15to32_avx2(pel_t *dst, const uint8_t *src, int n)
+{
+    const __m256i k255 = _mm256_set1_epi16(255);
+    const __m256i m5 = _mm256_set1_epi16(MUL5);
+    const __m256i c31 = _mm256_set1_epi16(31);
+    __m256i x, r, g, b, lo, hi;
+    int i;
+
+    for (i = 0; (i + 16) <= n; i += 16) {
+	x = _mm256_loadu_si256((const __m256i *)&src[i << 1]);
+
+	b = SCALE256(_mm256_and_si256(x, c31), m5, SHR5);
+	g = SCALE256(_mm256_and_si256(_mm256_srli_epi16(x, 5), c31), m5, SHR5);
+	r = SCALE256(_mm256_and_si256(_mm256_srli_epi16(x, 10), c31), m5, SHR5);
+
+	/* The unpacks work per 128-bit lane, so put them in order. */
+	b = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+	lo = _mm256_unpacklo_epi16(b, r);
+	hi = _mm256_unpackhi_epi16(b, r);
+	_mm256_storeu_si256((__m256i *)&dst[i],
+			    _mm256_permute2x128_si256(lo, hi, 0x20));
+	_mm256_storeu_si256((__m256i *)&dst[i + 8],
+			    _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+
+    line_15to32_sse2(&dst[i], &src[i << 1], n - i);
+}
+
+
+static TARGET_AVX2 void
+line_16to32_avx2(pel_t *dst, const uint8_t *src, int n)
+{
+    const __m256i k255 = _mm256_set1_epi16(255);
+    const __m256i m5 = _mm256_set1_epi16(MUL5);
+    const __m256i m6 = _mm256_set1_epi16(MUL6);
+    const __m256i c31 = _mm256_set1_epi16(31);
+    const __m256i c63 = _mm256_set1_epi16(63);
+    __m256i x, r, g, b, lo, hi;
+    int i;
+
+    for (i = 0; (i + 16) <= n; i += 16) {
+	x = _mm256_loadu_si256((const __m256i *)&src[i << 1]);
+
+	b = SCALE256(_mm256_and_si256(x, c31), m5, SHR5);
+	g = SCALE256(_mm256_and_si256(_mm256_srli_epi16(x, 5), c63), m6, SHR6);
+	r = SCALE256(_mm256_srli_epi16(x, 11), m5, SHR5);
+
+	b = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+	lo = _mm256_unpacklo_epi16(b, r);
+	hi = _mm256_unpackhi_epi16(b, r);
+	_mm256_storeu_si256((__m256i *)&dst[i],
+			    _mm256_permute2x128_si256(lo, hi, 0x20));
+	_mm256_storeu_si256((__m256i *)&dst[i + 8],
+			    _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+
+    line_16to32_sse2(&dst[i], &src[i << 1], n - i);
+}
+
+
+/*
+ * Each 128-bit lane gets four pixels (12 bytes), so we load
+ * 16 bytes per lane. We stop early enough to never read past
+ * the end of the source.
+ */
+static TARGET_AVX2 void
+line_24to32_avx2(pel_t *dst, const uint8_t *src, int n)
+{
+    const __m256i shuf = _mm256_setr_epi8(
+	0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+	0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    __m256i x;
+    int i;
+
+    for (i = 0; (i + 10) <= n; i += 8) {
+	x = _mm256_inserti128_si256(
+		_mm256_castsi128_si256(
+		    _mm_loadu_si128((const __m128i *)&src[i * 3])),
+		_mm_loadu_si128((const __m128i *)&src[i * 3 + 12]), 1);
+	_mm256_storeu_si256((__m256i *)&dst[i], _mm256_shuffle_epi8(x, shuf));
+    }
+
+    line_24to32(&dst[i], &src[i * 3], n - i);
+}
+
+
+static TARGET_AVX2 void
+line_32to32_avx2(pel_t *dst, const uint8_t *src, int n)
+{
+    const __m256i mask = _mm256_set1_epi32(0x00ffffff);
+    __m256i x;
+    int i;
+
+    for (i = 0; (i + 8) <= n; i += 8) {
+	x = _mm256_loadu_si256((const __m256i *)&src[i << 2]);
+	_mm256_storeu_si256((__m256i *)&dst[i], _mm256_and_si256(x, mask));
+    }
+
+    line_32to32_sse2(&dst[i], &src[i << 2], n - i);
+}
+
+
+/* Find out what the host CPU can do. */
+static int
+has_sse2(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+
+    __cpuid(regs, 1);
+    return((regs[3] >> 26) & 1);
+#else
+    __builtin_cpu_init();
+    return(__builtin_cpu_supports("sse2"));
+#endif
+}
+
+
+static int
+has_avx2(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+
+    /* We also need the OS to save the YMM registers. */
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return(0);
+    __cpuid(regs, 1);
+    if (! ((regs[2] >> 27) & 1) || ! ((regs[2] >> 28) & 1)) return(0);
+    if ((_xgetbv(0) & 6) != 6) return(0);
+    __cpuidex(regs, 7, 0);
+    return((regs[1] >> 5) & 1);
+#else
+    __builtin_cpu_init();
+    return(__builtin_cpu_supports("avx2"));
+#endif
+}
+#endif
+
+
+/* Select the best converters for this host. */
+void
+svga_pixel_init(void)
+{
+    const char *str = "C";
+
+    svga_line_15to32 = line_15to32;
+    svga_line_16to32 = line_16to32;
+    svga_line_24to32 = line_24to32;
+    svga_line_32to32 = line_32to32;
+
+#ifdef USE_SIMD
+    if (has_sse2()) {
+	/* There is no byte shuffle in SSE2, so 24 bpp stays in C. */
+	svga_line_15to32 = line_15to32_sse2;
+	svga_line_16to32 = line_16to32_sse2;
+	svga_line_32to32 = line_32to32_sse2;
+	str = "SSE2";
+
+	if (has_avx2()) {
+		svga_line_15to32 = line_15to32_avx2;
+		svga_line_16to32 = line_16to32_avx2;
+		svga_line_24to32 = line_24to32_avx2;
+		svga_line_32to32 = line_32to32_avx2;
+		str = "AVX2";
+	}
+    }
+#endif
+
+    INFO("SVGA: using %s pixel converters\n", str);
+}
@@ -8,7 +8,7 @@
  *
  *		SVGA renderers.
  *
- * Version:	@(#)vid_svga_render.c	1.0.19	2020/11/16
+ * Version:	@(#)vid_svga_render.c	1.0.21	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -514,7 +514,7 @@ svga_render_8bpp_lowres(svga_t *svga)
     uint32_t dat;
     pel_t *p;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, ((svga->hdisp + 8) & ~7) >> 1)) {
 	offset = (8 - (svga->scrollcache & 6)) + 24;
 	p = &screen->line[svga->displine + y_add][offset + x_add];
 
@@ -548,7 +548,7 @@ svga_render_8bpp_highres(svga_t *svga)
     uint32_t dat;
     pel_t *p;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, (svga->hdisp + 8) & ~7)) {
 	offset = (8 - ((svga->scrollcache & 6) >> 1)) + 24;
 	p = &screen->line[svga->displine + y_add][offset + x_add];
 
@@ -724,11 +724,11 @@ svga_render_15bpp_lowres(svga_t *svga)
 {
     int y_add = enable_overscan ? (overscan_y >> 1) : 0;
     int x_add = enable_overscan ? 8 : 0;
-    int offset, x;
+    int offset, x, n;
     uint32_t dat;
     pel_t *p;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, ((svga->hdisp + 4) & ~3) << 1)) {
 	offset = (8 - (svga->scrollcache & 6)) + 24;
 	p = &screen->line[svga->displine + y_add][offset + x_add];
 	
@@ -736,16 +736,23 @@ svga_render_15bpp_lowres(svga_t *svga)
 		svga->firstline_draw = svga->displine;
 	svga->lastline_draw = svga->displine;
  
-	for (x = 0; x <= svga->hdisp; x += 4) {
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
-
-		p[x].val     = video_15to32[dat & 0xffff];
-		p[x + 1].val = video_15to32[dat >> 16];
-
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 4) & svga->vram_display_mask]);
-
-		p[x + 2].val = video_15to32[dat & 0xffff];
-		p[x + 3].val = video_15to32[dat >> 16];
+	/* Convert the whole line at once, unless it wraps in VRAM. */
+	n = (svga->hdisp + 4) & ~3;
+	if ((svga->ma + (n << 1)) <= (svga->vram_display_mask + 1)) {
+		svga_line_15to32(p, &svga->vram[svga->ma], n);
+		x = n;
+	} else {
+		for (x = 0; x <= svga->hdisp; x += 4) {
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
+
+			p[x].val     = video_15to32[dat & 0xffff];
+			p[x + 1].val = video_15to32[dat >> 16];
+
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 4) & svga->vram_display_mask]);
+
+			p[x + 2].val = video_15to32[dat & 0xffff];
+			p[x + 3].val = video_15to32[dat >> 16];
+		}
 	}
 
 	svga->ma += x << 1; 
@@ -759,11 +766,11 @@ svga_render_15bpp_highres(svga_t *svga)
 {
     int y_add = enable_overscan ? (overscan_y >> 1) : 0;
     int x_add = enable_overscan ? 8 : 0;
-    int offset, x;
+    int offset, x, n;
     uint32_t dat;
     pel_t *p;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, ((svga->hdisp + 8) & ~7) << 1)) {
 	offset = (8 - ((svga->scrollcache & 6) >> 1)) + 24;
 	p = &screen->line[svga->displine + y_add][offset + x_add];
 
@@ -771,22 +778,29 @@ svga_render_15bpp_highres(svga_t *svga)
 		svga->firstline_draw = svga->displine;
 	svga->lastline_draw = svga->displine;
 
-	for (x = 0; x <= svga->hdisp; x += 8) {
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
-		p[x].val     = video_15to32[dat & 0xffff];
-		p[x + 1].val = video_15to32[dat >> 16];
-
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 4) & svga->vram_display_mask]);
-		p[x + 2].val = video_15to32[dat & 0xffff];
-		p[x + 3].val = video_15to32[dat >> 16];
-
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 8) & svga->vram_display_mask]);
-		p[x + 4].val = video_15to32[dat & 0xffff];
-		p[x + 5].val = video_15to32[dat >> 16];
-
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 12) & svga->vram_display_mask]);
-		p[x + 6].val = video_15to32[dat & 0xffff];
-		p[x + 7].val = video_15to32[dat >> 16];
+	/* Convert the whole line at once, unless it wraps in VRAM. */
+	n = (svga->hdisp + 8) & ~7;
+	if ((svga->ma + (n << 1)) <= (svga->vram_display_mask + 1)) {
+		svga_line_15to32(p, &svga->vram[svga->ma], n);
+		x = n;
+	} else {
+		for (x = 0; x <= svga->hdisp; x += 8) {
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
+			p[x].val     = video_15to32[dat & 0xffff];
+			p[x + 1].val = video_15to32[dat >> 16];
+
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 4) & svga->vram_display_mask]);
+			p[x + 2].val = video_15to32[dat & 0xffff];
+			p[x + 3].val = video_15to32[dat >> 16];
+
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 8) & svga->vram_display_mask]);
+			p[x + 4].val = video_15to32[dat & 0xffff];
+			p[x + 5].val = video_15to32[dat >> 16];
+
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 12) & svga->vram_display_mask]);
+			p[x + 6].val = video_15to32[dat & 0xffff];
+			p[x + 7].val = video_15to32[dat >> 16];
+		}
 	}
 
 	svga->ma += x << 1; 
@@ -905,11 +919,11 @@ svga_render_16bpp_lowres(svga_t *svga)
 {
     int y_add = enable_overscan ? (overscan_y >> 1) : 0;
     int x_add = enable_overscan ? 8 : 0;
-    int offset, x;
+    int offset, x, n;
     uint32_t dat;
     pel_t *p;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, ((svga->hdisp + 4) & ~3) << 1)) {
 	offset = (8 - (svga->scrollcache & 6)) + 24;
 	p = &screen->line[svga->displine + y_add][offset + x_add];
 
@@ -917,16 +931,23 @@ svga_render_16bpp_lowres(svga_t *svga)
 		svga->firstline_draw = svga->displine;
 	svga->lastline_draw = svga->displine;
 
-	for (x = 0; x <= svga->hdisp; x += 4) {
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
+	/* Convert the whole line at once, unless it wraps in VRAM. */
+	n = (svga->hdisp + 4) & ~3;
+	if ((svga->ma + (n << 1)) <= (svga->vram_display_mask + 1)) {
+		svga_line_16to32(p, &svga->vram[svga->ma], n);
+		x = n;
+	} else {
+		for (x = 0; x <= svga->hdisp; x += 4) {
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
 
-		p[x].val     = video_16to32[dat & 0xffff];
-		p[x + 1].val = video_16to32[dat >> 16];
+			p[x].val     = video_16to32[dat & 0xffff];
+			p[x + 1].val = video_16to32[dat >> 16];
 
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 4) & svga->vram_display_mask]);
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 4) & svga->vram_display_mask]);
 
-		p[x + 2].val = video_16to32[dat & 0xffff];
-		p[x + 3].val = video_16to32[dat >> 16];
+			p[x + 2].val = video_16to32[dat & 0xffff];
+			p[x + 3].val = video_16to32[dat >> 16];
+		}
 	}
 
 	svga->ma += x << 1; 
@@ -940,11 +961,11 @@ svga_render_16bpp_highres(svga_t *svga)
 {
     int y_add = enable_overscan ? (overscan_y >> 1) : 0;
     int x_add = enable_overscan ? 8 : 0;
-    int offset, x;
+    int offset, x, n;
     uint32_t dat;
     pel_t *p;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, ((svga->hdisp + 8) & ~7) << 1)) {
 	offset = (8 - ((svga->scrollcache & 6) >> 1)) + 24;
 	p = &screen->line[svga->displine + y_add][offset + x_add];
 
@@ -952,22 +973,29 @@ svga_render_16bpp_highres(svga_t *svga)
 		svga->firstline_draw = svga->displine;
 	svga->lastline_draw = svga->displine;
 
-	for (x = 0; x <= svga->hdisp; x += 8) {
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
-		p[x].val     = video_16to32[dat & 0xffff];
-		p[x + 1].val = video_16to32[dat >> 16];
-
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 4) & svga->vram_display_mask]);
-		p[x + 2].val = video_16to32[dat & 0xffff];
-		p[x + 3].val = video_16to32[dat >> 16];
-
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 8) & svga->vram_display_mask]);
-		p[x + 4].val = video_16to32[dat & 0xffff];
-		p[x + 5].val = video_16to32[dat >> 16];
-
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 12) & svga->vram_display_mask]);
-		p[x + 6].val = video_16to32[dat & 0xffff];
-		p[x + 7].val = video_16to32[dat >> 16];
+	/* Convert the whole line at once, unless it wraps in VRAM. */
+	n = (svga->hdisp + 8) & ~7;
+	if ((svga->ma + (n << 1)) <= (svga->vram_display_mask + 1)) {
+		svga_line_16to32(p, &svga->vram[svga->ma], n);
+		x = n;
+	} else {
+		for (x = 0; x <= svga->hdisp; x += 8) {
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
+			p[x].val     = video_16to32[dat & 0xffff];
+			p[x + 1].val = video_16to32[dat >> 16];
+
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 4) & svga->vram_display_mask]);
+			p[x + 2].val = video_16to32[dat & 0xffff];
+			p[x + 3].val = video_16to32[dat >> 16];
+
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 8) & svga->vram_display_mask]);
+			p[x + 4].val = video_16to32[dat & 0xffff];
+			p[x + 5].val = video_16to32[dat >> 16];
+
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 1) + 12) & svga->vram_display_mask]);
+			p[x + 6].val = video_16to32[dat & 0xffff];
+			p[x + 7].val = video_16to32[dat >> 16];
+		}
 	}
 
 	svga->ma += x << 1; 
@@ -984,7 +1012,7 @@ svga_render_24bpp_lowres(svga_t *svga)
     int offset, x;
     uint32_t dat;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, (svga->hdisp + 1) * 3)) {
 	if (svga->firstline_draw == 2000) 
 		svga->firstline_draw = svga->displine;
 	svga->lastline_draw = svga->displine;
@@ -1007,11 +1035,11 @@ svga_render_24bpp_highres(svga_t *svga)
 {
     int y_add = enable_overscan ? (overscan_y >> 1) : 0;
     int x_add = enable_overscan ? 8 : 0;
-    int offset, x;
+    int offset, x, n;
     uint32_t dat;
     pel_t *p;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, ((svga->hdisp + 4) & ~3) * 3)) {
 	offset = (8 - ((svga->scrollcache & 6) >> 1)) + 24;
 	p = &screen->line[svga->displine + y_add][offset + x_add];
 
@@ -1019,20 +1047,27 @@ svga_render_24bpp_highres(svga_t *svga)
 		svga->firstline_draw = svga->displine;
 	svga->lastline_draw = svga->displine;
 
-	for (x = 0; x <= svga->hdisp; x += 4) {
-		dat = *(uint32_t *)(&svga->vram[svga->ma & svga->vram_display_mask]);
-		p[x].val = dat & 0xffffff;
+	/* Convert the whole line at once, unless it wraps in VRAM. */
+	n = (svga->hdisp + 4) & ~3;
+	if ((svga->ma + (n * 3)) <= (svga->vram_display_mask + 1)) {
+		svga_line_24to32(p, &svga->vram[svga->ma], n);
+		svga->ma += n * 3;
+	} else {
+		for (x = 0; x <= svga->hdisp; x += 4) {
+			dat = *(uint32_t *)(&svga->vram[svga->ma & svga->vram_display_mask]);
+			p[x].val = dat & 0xffffff;
 
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + 3) & svga->vram_display_mask]);
-		p[x + 1].val = dat & 0xffffff;
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + 3) & svga->vram_display_mask]);
+			p[x + 1].val = dat & 0xffffff;
 
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + 6) & svga->vram_display_mask]);
-		p[x + 2].val = dat & 0xffffff;
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + 6) & svga->vram_display_mask]);
+			p[x + 2].val = dat & 0xffffff;
 
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + 9) & svga->vram_display_mask]);
-		p[x + 3].val = dat & 0xffffff;
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + 9) & svga->vram_display_mask]);
+			p[x + 3].val = dat & 0xffffff;
 
-		svga->ma += 12;
+			svga->ma += 12;
+		}
 	}
 
 	svga->ma &= svga->vram_display_mask;
@@ -1048,7 +1083,7 @@ svga_render_32bpp_lowres(svga_t *svga)
     int x, offset;
     uint32_t fg;
 
-    if (svga->changedvram[svga->ma >> 12] || svga->changedvram[(svga->ma >> 12) + 1] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, (svga->hdisp + 1) << 2)) {
 	if (svga->firstline_draw == 2000) 
 		svga->firstline_draw = svga->displine;
 	svga->lastline_draw = svga->displine;
@@ -1073,11 +1108,11 @@ svga_render_32bpp_highres(svga_t *svga)
 {
     int y_add = enable_overscan ? (overscan_y >> 1) : 0;
     int x_add = enable_overscan ? 8 : 0;
-    int offset, x;
+    int offset, x, n;
     uint32_t dat;
     pel_t *p;
 
-    if (svga->changedvram[svga->ma >> 12] ||  svga->changedvram[(svga->ma >> 12) + 1] || svga->changedvram[(svga->ma >> 12) + 2] || svga->fullchange) {
+    if (svga_changed(svga, svga->ma, (svga->hdisp + 1) << 2)) {
 	offset = (8 - ((svga->scrollcache & 6) >> 1)) + 24;
 	p = &screen->line[svga->displine + y_add][offset + x_add];
 
@@ -1085,9 +1120,15 @@ svga_render_32bpp_highres(svga_t *svga)
 		svga->firstline_draw = svga->displine;
 	svga->lastline_draw = svga->displine;
 
-	for (x = 0; x <= svga->hdisp; x++) {
-		dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 2)) & svga->vram_display_mask]);
-		p[x].val = dat & 0xffffff;
+	/* Convert the whole line at once, unless it wraps in VRAM. */
+	n = svga->hdisp + 1;
+	if ((svga->ma + (n << 2)) <= (svga->vram_display_mask + 1)) {
+		svga_line_32to32(p, &svga->vram[svga->ma], n);
+	} else {
+		for (x = 0; x <= svga->hdisp; x++) {
+			dat = *(uint32_t *)(&svga->vram[(svga->ma + (x << 2)) & svga->vram_display_mask]);
+			p[x].val = dat & 0xffffff;
+		}
 	}
 
 	svga->ma += 4; 
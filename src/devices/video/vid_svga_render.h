@@ -8,7 +8,7 @@
  *
  *		Definitions for the SVGA renderers.
  *
- * Version:	@(#)vid_svga_render.h	1.0.4	2020/11/16
+ * Version:	@(#)vid_svga_render.h	1.0.5	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -48,6 +48,14 @@ extern int	con, cursoron, cgablink;
 extern int	scrollcache;
 extern uint8_t	edatlookup[4][4];
 
+/* Scanline pixel format converters. */
+extern void	(*svga_line_15to32)(pel_t *dst, const uint8_t *src, int n);
+extern void	(*svga_line_16to32)(pel_t *dst, const uint8_t *src, int n);
+extern void	(*svga_line_24to32)(pel_t *dst, const uint8_t *src, int n);
+extern void	(*svga_line_32to32)(pel_t *dst, const uint8_t *src, int n);
+
+extern void	svga_pixel_init(void);
+
 
 extern void svga_render_null(svga_t *svga);
 extern void	svga_render_blank(svga_t *svga);
@@ -47,7 +47,7 @@
  *		access size or host data has any affect, but the Windows 3.1
  *		driver always reads bytes and write words of 0xffff.
  *
- * Version:	@(#)vid_tgui9440.c	1.0.18	2021/03/12
+ * Version:	@(#)vid_tgui9440.c	1.0.19	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -817,7 +817,7 @@ static void tgui_ext_linear_write(uint32_t addr, uint8_t val, priv_t priv)
                 return;
         addr &= svga->vram_mask;
         addr &= ~0x7;
-        svga->changedvram[addr >> 12] = changeframecount;
+        svga_mark_changed(svga, addr);
         
         switch (dev->ext_gdc_regs[0] & 0xf) {
                 /*8-bit mono->colour expansion, unmasked*/
@@ -881,7 +881,7 @@ static void tgui_ext_linear_writew(uint32_t addr, uint16_t val, priv_t priv)
                 return;
         addr &= svga->vram_mask;
         addr &= ~0xf;
-        svga->changedvram[addr >> 12] = changeframecount;
+        svga_mark_changed(svga, addr);
         
         val = (val >> 8) | (val << 8);
 
@@ -996,12 +996,12 @@ enum
 #define WRITE(addr, dat)        if (dev->accel.bpp == 0)                                                \
                                 {                                                                       \
                                         svga->vram[addr & 0x1fffff] = dat;                                    \
-                                        svga->changedvram[((addr) & 0x1fffff) >> 12] = changeframecount;      \
+                                        svga_mark_changed(svga, (addr) & 0x1fffff);                           \
                                 }                                                                       \
                                 else                                                                    \
                                 {                                                                       \
                                         vram_w[addr & 0xfffff] = dat;                                   \
-                                        svga->changedvram[((addr) & 0xfffff) >> 11] = changeframecount;        \
+                                        svga_mark_changed(svga, ((addr) & 0xfffff) << 1);                      \
                                 }
                                 
 void tgui_accel_command(int count, uint32_t cpu_dat, tgui_t *dev)
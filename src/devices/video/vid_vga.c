@@ -8,7 +8,7 @@
  *
  *		IBM VGA emulation.
  *
- * Version:	@(#)vid_vga.c	1.0.12	2019/05/17
+ * Version:	@(#)vid_vga.c	1.0.13	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -43,6 +43,7 @@
 #include <wchar.h>
 #include "../../emu.h"
 #include "../../timer.h"
+#include "../../state.h"
 #include "../../io.h"
 #include "../../mem.h"
 #include "../../rom.h"
@@ -183,6 +184,24 @@ vga_enable(priv_t priv)
 }
 #endif
 
+static void
+vga_save(priv_t priv, state_t *s)
+{
+    vga_t *dev = (vga_t *)priv;
+
+    svga_state_save(&dev->svga, s);
+}
+
+
+static int
+vga_load(priv_t priv, state_t *s, UNUSED(int version))
+{
+    vga_t *dev = (vga_t *)priv;
+
+    return(svga_state_load(&dev->svga, s));
+}
+
+
 static priv_t
 vga_init(const device_t *info, UNUSED(void *parent))
 {
@@ -221,7 +240,8 @@ const device_t vga_device = {
     speed_changed,
     force_redraw,
     &vga_timing,
-    NULL
+    NULL,
+    1, vga_save, vga_load
 };
 
 
@@ -237,7 +257,8 @@ const device_t vga_ps1_device = {
     speed_changed,
     force_redraw,
     &ps1vga_timing,
-    NULL
+    NULL,
+    1, vga_save, vga_load
 };
 
 const device_t vga_ps1_mca_device = {
@@ -250,5 +271,6 @@ const device_t vga_ps1_mca_device = {
     speed_changed,
     force_redraw,
     &ps1vga_timing,
-    NULL
+    NULL,
+    1, vga_save, vga_load
 };
@@ -8,7 +8,7 @@
  *
  *		Main video-rendering module.
  *
- * Version:	@(#)video.c	1.0.34	2021/03/16
+ * Version:	@(#)video.c	1.0.38	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -54,6 +54,7 @@
 #include "../../rom.h"
 #include "../../device.h"
 #include "../../timer.h"
+#include "../../stats.h"
 #include "../../plat.h"
 #include "video.h"
 #include "vid_mda.h"
@@ -397,24 +398,41 @@ static struct blitter {
 
     thread_t	*thread;
     event_t	*wake_ev;
+    volatile int quit;			/* thread should exit */
+
+    blit_rect_t	rects[BLIT_RECTS];	/* changed areas, if known */
+    int		nrects;
+    blit_rect_t	next[BLIT_RECTS];	/* same, for the next blit */
+    int		nnext;
 
     void	(*func)(bitmap_t *,int x, int y, int y1, int y2, int w, int h);
 }		blitter;
 
+static stats_t	blit_count = STATS_COUNTER("video.blits");
+static stats_t	blit_time = STATS_HISTOGRAM("video.blit_ticks");
+
 
 static void
 blit_thread(void *param)
 {
     struct blitter *blit = (struct blitter *)param;
+    uint64_t start;
 
-    for (;;) {
+    while (! blit->quit) {
 	thread_wait_event(blit->wake_ev, -1);
 	thread_reset_event(blit->wake_ev);
 
-	if (blit->func != NULL)
+	if (blit->quit) break;
+
+	if (blit->func != NULL) {
+		start = plat_timer_read();
+
 		blit->func(screen, blit->x, blit->y,
 			   blit->y1, blit->y2, blit->w, blit->h);
 
+		stats_hist_add(&blit_time, plat_timer_read() - start);
+	}
+
 	blit->busy = 0;
 	thread_set_event(blit->busy_ev);
     }
@@ -449,6 +467,48 @@ video_blit_wait_buffer(void)
 }
 
 
+/*
+ * Tell the blitter which areas changed, for the next blit.
+ *
+ * Without this, everything between y1 and y2 is assumed
+ * to have changed. Only the SVGA core calls this, with the
+ * lines its renderers drew. The linear 8/15/16/24/32 bpp
+ * renderers check VRAM per 64 bytes; the text, CGA (2bpp),
+ * planar (4bpp) and 8bpp grayscale ones still check it per
+ * 4KB page, so in those modes more lines are listed than
+ * really changed.
+ *
+ * The DirectDraw, Direct3D and VNC blits copy just these
+ * areas. SDL still copies all of y1..y2: it locks the whole
+ * streaming texture, whose old contents SDL does not promise
+ * to keep.
+ */
+void
+video_blit_rects(const blit_rect_t *rects, int num)
+{
+    if (num > BLIT_RECTS)
+	num = 0;
+
+    memcpy(blitter.next, rects, num * sizeof(blit_rect_t));
+    blitter.nnext = num;
+}
+
+
+/*
+ * Get the changed areas of the current blit.
+ *
+ * Called by the renderers from their blit function. If this
+ * returns zero, the whole y1..y2 area should be updated.
+ */
+int
+video_blit_get_rects(const blit_rect_t **rects)
+{
+    *rects = blitter.rects;
+
+    return(blitter.nrects);
+}
+
+
 void
 video_blit_wait(void)
 {
@@ -530,8 +590,10 @@ video_blit_start(int pal, int x, int y, int y1, int y2, int w, int h)
     int yy, xx;
     pel_t *p;
 
-    if (h <= 0)
+    if (h <= 0) {
+	blitter.nnext = 0;
 	return;
+    }
 
     if (pal) {
 	/* In palette mode, first convert the values. */
@@ -552,6 +614,13 @@ video_blit_start(int pal, int x, int y, int y1, int y2, int w, int h)
     blitter.busy = 1;
     blitter.inuse = 1;
 
+    stats_inc(&blit_count);
+
+    /* Hand over the changed areas, if we have them. */
+    memcpy(blitter.rects, blitter.next, blitter.nnext * sizeof(blit_rect_t));
+    blitter.nrects = blitter.nnext;
+    blitter.nnext = 0;
+
     blitter.x = x;
     blitter.y = y;
     blitter.y1 = y1;
@@ -814,6 +883,34 @@ video_init(void)
     blitter.busy_ev = thread_create_event();
     blitter.inuse_ev = thread_create_event();
     blitter.thread = thread_create(blit_thread, &blitter);
+
+    stats_register(&blit_count);
+    stats_register(&blit_time);
+}
+
+
+/*
+ * Stop (0) or restart (1) the blitter and render threads. Used
+ * when the process forks, as threads do not survive that. When
+ * stopping, all pending drawing and blitting is finished first.
+ */
+void
+video_threads(int start)
+{
+    if (start) {
+	blitter.quit = 0;
+	blitter.thread = thread_create(blit_thread, &blitter);
+
+	svga_threads(1);
+    } else {
+	svga_threads(0);
+
+	video_blit_wait();
+	blitter.quit = 1;
+	thread_set_event(blitter.wake_ev);
+	thread_wait(blitter.thread, -1);
+	blitter.thread = NULL;
+    }
 }
 
 
@@ -8,7 +8,7 @@
  *
  *		Definitions for the video controller module.
  *
- * Version:	@(#)video.h	1.0.41	2021/03/16
+ * Version:	@(#)video.h	1.0.43	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -110,6 +110,12 @@ typedef struct {
 
 typedef rgb_t PALETTE[256];
 
+typedef struct {
+    int		x, y, w, h;		// area of the screen buffer
+} blit_rect_t;
+
+#define BLIT_RECTS	32		// max changed areas per blit
+
 typedef struct {
     uint8_t	chr[32];
 } dbcs_font_t;
@@ -364,12 +370,15 @@ extern void		video_blit_wait(void);
 extern void		video_blit_wait_buffer(void);
 extern void		video_blit_start(int pal, int x, int y,
 					 int y1, int y2, int w, int h);
+extern void		video_blit_rects(const blit_rect_t *rects, int num);
+extern int		video_blit_get_rects(const blit_rect_t **rects);
 extern void		video_blend(int x, int y);
 extern void		video_palette_rebuild(void);
 
 extern void		video_log(int level, const char *fmt, ...);
 extern void		video_init(void);
 extern void		video_close(void);
+extern void		video_threads(int start);
 extern void		video_reset(void);
 extern void		video_inform(int type, const video_timings_t *ptr);
 extern int		video_type(void);
@@ -8,7 +8,7 @@
  *
  *		Main include file for the application.
  *
- * Version:	@(#)emu.h	1.0.38	2021/03/18
+ * Version:	@(#)emu.h	1.0.53	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *
@@ -149,6 +149,9 @@
 #ifndef MIN
 # define MIN(a, b)	((a) < (b) ? (a) : (b))
 #endif
+#ifndef MAX
+# define MAX(a, b)	((a) > (b) ? (a) : (b))
+#endif
 #ifndef ABS
 # define ABS(x)		((x) > 0 ? (x) : -(x))
 #endif
@@ -175,8 +178,21 @@ extern int	video_fps;			// (O) render speed in fps
 extern int	config_ro;			// (O) dont modify cfg file
 extern int	config_keep_space;		// (O) keep spaces in cfg
 extern int	settings_only;			// (O) only the settings dlg
+extern int	max_speed;			// (O) do not sync to host clock
+extern int	clone_count;			// (O) number of clones to run
+extern int	clone_workers;			// (O) clones running at once
+extern int	clone_test;			// (O) frames per clone in test
+extern int	idle_skip;			// (O) skip idle guest time
+extern int	vid_batch;			// (O) 1=per frame, 2=threaded
 extern int	log_level;			// (O) global logging level
 extern wchar_t	log_path[1024];			// (O) full path of logfile
+extern wchar_t	state_path[1024];		// (O) machine state file
+extern wchar_t	journal_path[1024];		// (O) input journal file
+extern int	journal_replay;			// (O) replay the journal
+extern wchar_t	stats_path[1024];		// (O) statistics file
+extern wchar_t	profile_path[1024];		// (O) guest profile file
+extern wchar_t	bench_name[32];			// (O) benchmark to run
+extern wchar_t	bench_base[1024];		// (O) benchmark baseline
 
 /* Global variables. */
 extern char	emu_title[64];			// full name of application
@@ -194,6 +210,7 @@ extern int	config_changed,			// config has changed
 		dopause,			// system is paused
 		doresize,			// screen resize requested
 		mouse_capture;			// mouse is captured in app
+extern int	clone_id;			// clone number, 0 = original
 extern int	AT,				// machine is AT class
 		MCA,				// machine has MCA bus
 		PCI;				// machine has PCI bus
@@ -246,6 +263,11 @@ extern void		pc_reset_hard_close(void);
 extern void		pc_reset_hard_init(void);
 extern void		pc_reset_hard(void);
 extern void		pc_reset(int hard);
+extern int		pc_save_state(const wchar_t *fn);
+extern int		pc_load_state(const wchar_t *fn);
+extern int		pc_fork_stop(void);
+extern void		pc_fork_start(int clone);
+extern int		pc_clone(int id);
 extern void		pc_reload(const wchar_t *fn);
 extern void		pc_set_speed(int);
 extern void		pc_thread(void *param);
@@ -8,7 +8,7 @@
  *
  *		Implement I/O ports and their operations.
  *
- * Version:	@(#)io.c	1.0.6	2019/05/17
+ * Version:	@(#)io.c	1.0.10	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -42,6 +42,7 @@
 #include <stdlib.h>
 #include <wchar.h>
 #include "emu.h"
+#include "stats.h"
 #include "io.h"
 #include "cpu/cpu.h"
 
@@ -59,15 +60,74 @@ typedef struct _io_ {
     uint32_t	(*inl)(uint16_t, priv_t);
     void	(*outl)(uint16_t, uint32_t, priv_t);
 
+    int		(*inw_block)(uint16_t, uint16_t *, int, priv_t);
+    int		(*outw_block)(uint16_t, const uint16_t *, int, priv_t);
+
     priv_t	priv;
 
     struct _io_ *prev, *next;
 } io_t;
 
+/*
+ * Flat dispatch entry for a port, rebuilt from the handler chain
+ * whenever the chain changes. For the byte accessors, we keep the
+ * number of handlers (0, 1 or "many") and, if there is only one,
+ * the handler itself, so the common case needs no chain walk. For
+ * the word and dword accessors, only the first handler counts, so
+ * we just remember that one.
+ */
+typedef struct {
+    io_t	*inb,
+		*outb,
+		*inw,
+		*outw,
+		*inl,
+		*outl;
+
+    uint8_t	ninb,
+		noutb;
+} io_fast_t;
+
 
 static io_t	**io = NULL,
 		**io_last = NULL;
-  
+static io_fast_t *io_fast = NULL;
+static uint32_t	io_hits[NPORTS];		/* accesses per port */
+static stats_t	io_stats = STATS_TABLE("io.port", io_hits, NPORTS);
+
+
+/* Rebuild the flat dispatch entry for a port. */
+static void
+io_rebuild(int c)
+{
+    io_fast_t *f = &io_fast[c];
+    io_t *p;
+
+    memset(f, 0x00, sizeof(io_fast_t));
+
+    for (p = io[c]; p != NULL; p = p->next) {
+	if (p->inb != NULL) {
+		f->inb = p;
+		if (f->ninb < 2)
+			f->ninb++;
+	}
+	if (p->outb != NULL) {
+		f->outb = p;
+		if (f->noutb < 2)
+			f->noutb++;
+	}
+
+	if ((p->inw != NULL) && (f->inw == NULL))
+		f->inw = p;
+	if ((p->outw != NULL) && (f->outw == NULL))
+		f->outw = p;
+	if ((p->inl != NULL) && (f->inl == NULL))
+		f->inl = p;
+	if ((p->outl != NULL) && (f->outl == NULL))
+		f->outl = p;
+    }
+}
+
 
 /* Add an I/O handler to the chain. */
 static void
@@ -84,6 +144,8 @@ io_insert(int c, io_t *q)
 	q->prev = NULL;
     }
     io_last[c] = q;
+
+    io_rebuild(c);
 }
 
 
@@ -104,6 +166,8 @@ io_unlink(int c)
 	io_last[c] = p->prev;
 
     free(p);
+
+    io_rebuild(c);
 }
 
 
@@ -194,6 +258,9 @@ io_reset(void)
 	memset(io, 0x00, c);
 	io_last = (io_t **)mem_alloc(c);
 	memset(io_last, 0x00, c);
+
+	c = sizeof(io_fast_t) * NPORTS;
+	io_fast = (io_fast_t *)mem_alloc(c);
     }
 
     /* Clear both arrays. */
@@ -210,12 +277,15 @@ io_reset(void)
 
 	/* Reset handler. */
 	io[c] = io_last[c] = NULL;
+	memset(&io_fast[c], 0x00, sizeof(io_fast_t));
 
 #ifdef IO_CATCH
 	/* Add a default (catch) handler. */
 	catch_add(c);
 #endif
     }
+
+    stats_register(&io_stats);
 }
 
 
@@ -284,6 +354,33 @@ io_removehandler(uint16_t base, int size,
 }
 
 
+/*
+ * Attach block (string) handlers to a port range that already has
+ * its normal handlers registered with the same private data. These
+ * are used by REP INSW/OUTSW to move a run of words in one call;
+ * they go away along with the normal handlers when those are
+ * removed.
+ */
+void
+io_sethandler_block(uint16_t base, int size,
+	int (*f_inw_block)(uint16_t addr, uint16_t *buf, int count, priv_t priv),
+	int (*f_outw_block)(uint16_t addr, const uint16_t *buf, int count, priv_t priv),
+	priv_t priv)
+{
+    io_t *p;
+    int c;
+
+    for (c = 0; c < size; c++) {
+	for (p = io[base + c]; p != NULL; p = p->next) {
+		if (p->priv == priv) {
+			p->inw_block = f_inw_block;
+			p->outw_block = f_outw_block;
+		}
+	}
+    }
+}
+
+
 #ifdef PC98
 void
 io_sethandler_interleaved(uint16_t base, int size,
@@ -316,6 +413,8 @@ io_sethandler_interleaved(uint16_t base, int size,
 	q->outb = f_outb; q->outw = f_outw; q->outl = f_outl;
 
 	q->priv = priv;
+
+	io_rebuild(base + c);
     }
 }
 
@@ -352,6 +451,8 @@ io_removehandler_interleaved(uint16_t base, int size,
 		}
 		p = p->next;
 	}
+
+	io_rebuild(base + c);
     }
 }
 #endif
@@ -360,16 +461,27 @@ io_removehandler_interleaved(uint16_t base, int size,
 uint8_t
 inb(uint16_t port)
 {
+    io_fast_t *f = &io_fast[port];
     uint8_t r = 0xff;
     io_t *p;
 
-    p = io[port];
-    while(p != NULL) {
-	if (p->inb != NULL)
-		r &= p->inb(port, p->priv);
-	p = p->next;
+    io_hits[port]++;
+
+    if (f->ninb == 1) {
+	/* Only one handler, call it directly. */
+	r = f->inb->inb(port, f->inb->priv);
+    } else if (f->ninb > 1) {
+	/* Shared port, all handlers get to respond. */
+	for (p = io[port]; p != NULL; p = p->next) {
+		if (p->inb != NULL)
+			r &= p->inb(port, p->priv);
+	}
     }
 
+    /* Is the guest just waiting for something? */
+    if (idle_skip)
+	cpu_idle_poll(port);
+
 #ifdef IO_TRACE
     if (CS == IO_TRACE)
 	DEBUG("IOTRACE(%04x): inb(%04x)=%02x\n", IO_TRACE, port, r);
@@ -382,14 +494,19 @@ inb(uint16_t port)
 void
 outb(uint16_t port, uint8_t val)
 {
+    io_fast_t *f = &io_fast[port];
     io_t *p;
 
-    if (io[port] != NULL) {
-	p = io[port];
-	while (p != NULL) {
+    io_hits[port]++;
+
+    if (f->noutb == 1) {
+	/* Only one handler, call it directly. */
+	f->outb->outb(port, val, f->outb->priv);
+    } else if (f->noutb > 1) {
+	/* Shared port, all handlers see the write. */
+	for (p = io[port]; p != NULL; p = p->next) {
 		if (p->outb != NULL)
 			p->outb(port, val, p->priv);
-		p = p->next;
 	}
     }
 
@@ -403,13 +520,11 @@ outb(uint16_t port, uint8_t val)
 uint16_t
 inw(uint16_t port)
 {
-    io_t *p;
+    io_t *p = io_fast[port].inw;
 
-    p = io[port];
-    while(p != NULL) {
-	if (p->inw != NULL)
-		return(p->inw(port, p->priv));
-	p = p->next;
+    if (p != NULL) {
+	io_hits[port]++;
+	return(p->inw(port, p->priv));
     }
 
     return(inb(port) | (inb(port + 1) << 8));
@@ -419,32 +534,58 @@ inw(uint16_t port)
 void
 outw(uint16_t port, uint16_t val)
 {
-    io_t *p;
+    io_t *p = io_fast[port].outw;
 
-    p = io[port];
-    while(p != NULL) {
-	if (p->outw != NULL) {
-		p->outw(port, val, p->priv);
-		return;
-	}
-	p = p->next;
+    if (p != NULL) {
+	io_hits[port]++;
+	p->outw(port, val, p->priv);
+	return;
     }
 
-    outb(port,val & 0xff);
-    outb(port+1,val>>8);
+    outb(port, val & 0xff);
+    outb(port + 1, val >> 8);
+}
+
+
+/*
+ * Read up to 'count' words from a port into 'buf', if the handler
+ * for that port supports block transfers. Returns the number of
+ * words actually transferred, or 0 if the caller has to do it the
+ * slow way.
+ */
+int
+inw_block(uint16_t port, uint16_t *buf, int count)
+{
+    io_t *p = io_fast[port].inw;
+
+    if ((p == NULL) || (p->inw_block == NULL))
+	return(0);
+
+    return(p->inw_block(port, buf, count, p->priv));
+}
+
+
+/* Same, but for writing words to a port. */
+int
+outw_block(uint16_t port, const uint16_t *buf, int count)
+{
+    io_t *p = io_fast[port].outw;
+
+    if ((p == NULL) || (p->outw_block == NULL))
+	return(0);
+
+    return(p->outw_block(port, buf, count, p->priv));
 }
 
 
 uint32_t
 inl(uint16_t port)
 {
-    io_t *p;
+    io_t *p = io_fast[port].inl;
 
-    p = io[port];
-    while(p != NULL) {
-	if (p->inl != NULL)
-		return(p->inl(port, p->priv));
-	p = p->next;
+    if (p != NULL) {
+	io_hits[port]++;
+	return(p->inl(port, p->priv));
     }
 
     return(inw(port) | (inw(port + 2) << 16));
@@ -454,15 +595,12 @@ inl(uint16_t port)
 void
 outl(uint16_t port, uint32_t val)
 {
-    io_t *p;
+    io_t *p = io_fast[port].outl;
 
-    p = io[port];
-    while(p != NULL) {
-	if (p->outl != NULL) {
-		p->outl(port, val, p->priv);
-		return;
-	}
-	p = p->next;
+    if (p != NULL) {
+	io_hits[port]++;
+	p->outl(port, val, p->priv);
+	return;
     }
 
     outw(port, val);
@@ -8,7 +8,7 @@
  *
  *		Definitions for the I/O handler.
  *
- * Version:	@(#)io.h	1.0.3	2019/05/13
+ * Version:	@(#)io.h	1.0.4	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -60,6 +60,13 @@ extern void	io_removehandler(uint16_t base, int size,
 			void (*outl)(uint16_t addr, uint32_t val, priv_t),
 			priv_t);
 
+extern void	io_sethandler_block(uint16_t base, int size,
+			int (*inw_block)(uint16_t addr, uint16_t *buf,
+					 int count, priv_t),
+			int (*outw_block)(uint16_t addr, const uint16_t *buf,
+					  int count, priv_t),
+			priv_t);
+
 #ifdef PC98
 extern void	io_sethandler_interleaved(uint16_t base, int size,
 			uint8_t (*inb)(uint16_t addr, priv_t),
@@ -84,6 +91,8 @@ extern uint8_t	inb(uint16_t port);
 extern void	outb(uint16_t port, uint8_t  val);
 extern uint16_t	inw(uint16_t port);
 extern void	outw(uint16_t port, uint16_t val);
+extern int	inw_block(uint16_t port, uint16_t *buf, int count);
+extern int	outw_block(uint16_t port, const uint16_t *buf, int count);
 extern uint32_t	inl(uint16_t port);
 extern void	outl(uint16_t port, uint32_t val);
 
@@ -0,0 +1,494 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Input journal, for deterministic record and replay.
+ *
+ *		The machine itself runs on emulated time only, so any
+ *		difference between two runs comes from the outside: the
+ *		host clock, random seeds, and the keyboard, mouse and
+ *		network input, which arrive on other threads at random
+ *		moments. In journal mode, all of these are stamped with
+ *		the emulated frame number and written to the journal,
+ *		and input is only handed to the machine at the start of
+ *		a frame. When replaying, live input is ignored, and the
+ *		journal is fed back in at exactly the same frames.
+ *
+ *		Every JOURNAL_CHECK frames a record with the CPU state
+ *		is added, so a replay that diverges is detected early.
+ *
+ * Version:	@(#)journal.c	1.0.2	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ *		Redistribution and  use  in source  and binary forms, with
+ *		or  without modification, are permitted  provided that the
+ *		following conditions are met:
+ *
+ *		1. Redistributions of  source  code must retain the entire
+ *		   above notice, this list of conditions and the following
+ *		   disclaimer.
+ *
+ *		2. Redistributions in binary form must reproduce the above
+ *		   copyright  notice,  this list  of  conditions  and  the
+ *		   following disclaimer in  the documentation and/or other
+ *		   materials provided with the distribution.
+ *
+ *		3. Neither the  name of the copyright holder nor the names
+ *		   of  its  contributors may be used to endorse or promote
+ *		   products  derived from  this  software without specific
+ *		   prior written permission.
+ *
+ * THIS SOFTWARE  IS  PROVIDED BY THE  COPYRIGHT  HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND  ANY EXPRESS  OR  IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE  ARE  DISCLAIMED. IN  NO  EVENT  SHALL THE COPYRIGHT
+ * HOLDER OR  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL,  EXEMPLARY,  OR  CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES;  LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON  ANY
+ * THEORY OF  LIABILITY, WHETHER IN  CONTRACT, STRICT  LIABILITY, OR  TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING  IN ANY  WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include "emu.h"
+#include "journal.h"
+#include "cpu/cpu.h"
+#include "machines/machine.h"
+#include "device.h"
+#include "devices/input/keyboard.h"
+#include "devices/network/network.h"
+#include "plat.h"
+
+
+/* Header of a journal record. */
+typedef struct {
+    uint32_t	frame;				/* emulated frame number */
+    uint16_t	type;				/* record type */
+    uint16_t	len;				/* length of data */
+} jnl_hdr_t;
+
+/* An input event, queued until the next frame. */
+typedef struct _jnl_event_ {
+    struct _jnl_event_ *next;
+
+    jnl_hdr_t	hdr;
+    uint8_t	data[1];			/* actually longer */
+} jnl_event_t;
+
+/* Data of a CPU state check record. */
+typedef struct {
+    uint32_t	pc;
+    uint32_t	cs_base;
+    uint64_t	tsc;
+} jnl_check_t;
+
+
+int		journal_mode = JOURNAL_OFF;
+
+
+static const char journal_magic[16] = "VARCem JOURNAL\032";
+
+static FILE	*jnl_fp;
+static mutex_t	*jnl_mutex;
+static uint32_t	jnl_frame;			/* current emulated frame */
+static jnl_hdr_t jnl_next;			/* next record in replay */
+static int	jnl_applying;			/* feeding input to machine */
+static int	jnl_buttons;			/* last mouse buttons */
+static jnl_event_t *jnl_head,			/* queued input events */
+		*jnl_tail;
+
+
+/* Stop journaling, and let live input through again. */
+static void
+jnl_stop(const char *why)
+{
+    if (why != NULL)
+	ERRLOG("JOURNAL: %s at frame %lu, replay stopped!\n",
+	       why, (unsigned long)jnl_frame);
+
+    if (jnl_fp != NULL) {
+	(void)fclose(jnl_fp);
+	jnl_fp = NULL;
+    }
+
+    journal_mode = JOURNAL_OFF;
+}
+
+
+static void
+jnl_write(uint32_t frame, int type, const void *data, int len)
+{
+    jnl_hdr_t hdr;
+
+    hdr.frame = frame;
+    hdr.type = (uint16_t)type;
+    hdr.len = (uint16_t)len;
+
+    if ((fwrite(&hdr, sizeof(hdr), 1, jnl_fp) != 1) ||
+	((len > 0) && (fwrite(data, len, 1, jnl_fp) != 1))) {
+	ERRLOG("JOURNAL: write error, recording stopped!\n");
+	jnl_stop(NULL);
+    }
+}
+
+
+/* Read the header of the next record in the journal. */
+static void
+jnl_read_next(void)
+{
+    if (fread(&jnl_next, sizeof(jnl_next), 1, jnl_fp) != 1) {
+	jnl_next.type = JNL_END;
+	jnl_next.len = 0;
+    }
+
+    if (jnl_next.type == JNL_END) {
+	INFO("JOURNAL: end of journal at frame %lu\n",
+	     (unsigned long)jnl_frame);
+	jnl_stop(NULL);
+    }
+}
+
+
+/* Read the data of the current record, and move on to the next one. */
+static int
+jnl_read(void *data, int len)
+{
+    if (jnl_next.len != len) {
+	jnl_stop("record size mismatch");
+	return(0);
+    }
+
+    if ((len > 0) && (fread(data, len, 1, jnl_fp) != 1)) {
+	jnl_stop("unexpected end of journal");
+	return(0);
+    }
+
+    jnl_read_next();
+
+    return(1);
+}
+
+
+/* Queue an input event for the next frame. */
+static void
+jnl_queue(int type, const void *data, int len)
+{
+    jnl_event_t *ev;
+
+    ev = (jnl_event_t *)mem_alloc(sizeof(jnl_event_t) + len);
+    ev->next = NULL;
+    ev->hdr.type = (uint16_t)type;
+    ev->hdr.len = (uint16_t)len;
+    memcpy(ev->data, data, len);
+
+    thread_wait_mutex(jnl_mutex);
+    if (jnl_tail != NULL)
+	jnl_tail->next = ev;
+      else
+	jnl_head = ev;
+    jnl_tail = ev;
+    thread_release_mutex(jnl_mutex);
+}
+
+
+/* Hand an input event to the machine. */
+static void
+jnl_apply(int type, uint8_t *data, int len)
+{
+    uint16_t scan;
+
+    jnl_applying = 1;
+
+    switch (type) {
+	case JNL_KEY:
+		memcpy(&scan, &data[1], sizeof(scan));
+		keyboard_input(data[0], scan);
+		break;
+
+	case JNL_NET:
+		network_rx(data, len);
+		break;
+    }
+
+    jnl_applying = 0;
+}
+
+
+static void
+jnl_check(jnl_check_t *chk)
+{
+    memset(chk, 0x00, sizeof(jnl_check_t));
+    chk->pc = cpu_state.pc;
+    chk->cs_base = cs;
+    chk->tsc = tsc;
+}
+
+
+/* Open a journal for recording or replaying. */
+int
+journal_open(const wchar_t *fn, int replay)
+{
+    char name[32], temp[32];
+    char magic[16];
+    uint32_t ver;
+
+    memset(name, 0x00, sizeof(name));
+    strncpy(name, machine_get_internal_name(), sizeof(name) - 1);
+
+    jnl_fp = plat_fopen(fn, replay ? L"rb" : L"wb");
+    if (jnl_fp == NULL) {
+	ERRLOG("JOURNAL: unable to open '%ls'\n", fn);
+	return(0);
+    }
+
+    if (replay) {
+	if ((fread(magic, sizeof(magic), 1, jnl_fp) != 1) ||
+	    (fread(&ver, sizeof(ver), 1, jnl_fp) != 1) ||
+	    (fread(temp, sizeof(temp), 1, jnl_fp) != 1) ||
+	    memcmp(magic, journal_magic, sizeof(magic)) ||
+	    (ver != JOURNAL_VERSION)) {
+		ERRLOG("JOURNAL: '%ls' is not a valid journal!\n", fn);
+		(void)fclose(jnl_fp);
+		jnl_fp = NULL;
+		return(0);
+	}
+
+	temp[sizeof(temp) - 1] = '\0';
+	if (strcmp(temp, name)) {
+		ERRLOG("JOURNAL: recorded on machine '%s', not '%s'!\n",
+		       temp, name);
+		(void)fclose(jnl_fp);
+		jnl_fp = NULL;
+		return(0);
+	}
+    } else {
+	ver = JOURNAL_VERSION;
+	(void)fwrite(journal_magic, sizeof(journal_magic), 1, jnl_fp);
+	(void)fwrite(&ver, sizeof(ver), 1, jnl_fp);
+	(void)fwrite(name, sizeof(name), 1, jnl_fp);
+    }
+
+    jnl_mutex = thread_create_mutex(L"VARCem.Journal");
+
+    jnl_frame = 0;
+    jnl_buttons = 0;
+    jnl_head = jnl_tail = NULL;
+    journal_mode = (replay) ? JOURNAL_REPLAY : JOURNAL_RECORD;
+
+    if (replay)
+	jnl_read_next();
+
+    INFO("JOURNAL: %s '%ls'\n", replay ? "replaying" : "recording", fn);
+
+    return(1);
+}
+
+
+void
+journal_close(void)
+{
+    jnl_event_t *ev;
+
+    if (journal_mode == JOURNAL_RECORD)
+	jnl_write(jnl_frame, JNL_END, NULL, 0);
+
+    if (jnl_fp != NULL)
+	jnl_stop(NULL);
+
+    while (jnl_head != NULL) {
+	ev = jnl_head;
+	jnl_head = ev->next;
+	free(ev);
+    }
+    jnl_tail = NULL;
+
+    if (jnl_mutex != NULL) {
+	thread_close_mutex(jnl_mutex);
+	jnl_mutex = NULL;
+    }
+}
+
+
+/*
+ * Start a new frame.
+ *
+ * Called by the emulator thread before it runs a frame. This is
+ * the only place where queued (or replayed) input is handed to
+ * the machine.
+ */
+void
+journal_frame(void)
+{
+    jnl_check_t chk, rchk;
+    jnl_event_t *ev;
+    uint8_t buff[2048];
+
+    if (journal_mode == JOURNAL_OFF) return;
+
+    jnl_frame++;
+
+    if (journal_mode == JOURNAL_RECORD) {
+	if ((jnl_frame % JOURNAL_CHECK) == 0) {
+		jnl_check(&chk);
+		jnl_write(jnl_frame, JNL_CHECK, &chk, sizeof(chk));
+	}
+
+	/* Grab all input queued since the last frame. */
+	thread_wait_mutex(jnl_mutex);
+	ev = jnl_head;
+	jnl_head = jnl_tail = NULL;
+	thread_release_mutex(jnl_mutex);
+
+	while (ev != NULL) {
+		if (journal_mode == JOURNAL_RECORD)
+			jnl_write(jnl_frame, ev->hdr.type, ev->data, ev->hdr.len);
+		jnl_apply(ev->hdr.type, ev->data, ev->hdr.len);
+
+		jnl_head = ev->next;
+		free(ev);
+		ev = jnl_head;
+	}
+
+	return;
+    }
+
+    /* Replay all input recorded for this frame. */
+    while ((journal_mode == JOURNAL_REPLAY) && (jnl_next.frame <= jnl_frame)) {
+	if (jnl_next.frame < jnl_frame) {
+		jnl_stop("missed a record");
+		break;
+	}
+
+	switch (jnl_next.type) {
+		case JNL_CHECK:
+			jnl_check(&chk);
+			if (! jnl_read(&rchk, sizeof(rchk))) break;
+			if (memcmp(&chk, &rchk, sizeof(chk)))
+				jnl_stop("machine state diverged");
+			break;
+
+		case JNL_KEY:
+		case JNL_NET:
+			if ((jnl_next.len > sizeof(buff)) ||
+			    !jnl_read(buff, jnl_next.len)) {
+				jnl_stop("bad input record");
+				break;
+			}
+			jnl_apply(jnl_next.type, buff, jnl_next.len);
+			break;
+
+		default:
+			/* Belongs to a later point in this frame. */
+			return;
+	}
+    }
+}
+
+
+/*
+ * Synchronize a value read from the host.
+ *
+ * When recording, the value is written to the journal. When
+ * replaying, the recorded value replaces it.
+ */
+void
+journal_sync(int type, void *data, int len)
+{
+    switch (journal_mode) {
+	case JOURNAL_RECORD:
+		jnl_write(jnl_frame, type, data, len);
+		break;
+
+	case JOURNAL_REPLAY:
+		if ((jnl_next.type != type) || (jnl_next.frame != jnl_frame)) {
+			jnl_stop("host value out of sequence");
+			break;
+		}
+		(void)jnl_read(data, len);
+		break;
+    }
+}
+
+
+/* Keyboard event from the UI, returns 1 if we took it. */
+int
+journal_key(int down, uint16_t scan)
+{
+    uint8_t data[3];
+
+    if ((journal_mode == JOURNAL_OFF) || jnl_applying) return(0);
+
+    /* Live input is ignored while replaying. */
+    if (journal_mode == JOURNAL_REPLAY) return(1);
+
+    data[0] = (uint8_t)down;
+    memcpy(&data[1], &scan, sizeof(scan));
+    jnl_queue(JNL_KEY, data, sizeof(data));
+
+    return(1);
+}
+
+
+/*
+ * Record or replay the mouse state.
+ *
+ * The mouse is polled by the emulator thread, so we can just
+ * journal whatever it is going to report to the machine.
+ */
+void
+journal_mouse(int *x, int *y, int *z, int *b)
+{
+    int32_t data[4];
+
+    switch (journal_mode) {
+	case JOURNAL_RECORD:
+		if (!*x && !*y && !*z && (*b == jnl_buttons)) break;
+
+		data[0] = *x;
+		data[1] = *y;
+		data[2] = *z;
+		data[3] = *b;
+		jnl_write(jnl_frame, JNL_MOUSE, data, sizeof(data));
+		jnl_buttons = *b;
+		break;
+
+	case JOURNAL_REPLAY:
+		if ((jnl_next.type == JNL_MOUSE) &&
+		    (jnl_next.frame == jnl_frame)) {
+			if (! jnl_read(data, sizeof(data))) break;
+			jnl_buttons = data[3];
+			*x = data[0];
+			*y = data[1];
+			*z = data[2];
+		} else
+			*x = *y = *z = 0;
+		*b = jnl_buttons;
+		break;
+    }
+}
+
+
+/* Packet received from the network, returns 1 if we took it. */
+int
+journal_net(uint8_t *bufp, int len)
+{
+    if ((journal_mode == JOURNAL_OFF) || jnl_applying) return(0);
+
+    if (journal_mode == JOURNAL_REPLAY) return(1);
+
+    jnl_queue(JNL_NET, bufp, len);
+
+    return(1);
+}
@@ -0,0 +1,95 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Definitions for the input journal (record/replay) module.
+ *
+ * Version:	@(#)journal.h	1.0.2	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ *		Redistribution and  use  in source  and binary forms, with
+ *		or  without modification, are permitted  provided that the
+ *		following conditions are met:
+ *
+ *		1. Redistributions of  source  code must retain the entire
+ *		   above notice, this list of conditions and the following
+ *		   disclaimer.
+ *
+ *		2. Redistributions in binary form must reproduce the above
+ *		   copyright  notice,  this list  of  conditions  and  the
+ *		   following disclaimer in  the documentation and/or other
+ *		   materials provided with the distribution.
+ *
+ *		3. Neither the  name of the copyright holder nor the names
+ *		   of  its  contributors may be used to endorse or promote
+ *		   products  derived from  this  software without specific
+ *		   prior written permission.
+ *
+ * THIS SOFTWARE  IS  PROVIDED BY THE  COPYRIGHT  HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND  ANY EXPRESS  OR  IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE  ARE  DISCLAIMED. IN  NO  EVENT  SHALL THE COPYRIGHT
+ * HOLDER OR  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL,  EXEMPLARY,  OR  CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES;  LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON  ANY
+ * THEORY OF  LIABILITY, WHETHER IN  CONTRACT, STRICT  LIABILITY, OR  TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING  IN ANY  WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef EMU_JOURNAL_H
+# define EMU_JOURNAL_H
+
+
+#define JOURNAL_VERSION	1			/* file format version */
+#define JOURNAL_CHECK	100			/* frames between checks */
+
+
+/* Journal modes. */
+enum {
+    JOURNAL_OFF = 0,
+    JOURNAL_RECORD,
+    JOURNAL_REPLAY
+};
+
+/* Journal record types. */
+enum {
+    JNL_END = 0,				/* end of journal */
+    JNL_CHECK,					/* CPU state check */
+    JNL_TIME,					/* host time of day */
+    JNL_SEED,					/* random number seed */
+    JNL_NVR,					/* NVR contents */
+    JNL_KEY,					/* keyboard event */
+    JNL_MOUSE,					/* mouse movement */
+    JNL_NET					/* received network packet */
+};
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int	journal_mode;			// current journal mode
+
+extern int	journal_open(const wchar_t *fn, int replay);
+extern void	journal_close(void);
+extern void	journal_frame(void);
+extern void	journal_sync(int type, void *data, int len);
+
+extern int	journal_key(int down, uint16_t scan);
+extern void	journal_mouse(int *x, int *y, int *z, int *b);
+extern int	journal_net(uint8_t *bufp, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif	/*EMU_JOURNAL_H*/
@@ -8,7 +8,7 @@
  *
  *		Standard PC/AT implementation.
  *
- * Version:	@(#)m_at.c	1.0.17	2021/03/09
+ * Version:	@(#)m_at.c	1.0.18	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -162,7 +162,8 @@ const device_t m_at = {
     at_init, NULL, NULL,
     NULL, NULL, NULL,
     &at_info,
-    NULL
+    NULL,
+    1, device_nostate_save, device_nostate_load
 };
 
 
@@ -186,7 +187,8 @@ const device_t m_xt286 = {
     at_init, NULL, NULL,
     NULL, NULL, NULL,
     &xt286_info,
-    NULL
+    NULL,
+    1, device_nostate_save, device_nostate_load
 };
 
 
@@ -206,7 +208,8 @@ const device_t m_dtk_ptm1000 = {
     at_init, NULL, NULL,
     NULL, NULL, NULL,
     &dtk286_info,
-    NULL
+    NULL,
+    1, device_nostate_save, device_nostate_load
 };
 
 
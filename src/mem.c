@@ -10,7 +10,7 @@
  *
  * **NOTES**	The cpu-specific MMU code should be moved to cpu/mmu.c.
  *
- * Version:	@(#)mem.c	1.0.41	2021/03/16
+ * Version:	@(#)mem.c	1.0.44	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include <wchar.h>
 #include "emu.h"
+#include "state.h"
 #include "cpu/cpu.h"
 #include "cpu/x86_ops.h"
 #include "cpu/x86.h"
@@ -113,6 +114,50 @@ static int		_mem_state[0x40000];
 static uint8_t		ff_pccache[4] = { 0xff, 0xff, 0xff, 0xff };
 
 
+/*
+ * Software TLB.
+ *
+ * The readlookup2/writelookup2 arrays only hold host pointers for
+ * RAM pages, and only for the last 256 pages touched. Everything
+ * else (MMIO, ROM, pages that have been pushed out) has to go back
+ * through mmutranslatereal(), which walks the page tables every
+ * time. This caches the result of that walk, set-associative and
+ * keyed on the linear page number, so those misses are cheap. The
+ * entries keep the combined U/S and R/W bits so the permission check
+ * can be re-done on every hit (CPL, WP and cpl_override can change
+ * without a TLB flush), and a write hit on a page that has not been
+ * marked dirty yet still does the full walk to set the D bit.
+ *
+ * Flushing just bumps the generation number.
+ */
+#define MMU_TLB_SETS	256
+#define MMU_TLB_WAYS	4
+
+typedef struct {
+    uint32_t	virt,				/* linear page number */
+		phys,				/* physical page address */
+		gen;
+    uint8_t	perm,				/* combined U/S and R/W */
+		user,				/* value for mmu_perm */
+		dirty;				/* D bit known to be set */
+} mmu_tlb_t;
+
+static mmu_tlb_t	mmu_tlb[MMU_TLB_SETS][MMU_TLB_WAYS];
+static uint8_t		mmu_tlb_next[MMU_TLB_SETS];
+static uint32_t		mmu_tlb_gen = 1;
+
+
+static void
+mmu_tlb_flush(void)
+{
+    if (++mmu_tlb_gen == 0) {
+	/* Wrapped, so old entries could look valid again. */
+	memset(mmu_tlb, 0x00, sizeof(mmu_tlb));
+	mmu_tlb_gen = 1;
+    }
+}
+
+
 int
 mem_addr_is_ram(uint32_t addr)
 {
@@ -146,6 +191,8 @@ resetreadlookup(void)
     readlnext = 0;
     writelnext = 0;
     pccache = 0xffffffff;
+
+    mmu_tlb_flush();
 }
 
 
@@ -154,6 +201,8 @@ flushmmucache(void)
 {
     int c;
 
+    mmu_tlb_flush();
+
     for (c = 0; c < 256; c++) {
 	if (readlookup[c] != (int)0xffffffff) {
 		readlookup2[readlookup[c]] = -1;
@@ -184,6 +233,8 @@ flushmmucache_nopc(void)
 {
     int c;
 
+    mmu_tlb_flush();
+
     for (c = 0; c < 256; c++) {
 	if (readlookup[c] != (int)0xffffffff) {
 		readlookup2[readlookup[c]] = -1;
@@ -203,6 +254,8 @@ flushmmucache_cr3(void)
 {
     int c;
 
+    mmu_tlb_flush();
+
     for (c = 0; c < 256; c++) {
 	if (readlookup[c] != (int)0xffffffff) {
 		readlookup2[readlookup[c]] = -1;
@@ -214,6 +267,10 @@ flushmmucache_cr3(void)
 		writelookup[c] = 0xffffffff;
 	}
     }
+
+#ifdef USE_DYNAREC
+    codegen_flush();
+#endif
 }
 
 
@@ -241,14 +298,57 @@ mem_flush_write_page(uint32_t addr, uint32_t virt)
 #define mmutranslate_write(addr) mmutranslatereal(addr,1)
 #define rammap(x)	((uint32_t *)(_mem_exec[(x) >> MEM_GRANULARITY_BITS]))[((x) >> 2) & 0xfff]
 
+/* Add the result of a successful page table walk to the TLB. */
+static void
+mmu_tlb_add(uint32_t addr, uint32_t phys, int perm, int user, int dirty)
+{
+    mmu_tlb_t *e = mmu_tlb[(addr >> 12) & (MMU_TLB_SETS - 1)];
+    uint32_t virt = addr >> 12;
+    int c;
+
+    for (c = 0; c < MMU_TLB_WAYS; c++) {
+	if ((e[c].gen == mmu_tlb_gen) && (e[c].virt == virt))
+		break;
+    }
+    if (c == MMU_TLB_WAYS) {
+	c = mmu_tlb_next[virt & (MMU_TLB_SETS - 1)]++ & (MMU_TLB_WAYS - 1);
+	e[c].gen = mmu_tlb_gen;
+	e[c].virt = virt;
+    }
+
+    e[c].phys = phys & ~0xfff;
+    e[c].perm = perm;
+    e[c].user = user;
+    e[c].dirty = dirty;
+}
+
+
 uint32_t
 mmutranslatereal(uint32_t addr, int rw)
 {
     uint32_t temp,temp2,temp3;
     uint32_t addr2;
+    mmu_tlb_t *e;
+    int c;
 
     if (cpu_state.abrt) return -1;
 
+    /* Try the TLB first; anything unusual takes the slow path. */
+    e = mmu_tlb[(addr >> 12) & (MMU_TLB_SETS - 1)];
+    for (c = 0; c < MMU_TLB_WAYS; c++, e++) {
+	if ((e->gen != mmu_tlb_gen) || (e->virt != (addr >> 12)))
+		continue;
+
+	if ((CPL == 3 && !(e->perm & 4) && !cpl_override) ||
+	    (rw && !(e->perm & 2) && ((CPL == 3 && !cpl_override) || cr0 & WP_FLAG)) ||
+	    (rw && !e->dirty))
+		break;
+
+	mmu_perm = e->user;
+
+	return e->phys + (addr & 0xfff);
+    }
+
     addr2 = ((cr3 & ~0xfff) + ((addr >> 20) & 0xffc));
     temp = temp2 = rammap(addr2);
     if (! (temp&1)) {
@@ -279,6 +379,10 @@ mmutranslatereal(uint32_t addr, int rw)
 	mmu_perm = temp & 4;
 	rammap(addr2) |= 0x20;
 
+	/* No D bit handling for 4MB pages. */
+	mmu_tlb_add(addr, (temp & ~0x3fffff) + (addr & 0x3fffff),
+		    temp & 6, mmu_perm, 1);
+
 	return (temp & ~0x3fffff) + (addr & 0x3fffff);
     }
 
@@ -298,6 +402,8 @@ mmutranslatereal(uint32_t addr, int rw)
     rammap(addr2) |= 0x20;
     rammap((temp2 & ~0xfff) + ((addr >> 10) & 0xffc)) |= (rw?0x60:0x20);
 
+    mmu_tlb_add(addr, temp, temp3 & 6, mmu_perm, rw || (temp & 0x40));
+
     return (temp&~0xfff)+(addr&0xfff);
 }
 
@@ -1002,6 +1108,94 @@ mem_writeb_phys(uint32_t addr, uint8_t val)
 }
 
 
+/*
+ * Resolve (the start of) a physical range to host memory, for
+ * devices that do their own bus-master transfers. Returns the number
+ * of bytes, at most 'len', that can be accessed directly through
+ * *ptr, or 0 if the first byte is not backed by host memory (MMIO),
+ * in which case the caller has to use mem_readb_phys() and friends
+ * for that chunk. Spans never cross a mapping granule, so a range is
+ * walked by calling this repeatedly. Callers that write through the
+ * pointer must call mem_invalidate_range() on what they wrote.
+ */
+uint32_t
+mem_phys_span(uint32_t addr, uint32_t len, uint8_t **ptr)
+{
+    uint8_t *p = _mem_exec[addr >> MEM_GRANULARITY_BITS];
+    uint32_t n;
+
+    if (p == NULL)
+	return(0);
+
+    n = MEM_GRANULARITY_SIZE - (addr & MEM_GRANULARITY_MASK);
+    if (n > len)
+	n = len;
+
+    *ptr = &p[addr & MEM_GRANULARITY_MASK];
+
+    return(n);
+}
+
+
+/* Copy a block out of physical memory. */
+void
+mem_read_phys_block(uint32_t addr, uint8_t *buf, uint32_t len)
+{
+    uint8_t *p;
+    uint32_t n, c;
+
+    while (len > 0) {
+	n = mem_phys_span(addr, len, &p);
+	if (n > 0) {
+		memcpy(buf, p, n);
+	} else {
+		/* Not RAM, do the rest of this granule the slow way. */
+		n = MEM_GRANULARITY_SIZE - (addr & MEM_GRANULARITY_MASK);
+		if (n > len)
+			n = len;
+		for (c = 0; c < n; c++)
+			buf[c] = mem_readb_phys(addr + c);
+	}
+
+	addr += n;
+	buf += n;
+	len -= n;
+    }
+}
+
+
+/* Copy a block into physical memory, and mark it dirty for the recompiler. */
+void
+mem_write_phys_block(uint32_t addr, const uint8_t *buf, uint32_t len)
+{
+    uint32_t start = addr, total = len;
+    uint8_t *p;
+    uint32_t n, c;
+
+    if (len == 0)
+	return;
+
+    while (len > 0) {
+	n = mem_phys_span(addr, len, &p);
+	if (n > 0) {
+		memcpy(p, buf, n);
+	} else {
+		n = MEM_GRANULARITY_SIZE - (addr & MEM_GRANULARITY_MASK);
+		if (n > len)
+			n = len;
+		for (c = 0; c < n; c++)
+			mem_writeb_phys(addr + c, buf[c]);
+	}
+
+	addr += n;
+	buf += n;
+	len -= n;
+    }
+
+    mem_invalidate_range(start, start + total - 1);
+}
+
+
 uint8_t
 mem_read_ram(uint32_t addr, UNUSED(priv_t priv))
 {
@@ -1710,3 +1904,44 @@ mem_a20_recalc(void)
 
     mem_a20_state = state;
 }
+
+
+/* Save the RAM contents and memory controller state. */
+void
+mem_state_save(state_t *s)
+{
+    state_begin(s, "mem", 1);
+
+    state_write(s, ram, 1024UL * mem_size);
+    state_put(s, _mem_state);
+
+    state_put(s, rammask);
+    state_put(s, mem_a20_key);
+    state_put(s, mem_a20_alt);
+    state_put(s, mem_a20_state);
+
+    state_end(s);
+}
+
+
+int
+mem_state_load(state_t *s)
+{
+    if (state_open(s, "mem") != 1)
+	return(0);
+
+    state_read(s, ram, 1024UL * mem_size);
+    state_get(s, _mem_state);
+
+    state_get(s, rammask);
+    state_get(s, mem_a20_key);
+    state_get(s, mem_a20_alt);
+    state_get(s, mem_a20_state);
+
+    /* Shadow RAM settings may have changed, redo all mappings. */
+    mem_map_recalc(0ULL, 0x100000000ULL);
+
+    flushmmucache();
+
+    return(state_end(s));
+}
@@ -8,7 +8,7 @@
  *
  *		Definitions for the memory interface.
  *
- * Version:	@(#)mem.h	1.0.21	2021/03/16
+ * Version:	@(#)mem.h	1.0.23	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Sarah Walker, <tommowalker@tommowalker.co.uk>
@@ -237,6 +237,10 @@ extern void	mem_set_mem_state(uint32_t base, uint32_t size, int state);
 extern uint8_t	mem_readb_phys(uint32_t addr);
 extern uint16_t	mem_readw_phys(uint32_t addr);
 extern void	mem_writeb_phys(uint32_t addr, uint8_t val);
+extern uint32_t	mem_phys_span(uint32_t addr, uint32_t len, uint8_t **ptr);
+extern void	mem_read_phys_block(uint32_t addr, uint8_t *buf, uint32_t len);
+extern void	mem_write_phys_block(uint32_t addr, const uint8_t *buf,
+				     uint32_t len);
 
 extern uint8_t	mem_read_ram(uint32_t addr, void *priv);
 extern uint16_t	mem_read_ramw(uint32_t addr, void *priv);
@@ -260,6 +264,11 @@ extern void	mem_flush_write_page(uint32_t addr, uint32_t virt);
 
 extern void	mem_reset_page_blocks(void);
 
+#ifdef EMU_STATE_H
+extern void	mem_state_save(state_t *);
+extern int	mem_state_load(state_t *);
+#endif
+
 extern int	mem_addr_is_ram(uint32_t addr);
 
 extern void     flushmmucache(void);
@@ -9,7 +9,7 @@
  *		A better random number generation, used for floppy weak bits
  *		and network MAC address generation.
  *
- * Version:	@(#)random.c	1.0.4	2021/03/18
+ * Version:	@(#)random.c	1.0.5	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -38,6 +38,8 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <wchar.h>
+#include "../journal.h"
 #include "../plat.h"
 #include "random.h"
 
@@ -97,5 +99,7 @@ random_init(void)
 {
     uint32_t seed = (uint32_t)plat_timer_read();
 
+    journal_sync(JNL_SEED, &seed, sizeof(seed));
+
     srand(seed);
 }
@@ -8,7 +8,7 @@
  *
  *		Implement a generic NVRAM/CMOS/RTC device.
  *
- * Version:	@(#)nvr.c	1.0.23	2020/10/10
+ * Version:	@(#)nvr.c	1.0.25	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *
@@ -51,6 +51,8 @@
 #include <time.h>
 #include <wchar.h>
 #include "emu.h"
+#include "state.h"
+#include "journal.h"
 #include "config.h"
 #include "timer.h"
 #include "machines/machine.h"
@@ -145,6 +147,7 @@ nvr_init(nvr_t *nvr)
     struct tm *tm;
     wchar_t *sp;
     time_t now;
+    int64_t t;
     FILE *fp;
     int c;
 
@@ -200,6 +203,11 @@ nvr_init(nvr_t *nvr)
 	/* Get the current time of day, and convert to local time. */
 	(void)time(&now);
 
+	/* Use the recorded time when replaying a journal. */
+	t = (int64_t)now;
+	journal_sync(JNL_TIME, &t, sizeof(t));
+	now = (time_t)t;
+
 	if (config.time_sync == TIME_SYNC_ENABLED_UTC)
 		tm = gmtime(&now);
 	  else
@@ -301,6 +309,9 @@ nvr_load(void)
 		(void)fread(saved_nvr->regs, saved_nvr->size, 1, fp);
 		(void)fclose(fp);
 	}
+
+	/* The file may have changed since the journal was recorded. */
+	journal_sync(JNL_NVR, saved_nvr->regs, saved_nvr->size);
     }
 
     /* Get the local RTC running! */
@@ -339,6 +350,86 @@ nvr_save(void)
 }
 
 
+/* Save or restore the clock (struct tm may hold host pointers.) */
+static void
+nvr_clk_state(state_t *s, intclk_t *clk, int load)
+{
+    int32_t val[9];
+
+    if (load) {
+	state_get(s, val);
+	clk->tm_sec = val[0];
+	clk->tm_min = val[1];
+	clk->tm_hour = val[2];
+	clk->tm_mday = val[3];
+	clk->tm_mon = val[4];
+	clk->tm_year = val[5];
+	clk->tm_wday = val[6];
+	clk->tm_yday = val[7];
+	clk->tm_isdst = val[8];
+    } else {
+	val[0] = clk->tm_sec;
+	val[1] = clk->tm_min;
+	val[2] = clk->tm_hour;
+	val[3] = clk->tm_mday;
+	val[4] = clk->tm_mon;
+	val[5] = clk->tm_year;
+	val[6] = clk->tm_wday;
+	val[7] = clk->tm_yday;
+	val[8] = clk->tm_isdst;
+	state_put(s, val);
+    }
+}
+
+
+/* Save the NVR contents and clock. */
+void
+nvr_state_save(state_t *s)
+{
+    int8_t present = (saved_nvr != NULL);
+
+    state_begin(s, "nvr", 1);
+
+    state_put(s, present);
+    if (present) {
+	state_put(s, saved_nvr->regs);
+	nvr_clk_state(s, &saved_nvr->clk, 0);
+	state_put(s, saved_nvr->onesec_cnt);
+	state_put(s, saved_nvr->onesec_time);
+    }
+
+    state_end(s);
+}
+
+
+int
+nvr_state_load(state_t *s)
+{
+    int8_t present = 0;
+
+    if (state_open(s, "nvr") != 1)
+	return(0);
+
+    state_get(s, present);
+    if (present != (saved_nvr != NULL)) {
+	ERRLOG("NVR: state does not match this machine!\n");
+	return(0);
+    }
+
+    if (present) {
+	state_get(s, saved_nvr->regs);
+	nvr_clk_state(s, &saved_nvr->clk, 1);
+	state_get(s, saved_nvr->onesec_cnt);
+	state_get(s, saved_nvr->onesec_time);
+
+	/* Make sure the image file gets updated. */
+	nvr_dosave = 1;
+    }
+
+    return(state_end(s));
+}
+
+
 /* Get current time from internal clock. */
 void
 nvr_time_get(const nvr_t *nvr, intclk_t *clk)
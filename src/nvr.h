@@ -8,7 +8,7 @@
  *
  *		Definitions for the generic NVRAM/CMOS driver.
  *
- * Version:	@(#)nvr.h	1.0.12	2020/10/11
+ * Version:	@(#)nvr.h	1.0.14	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *
@@ -48,6 +48,9 @@
 # define EMU_NVR_H
 
 
+#include <time.h>
+
+
 #define NVR_MAXSIZE	256			/* max size of NVR data */
 
 /* Conversion from BCD to Binary and vice versa. */
@@ -107,6 +110,10 @@ extern void		nvr_close(nvr_t *);
 extern wchar_t		*nvr_path(const wchar_t *fn);
 extern int		nvr_load(void);
 extern int		nvr_save(void);
+#ifdef EMU_STATE_H
+extern void		nvr_state_save(state_t *);
+extern int		nvr_state_load(state_t *);
+#endif
 
 extern int		nvr_is_leap(int year);
 extern int		nvr_get_days(int month, int year);
@@ -8,7 +8,7 @@
  *
  *		Main emulator module where most things are controlled.
  *
- * Version:	@(#)pc.c	1.0.85	2021/03/23
+ * Version:	@(#)pc.c	1.0.102	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -49,6 +49,7 @@
 #include "config.h"
 #include "timer.h"
 #include "cpu/cpu.h"
+#include "cpu/profile.h"
 #ifdef USE_DYNAREC
 # include "cpu/x86.h"
 # include "cpu/codegen.h"
@@ -63,6 +64,10 @@
 #include "devices/system/pic.h"
 #include "device.h"
 #include "nvr.h"
+#include "state.h"
+#include "journal.h"
+#include "stats.h"
+#include "bench.h"
 #include "devices/ports/game.h"
 #include "devices/ports/serial.h"
 #include "devices/ports/parallel.h"
@@ -106,10 +111,23 @@ int		force_debug = 0;		/* (O) force debug output */
 int		video_fps = RENDER_FPS;		/* (O) render speed in fps */
 #endif
 int		settings_only = 0;		/* (O) only the settings dlg */
+int		max_speed = 0;			/* (O) do not sync to host clock */
+int		clone_count = 0;		/* (O) number of clones to run */
+int		clone_workers = 0;		/* (O) clones running at once */
+int		clone_test = 0;			/* (O) frames per clone in test */
+int		idle_skip = 1;			/* (O) skip idle guest time */
+int		vid_batch = 0;			/* (O) 1=per frame, 2=threaded */
 int		config_ro = 0;			/* (O) dont modify cfg file */
 int		config_keep_space = 0;		/* (O) keep spaces in cfg */
 int		log_level = LOG_INFO;		/* (O) global logging level */
 wchar_t 	log_path[1024] = { L'\0'};	/* (O) full path of logfile */
+wchar_t		state_path[1024] = { L'\0'};	/* (O) machine state file */
+wchar_t		journal_path[1024] = { L'\0'};	/* (O) input journal file */
+int		journal_replay = 0;		/* (O) replay the journal */
+wchar_t		stats_path[1024] = { L'\0'};	/* (O) statistics file */
+wchar_t		profile_path[1024] = { L'\0'};	/* (O) guest profile file */
+wchar_t		bench_name[32] = { L'\0'};	/* (O) benchmark to run */
+wchar_t		bench_base[1024] = { L'\0'};	/* (O) benchmark baseline */
 
 /* Configuration values. */
 config_t	config;				/* (C) active configuration */
@@ -129,6 +147,7 @@ int		config_changed,			/* config has changed */
 		dopause = 0,			/* system is paused */
 		doresize = 0,			/* screen resize requested */
 		mouse_capture = 0;		/* mouse is captured in app */
+int		clone_id = 0;			/* clone number, 0 = original */
 int		AT,				/* machine is AT class */
 		MCA,				/* machine has MCA bus */
 		PCI;				/* machine has PCI bus */
@@ -136,10 +155,12 @@ int		AT,				/* machine is AT class */
 /* Local variables. */
 static int	fps,				/* statistics */
 		framecount,
+		state_resumed,			/* state file was loaded */
 		title_update;			/* we want title updated */
 static int	unscaled_size_x = SCREEN_RES_X,	/* current unscaled size X */
 		unscaled_size_y = SCREEN_RES_Y,	/* current unscaled size Y */
 		efscrnsz_y = SCREEN_RES_Y;
+static stats_t	frame_stats = STATS_COUNTER("pc.frames");
 
 static FILE	*logfp = NULL;			/* logging variables */
 static char	logbuff[PCLOG_BUFF_SIZE];
@@ -190,7 +211,7 @@ pclog_ex(const char *fmt, va_list ap)
 		logseen = 0;
 		if (logdetect)
 			strcpy(logbuff, temp);
-		fprintf(logfp, temp);
+		fputs(temp, logfp);
 	} else
 		logseen++;
     } else {
@@ -514,20 +535,43 @@ usage:
 		printf("\nUsage: %ls [options] [cfg-file]\n\n", p);
 		printf("Valid options are:\n\n");
 		printf("  -? or --help         - show this information\n");
+		printf("  -B or --bench name   - run benchmark 'name' and exit\n");
 		printf("  -C or --dumpcfg      - dump config file after loading\n");
 		printf("  -D or --debug        - force debug logging\n");
+		printf("  -E or --vidthread    - render video on its own thread\n");
 		printf("  -F or --fullscreen   - start in fullscreen mode\n");
+		printf("  -G or --profile path - write guest code profile to 'path'\n");
+		printf("  -I or --noidle       - do not skip idle guest time\n");
+		printf("  -J or --journal path - record input to journal 'path'\n");
 		printf("  -L or --logfile path - set 'path' to be the logfile\n");
+		printf("  -M or --maxspeed     - run as fast as possible\n");
+		printf("  -N or --clones num   - run 'num' clones of the machine\n");
+		printf("  -O or --baseline path - compare benchmark with 'path'\n");
 		printf("  -P or --vmpath path  - set 'path' to be root for vm\n");
 		printf("  -q or --quiet        - set logging level to QUIET\n");
 #ifdef USE_WX
 		printf("  -R or --fps num      - set render speed to 'num' fps\n");
 #endif
 		printf("  -S or --settings     - show only the settings dialog\n");
+		printf("  -T or --state path   - resume from the state file 'path'\n");
+#ifndef _WIN32
+		printf("  -U or --workers num  - run at most 'num' clones at once\n");
+#endif
+		printf("  -V or --vidbatch     - render video a frame at a time\n");
 		printf("  -W or --read_only    - do not modify the config file\n");
+		printf("  -X or --stats path   - write statistics to 'path'\n");
+		printf("  -Y or --replay path  - replay input from journal 'path'\n");
+		printf("  -Z or --clonetest num - test clones, 'num' frames each\n");
 		printf("  -K or --keep_space   - keep whitespace in config file\n");
 		printf("\nA config file can be specified. If none is, the default file will be used.\n");
 		return(ret);
+	} else if (!wcscasecmp(argv[c], L"--bench") ||
+		   !wcscasecmp(argv[c], L"-B")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		wcsncpy(bench_name, argv[++c], sizeof_w(bench_name) - 1);
 	} else if (!wcscasecmp(argv[c], L"--dumpcfg") ||
 		   !wcscasecmp(argv[c], L"-C")) {
 		do_dump_config = 1;
@@ -540,6 +584,21 @@ usage:
 	} else if (!wcscasecmp(argv[c], L"--fullscreen") ||
 		   !wcscasecmp(argv[c], L"-F")) {
 		start_in_fullscreen = 1;
+	} else if (!wcscasecmp(argv[c], L"--profile") ||
+		   !wcscasecmp(argv[c], L"-G")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		wcscpy(profile_path, argv[++c]);
+	} else if (!wcscasecmp(argv[c], L"--journal") ||
+		   !wcscasecmp(argv[c], L"-J")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		wcscpy(journal_path, argv[++c]);
+		journal_replay = 0;
 	} else if (!wcscasecmp(argv[c], L"--logfile") ||
 		   !wcscasecmp(argv[c], L"-L")) {
 		if ((c+1) == argc) {
@@ -547,6 +606,26 @@ usage:
 			goto usage;
 		}
 		wcscpy(log_path, argv[++c]);
+	} else if (!wcscasecmp(argv[c], L"--maxspeed") ||
+		   !wcscasecmp(argv[c], L"-M")) {
+		max_speed = 1;
+	} else if (!wcscasecmp(argv[c], L"--noidle") ||
+		   !wcscasecmp(argv[c], L"-I")) {
+		idle_skip = 0;
+	} else if (!wcscasecmp(argv[c], L"--clones") ||
+		   !wcscasecmp(argv[c], L"-N")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		clone_count = wcstol(argv[++c], NULL, 10);
+	} else if (!wcscasecmp(argv[c], L"--baseline") ||
+		   !wcscasecmp(argv[c], L"-O")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		wcscpy(bench_base, argv[++c]);
 	} else if (!wcscasecmp(argv[c], L"--vmpath") ||
 		   !wcscasecmp(argv[c], L"-P")) {
 		if ((c+1) == argc) {
@@ -566,12 +645,61 @@ usage:
 		}
 		video_fps = wcstol(argv[++c], NULL, 10);
 #endif
+	} else if (!wcscasecmp(argv[c], L"--state") ||
+		   !wcscasecmp(argv[c], L"-T")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		wcscpy(state_path, argv[++c]);
+	} else if (!wcscasecmp(argv[c], L"--workers") ||
+		   !wcscasecmp(argv[c], L"-U")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+#ifdef _WIN32
+		/* We run just one machine, so there is no worker pool. */
+		printf("\nThe -U option is not supported on this platform.\n");
+		ret = -1;
+		goto usage;
+#else
+		clone_workers = wcstol(argv[++c], NULL, 10);
+#endif
+	} else if (!wcscasecmp(argv[c], L"--vidbatch") ||
+		   !wcscasecmp(argv[c], L"-V")) {
+		vid_batch = 1;
+	} else if (!wcscasecmp(argv[c], L"--vidthread") ||
+		   !wcscasecmp(argv[c], L"-E")) {
+		vid_batch = 2;
 	} else if (!wcscasecmp(argv[c], L"--settings") ||
 		   !wcscasecmp(argv[c], L"-S")) {
 		settings_only = 1;
 	} else if (!wcscasecmp(argv[c], L"--read_only") ||
 		   !wcscasecmp(argv[c], L"-W")) {
 		config_ro = 1;
+	} else if (!wcscasecmp(argv[c], L"--stats") ||
+		   !wcscasecmp(argv[c], L"-X")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		wcscpy(stats_path, argv[++c]);
+	} else if (!wcscasecmp(argv[c], L"--replay") ||
+		   !wcscasecmp(argv[c], L"-Y")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		wcscpy(journal_path, argv[++c]);
+		journal_replay = 1;
+	} else if (!wcscasecmp(argv[c], L"--clonetest") ||
+		   !wcscasecmp(argv[c], L"-Z")) {
+		if ((c+1) == argc) {
+			ret = -1;
+			goto usage;
+		}
+		clone_test = wcstol(argv[++c], NULL, 10);
 	} else if (!wcscasecmp(argv[c], L"--keep_space") ||
 		   !wcscasecmp(argv[c], L"-K")) {
 		config_keep_space = 1;
@@ -594,6 +722,13 @@ usage:
 	goto usage;
     }
 
+    /* Workers only limit the clones, so there have to be some. */
+    if ((clone_workers > 0) && (clone_count <= 0) && (clone_test <= 0)) {
+	printf("\nThe -U option needs -N (or -Z) to run clones.\n");
+	ret = -1;
+	goto usage;
+    }
+
     /*
      * If the user provided a path for files, use that
      * instead of the current working directory. We do
@@ -790,6 +925,31 @@ pc_init(void)
      * video card are available, so we can proceed with the
      * initialization of things.
      */
+
+    /*
+     * If we record or replay a journal, the config and NVR
+     * files must be the same for every run, so leave them.
+     */
+    if (journal_path[0] != L'\0') {
+	if (! journal_open(journal_path, journal_replay)) return(0);
+
+	config_ro = 1;
+    }
+
+    /* Open the statistics file if requested. */
+    if (stats_path[0] != L'\0')
+	(void)stats_open(stats_path);
+    stats_register(&frame_stats);
+
+    /* Start the guest code profiler if requested. */
+    if (profile_path[0] != L'\0')
+	(void)prof_open(profile_path);
+
+    /* Run a benchmark instead of the guest software if requested. */
+    if (bench_name[0] != L'\0') {
+	if (! bench_open(bench_name, bench_base)) return(0);
+    }
+
     random_init();
 
     mem_init();
@@ -861,6 +1021,12 @@ pc_close(thread_t *ptr)
     mo_close();
 
     scsi_disk_close();
+
+    journal_close();
+
+    stats_close();
+
+    prof_close();
 }
 
 
@@ -898,6 +1064,7 @@ pc_reset_hard_init(void)
     /* Reset the general machine support modules. */
     io_reset();
     timer_reset();
+    prof_reset();
     device_reset();
 
     /*
@@ -1003,6 +1170,21 @@ pc_reset_hard_init(void)
 
     //FIXME: already done in machine_reset() - why needed here??
     pc_set_speed(1);
+
+    /* If requested, resume from a saved state (only once.) */
+    if ((state_path[0] != L'\0') && !state_resumed) {
+	state_resumed = 1;
+
+	if (state_load(state_path) < 0)
+		pc_reset_hard();
+    }
+
+    /* The same goes for the disks, so keep their changes in memory. */
+    if (journal_mode != JOURNAL_OFF)
+	(void)hdd_image_cow();
+
+    /* Load the benchmark payload, if we run one. */
+    bench_reset();
 }
 
 
@@ -1035,6 +1217,134 @@ pc_reset(int hard)
 }
 
 
+/* Save the state of the running machine to a file. */
+int
+pc_save_state(const wchar_t *fn)
+{
+    int p = dopause;
+    int ret;
+
+    pc_pause(1);
+
+    plat_delay_ms(100);
+
+    ret = state_save(fn);
+
+    pc_pause(p);
+
+    return(ret);
+}
+
+
+/* Restore the state of the machine from a file. */
+int
+pc_load_state(const wchar_t *fn)
+{
+    int p = dopause;
+    int ret;
+
+    pc_pause(1);
+
+    plat_delay_ms(100);
+
+    ret = state_load(fn);
+    if (ret < 0) {
+	/* Partially restored, so start over. */
+	pc_reset_hard();
+	ret = 0;
+    }
+
+    pc_pause(p);
+
+    return(ret);
+}
+
+
+/*
+ * Stop all host activity of the (paused) machine, so the process
+ * can be forked.
+ *
+ * Only the forking thread survives in the new process, and host
+ * resources such as network sockets or the audio device can not
+ * be shared by two machines. So, the host network provider and
+ * the sound output are closed, and all helper threads are told
+ * to finish their work and exit. Ports linked to a host serial
+ * port can not be handed over at all, so we refuse to go on.
+ */
+int
+pc_fork_stop(void)
+{
+    if (serial_linked()) {
+	ERRLOG("PC: can not fork with a linked host serial port!\n");
+	return(0);
+    }
+
+    network_suspend();
+
+    sound_host(0);
+
+    device_threads(0);
+
+    video_threads(0);
+
+    return(1);
+}
+
+
+/*
+ * Start all host activity again after a fork, through the same
+ * paths that set it up originally. A clone does not get the host
+ * network back, as it would have to share the provider and the
+ * MAC address of the card with the original.
+ */
+void
+pc_fork_start(int clone)
+{
+    video_threads(1);
+
+    device_threads(1);
+
+    sound_host(1);
+
+    if (! clone)
+	(void)network_resume();
+      else if (config.network_card != NET_CARD_NONE)
+	INFO("PC: networking is disabled in clones\n");
+}
+
+
+/*
+ * Turn this instance into a clone of the running machine.
+ *
+ * Called by the platform in a copy of the (paused) process, so
+ * the guest memory and all other state are shared copy-on-write
+ * with the original. The disk images are switched to an overlay
+ * in memory, and the config and NVR files are left alone, so no
+ * clone can affect the others, or the original machine.
+ */
+int
+pc_clone(int id)
+{
+    /* The clones would all write to the same journal. */
+    if (journal_mode != JOURNAL_OFF) {
+	ERRLOG("Clone %i: can not clone while journaling!\n", id);
+	return(0);
+    }
+
+    if (! hdd_image_cow()) {
+	ERRLOG("Clone %i: unable to make disk images copy-on-write!\n", id);
+	return(0);
+    }
+
+    config_ro = 1;
+    clone_id = id;
+
+    INFO("Clone %i: running as a copy of the machine\n", id);
+
+    return(1);
+}
+
+
 /* FIXME: this has to be reviewed! */
 void
 pc_reload(UNUSED(const wchar_t *fn))
@@ -1103,11 +1413,22 @@ pc_thread(void *param)
 	msec += (new_time - old_time);
 	old_time = new_time;
 
-	if (msec > 0) {
+	/*
+	 * Normally we run a frame whenever the host clock says one is
+	 * due. In max-speed mode, we just run them back-to-back, and
+	 * the guest's own timers simply run faster than real time.
+	 */
+	if (max_speed || (msec > 0)) {
 		msec -= SLICE;
-		if (msec > 50)
+		if (max_speed || (msec > 50))
 			msec = 0;
 
+		/* Hand any pending input to the machine. */
+		journal_frame();
+
+		/* Wait for a free worker, if we share a pool. */
+		plat_slice(1);
+
 		plat_blitter(1);
 
 		/* Run a frame of code. */
@@ -1115,12 +1436,32 @@ pc_thread(void *param)
 
 		plat_blitter(0);
 
+		plat_slice(0);
+
 		mouse_poll();
 
-		joystick_process();
+		/* Host joysticks are not journaled. */
+		if (journal_mode == JOURNAL_OFF)
+			joystick_process();
 
 		/* One more frame done! */
 		framecount++;
+		stats_inc(&frame_stats);
+
+		/* A benchmark run ends by itself. */
+		if (bench_frame())
+			*quitp = 1;
+
+		/* So does a clone in a clone test. */
+		if ((clone_id != 0) && (clone_test > 0) && (--clone_test == 0))
+			*quitp = 1;
+	} else {
+		/*
+		 * We are ahead of the host clock, so give up the
+		 * CPU until the next frame is due, instead of
+		 * spinning on the timer.
+		 */
+		plat_delay_ms(1 - msec);
 	}
 
 	/*
@@ -1168,6 +1509,13 @@ pc_onesec(void)
     fps = framecount;
     framecount = 0;
 
+#ifdef USE_DYNAREC
+    if (cpu_dynarec)
+	codegen_stats_latch();
+#endif
+
+    stats_onesec();
+
     title_update = 1;
 }
 
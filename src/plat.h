@@ -8,7 +8,7 @@
  *
  *		Define the various platform support functions.
  *
- * Version:	@(#)plat.h	1.0.27	2021/02/13
+ * Version:	@(#)plat.h	1.0.28	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *
@@ -161,6 +161,7 @@ extern uint64_t	plat_timer_read(void);
 extern uint32_t	plat_timer_ms(void);
 extern void	plat_delay_ms(uint32_t count);
 extern void	plat_blitter(int own);
+extern void	plat_slice(int begin);
 extern void	plat_mouse_capture(int on);
 extern int	plat_get_kbd_state(void);
 extern void	plat_set_kbd_state(int flags);
@@ -0,0 +1,350 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Save and restore the state of a running machine.
+ *
+ *		A state file starts with a small header, followed by a
+ *		number of sections, one for each of the core modules
+ *		(CPU, memory, timers, and the basic system devices),
+ *		and one for each active device that can save its own
+ *		state. Each section is tagged with its name and data
+ *		version, and ends with a trailer holding the number of
+ *		bytes in it, so we can detect a mismatch between the
+ *		saving and the loading code.
+ *
+ *		Since the sections do not describe the hardware itself,
+ *		a state can only be restored into the same machine with
+ *		the same configuration it was saved from. Data is stored
+ *		in host byte order.
+ *
+ * Version:	@(#)state.c	1.0.3	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ *		Redistribution and  use  in source  and binary forms, with
+ *		or  without modification, are permitted  provided that the
+ *		following conditions are met:
+ *
+ *		1. Redistributions of  source  code must retain the entire
+ *		   above notice, this list of conditions and the following
+ *		   disclaimer.
+ *
+ *		2. Redistributions in binary form must reproduce the above
+ *		   copyright  notice,  this list  of  conditions  and  the
+ *		   following disclaimer in  the documentation and/or other
+ *		   materials provided with the distribution.
+ *
+ *		3. Neither the  name of the copyright holder nor the names
+ *		   of  its  contributors may be used to endorse or promote
+ *		   products  derived from  this  software without specific
+ *		   prior written permission.
+ *
+ * THIS SOFTWARE  IS  PROVIDED BY THE  COPYRIGHT  HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND  ANY EXPRESS  OR  IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE  ARE  DISCLAIMED. IN  NO  EVENT  SHALL THE COPYRIGHT
+ * HOLDER OR  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL,  EXEMPLARY,  OR  CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES;  LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON  ANY
+ * THEORY OF  LIABILITY, WHETHER IN  CONTRACT, STRICT  LIABILITY, OR  TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING  IN ANY  WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <wchar.h>
+#include "emu.h"
+#include "state.h"
+#include "cpu/cpu.h"
+#include "mem.h"
+#include "timer.h"
+#include "device.h"
+#include "nvr.h"
+#include "devices/system/dma.h"
+#include "devices/system/pic.h"
+#include "devices/system/pit.h"
+#include "machines/machine.h"
+#include "plat.h"
+
+
+struct _state_ {
+    FILE	*fp;
+
+    int8_t	loading;			/* reading a state file */
+    int8_t	error;				/* I/O or format error seen */
+
+    uint32_t	count;				/* bytes in current section */
+};
+
+
+static const char state_magic[16] = "VARCem STATE\032";
+
+
+/* Start a new section. */
+void
+state_begin(state_t *s, const char *name, int version)
+{
+    char temp[STATE_NAMELEN];
+    int32_t ver = version;
+
+    memset(temp, 0x00, sizeof(temp));
+    strncpy(temp, name, sizeof(temp) - 1);
+
+    state_write(s, temp, sizeof(temp));
+    state_put(s, ver);
+
+    s->count = 0;
+}
+
+
+/* Open the next section, and return its data version. */
+int
+state_open(state_t *s, const char *name)
+{
+    char temp[STATE_NAMELEN];
+    int32_t ver = -1;
+
+    if (! state_read(s, temp, sizeof(temp)) || !state_get(s, ver))
+	return(-1);
+    temp[sizeof(temp) - 1] = '\0';
+
+    if (strncmp(temp, name, sizeof(temp) - 1)) {
+	ERRLOG("STATE: expected section '%s', found '%s'\n", name, temp);
+	s->error = 1;
+	return(-1);
+    }
+
+    s->count = 0;
+
+    return(ver);
+}
+
+
+/* Close the current section, and check its size. */
+int
+state_end(state_t *s)
+{
+    uint32_t count = s->count;
+    uint32_t size;
+
+    if (s->loading) {
+	if (! state_get(s, size))
+		return(0);
+
+	if (size != count) {
+		ERRLOG("STATE: section size mismatch (%lu, expected %lu)\n",
+		       (unsigned long)count, (unsigned long)size);
+		s->error = 1;
+	}
+    } else
+	state_put(s, count);
+
+    return(! s->error);
+}
+
+
+void
+state_write(state_t *s, const void *ptr, uint32_t len)
+{
+    if (s->error)
+	return;
+
+    if (fwrite(ptr, 1, len, s->fp) != len) {
+	ERRLOG("STATE: write error!\n");
+	s->error = 1;
+	return;
+    }
+
+    s->count += len;
+}
+
+
+int
+state_read(state_t *s, void *ptr, uint32_t len)
+{
+    if (s->error)
+	return(0);
+
+    if (fread(ptr, 1, len, s->fp) != len) {
+	ERRLOG("STATE: unexpected end of file!\n");
+	s->error = 1;
+	return(0);
+    }
+
+    s->count += len;
+
+    return(1);
+}
+
+
+/* Write a string into a fixed-size field. */
+static void
+put_name(state_t *s, const char *str)
+{
+    char temp[STATE_NAMELEN];
+
+    memset(temp, 0x00, sizeof(temp));
+    strncpy(temp, str, sizeof(temp) - 1);
+
+    state_write(s, temp, sizeof(temp));
+}
+
+
+/* Read a string from a fixed-size field, and compare it. */
+static int
+check_name(state_t *s, const char *what, const char *str)
+{
+    char temp[STATE_NAMELEN];
+
+    if (! state_read(s, temp, sizeof(temp)))
+	return(0);
+    temp[sizeof(temp) - 1] = '\0';
+
+    if (strncmp(temp, str, sizeof(temp) - 1)) {
+	ERRLOG("STATE: saved for %s '%s', not '%s'!\n", what, temp, str);
+	s->error = 1;
+	return(0);
+    }
+
+    return(1);
+}
+
+
+int
+state_save(const wchar_t *fn)
+{
+    state_t st;
+    int32_t ver = STATE_VERSION;
+
+    memset(&st, 0x00, sizeof(st));
+    st.fp = plat_fopen(fn, L"wb");
+    if (st.fp == NULL) {
+	ERRLOG("STATE: unable to create '%ls'\n", fn);
+	return(0);
+    }
+
+    INFO("STATE: saving machine state to '%ls'\n", fn);
+
+    state_write(&st, state_magic, sizeof(state_magic));
+    state_put(&st, ver);
+
+    /* Identify the machine, so we do not load into another one. */
+    state_begin(&st, "machine", 1);
+    put_name(&st, machine_get_internal_name());
+    put_name(&st, cpu_get_name());
+    state_put(&st, mem_size);
+    state_end(&st);
+
+    /* Save the core modules. */
+    cpu_state_save(&st);
+    mem_state_save(&st);
+    pic_state_save(&st);
+    pit_state_save(&st);
+    dma_state_save(&st);
+    nvr_state_save(&st);
+
+    /* Save all devices, if they all know how to. */
+    if (! device_state_save(&st))
+	st.error = 1;
+
+    /* Timers go last, as the devices own their counters. */
+    timer_state_save(&st);
+
+    state_begin(&st, "end", 1);
+    state_end(&st);
+
+    (void)fclose(st.fp);
+
+    if (st.error) {
+	plat_remove(fn);
+	return(0);
+    }
+
+    return(1);
+}
+
+
+/*
+ * Load a saved state into the current machine.
+ *
+ * Returns 1 if all went well, 0 if the file could not be used
+ * (the machine is left as it was), or -1 if something failed
+ * after the machine was partially restored, in which case the
+ * caller should reset it.
+ */
+int
+state_load(const wchar_t *fn)
+{
+    char temp[sizeof(state_magic)];
+    state_t st;
+    int32_t ver;
+    int ok;
+
+    memset(&st, 0x00, sizeof(st));
+    st.loading = 1;
+    st.fp = plat_fopen(fn, L"rb");
+    if (st.fp == NULL) {
+	ERRLOG("STATE: unable to open '%ls'\n", fn);
+	return(0);
+    }
+
+    INFO("STATE: loading machine state from '%ls'\n", fn);
+
+    /* Check the header. */
+    if (!state_read(&st, temp, sizeof(temp)) || !state_get(&st, ver) ||
+	memcmp(temp, state_magic, sizeof(temp)) || (ver != STATE_VERSION)) {
+	ERRLOG("STATE: '%ls' is not a valid state file!\n", fn);
+	(void)fclose(st.fp);
+	return(0);
+    }
+
+    /* Make sure this is the same machine. */
+    if ((state_open(&st, "machine") != 1) ||
+	!check_name(&st, "machine", machine_get_internal_name()) ||
+	!check_name(&st, "CPU", cpu_get_name()) || !state_get(&st, ver)) {
+	(void)fclose(st.fp);
+	return(0);
+    }
+    if (ver != mem_size) {
+	ERRLOG("STATE: saved with %iKB of memory, not %iKB!\n",
+	       ver, mem_size);
+	(void)fclose(st.fp);
+	return(0);
+    }
+    if (! state_end(&st)) {
+	(void)fclose(st.fp);
+	return(0);
+    }
+
+    /* From here on, we are modifying the machine. */
+    ok = cpu_state_load(&st) &&
+	 mem_state_load(&st) &&
+	 pic_state_load(&st) &&
+	 pit_state_load(&st) &&
+	 dma_state_load(&st) &&
+	 nvr_state_load(&st) &&
+	 device_state_load(&st) &&
+	 timer_state_load(&st) &&
+	 (state_open(&st, "end") == 1) &&
+	 state_end(&st);
+
+    (void)fclose(st.fp);
+
+    if (! ok) {
+	ERRLOG("STATE: unable to restore state from '%ls'!\n", fn);
+	return(-1);
+    }
+
+    return(1);
+}
@@ -0,0 +1,216 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Registry of named performance counters and histograms.
+ *
+ *		The core and the devices keep their statistics in static
+ *		stats_t objects, which they register with us by name.
+ *		If a statistics file was given, the registry is written
+ *		to it every STATS_INTERVAL seconds, as plain text, with
+ *		one line per counter. The file can also be a named pipe
+ *		(FIFO), so another program can watch a running machine.
+ *
+ * Version:	@(#)stats.c	1.0.2	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ *		Redistribution and  use  in source  and binary forms, with
+ *		or  without modification, are permitted  provided that the
+ *		following conditions are met:
+ *
+ *		1. Redistributions of  source  code must retain the entire
+ *		   above notice, this list of conditions and the following
+ *		   disclaimer.
+ *
+ *		2. Redistributions in binary form must reproduce the above
+ *		   copyright  notice,  this list  of  conditions  and  the
+ *		   following disclaimer in  the documentation and/or other
+ *		   materials provided with the distribution.
+ *
+ *		3. Neither the  name of the copyright holder nor the names
+ *		   of  its  contributors may be used to endorse or promote
+ *		   products  derived from  this  software without specific
+ *		   prior written permission.
+ *
+ * THIS SOFTWARE  IS  PROVIDED BY THE  COPYRIGHT  HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND  ANY EXPRESS  OR  IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE  ARE  DISCLAIMED. IN  NO  EVENT  SHALL THE COPYRIGHT
+ * HOLDER OR  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL,  EXEMPLARY,  OR  CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES;  LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON  ANY
+ * THEORY OF  LIABILITY, WHETHER IN  CONTRACT, STRICT  LIABILITY, OR  TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING  IN ANY  WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include "emu.h"
+#include "stats.h"
+#include "plat.h"
+
+
+static stats_t	*stats_list;			/* registered statistics */
+static FILE	*stats_fp;
+static int	stats_secs;			/* seconds since last dump */
+static uint32_t	stats_start_ms;			/* host time at open */
+static uint64_t	stats_start_tmr;
+
+
+/* Add a statistic to the registry, if not already there. */
+void
+stats_register(stats_t *st)
+{
+    stats_t *ptr;
+
+    for (ptr = stats_list; ptr != NULL; ptr = ptr->next)
+	if (ptr == st) return;
+
+    st->next = stats_list;
+    stats_list = st;
+}
+
+
+/* Add a sample to a histogram. */
+void
+stats_hist_add(stats_t *st, uint64_t val)
+{
+    int b = 0;
+
+    st->count++;
+    st->sum += val;
+
+    while ((val >>= 1) != 0)
+	b++;
+    if (b >= STATS_HIST)
+	b = STATS_HIST - 1;
+
+    st->hist[b]++;
+}
+
+
+/* Clear all registered statistics. */
+void
+stats_reset(void)
+{
+    stats_t *st;
+
+    for (st = stats_list; st != NULL; st = st->next) {
+	st->count = st->sum = 0;
+	memset(st->hist, 0x00, sizeof(st->hist));
+	if (st->table != NULL)
+		memset(st->table, 0x00, st->size * sizeof(uint32_t));
+    }
+}
+
+
+/* Write the current values of all statistics. */
+void
+stats_dump(FILE *fp)
+{
+    uint32_t ms = plat_timer_ms() - stats_start_ms;
+    stats_t *st;
+    int i, n;
+
+    fprintf(fp, "# %s %s statistics, %lu.%03lu sec\n",
+	    emu_title, emu_version,
+	    (unsigned long)(ms / 1000), (unsigned long)(ms % 1000));
+
+    /* Histograms of host times are in host timer ticks. */
+    if (ms > 0)
+	fprintf(fp, "# host timer: %llu ticks/sec\n",
+		(unsigned long long)(((plat_timer_read() - stats_start_tmr) * 1000) / ms));
+
+    for (st = stats_list; st != NULL; st = st->next) {
+	switch (st->type) {
+		case STATS_TYPE_COUNTER:
+			fprintf(fp, "%s %llu\n",
+				st->name, (unsigned long long)st->count);
+			break;
+
+		case STATS_TYPE_HIST:
+			fprintf(fp, "%s count=%llu avg=%llu",
+				st->name, (unsigned long long)st->count,
+				(unsigned long long)(st->count ? (st->sum / st->count) : 0));
+			for (i = 0; i < STATS_HIST; i++) {
+				if (st->hist[i] == 0) continue;
+				fprintf(fp, " %llu:%llu",
+					(unsigned long long)(1ULL << i),
+					(unsigned long long)st->hist[i]);
+			}
+			fprintf(fp, "\n");
+			break;
+
+		case STATS_TYPE_TABLE:
+			for (i = n = 0; i < st->size; i++) {
+				if (st->table[i] == 0) continue;
+				fprintf(fp, "%s[%04x] %lu\n",
+					st->name, i, (unsigned long)st->table[i]);
+				n++;
+			}
+			if (n == 0)
+				fprintf(fp, "%s -\n", st->name);
+			break;
+	}
+    }
+
+    fprintf(fp, "\n");
+    fflush(fp);
+}
+
+
+/* Open the file we periodically dump the statistics to. */
+int
+stats_open(const wchar_t *fn)
+{
+    stats_fp = plat_fopen(fn, L"w");
+    if (stats_fp == NULL) {
+	ERRLOG("STATS: unable to open '%ls'\n", fn);
+	return(0);
+    }
+
+    stats_secs = 0;
+    stats_start_ms = plat_timer_ms();
+    stats_start_tmr = plat_timer_read();
+
+    INFO("STATS: writing statistics to '%ls'\n", fn);
+
+    return(1);
+}
+
+
+void
+stats_close(void)
+{
+    if (stats_fp == NULL) return;
+
+    /* One final dump. */
+    stats_dump(stats_fp);
+
+    (void)fclose(stats_fp);
+    stats_fp = NULL;
+}
+
+
+/* Called once per second by the platform code. */
+void
+stats_onesec(void)
+{
+    if (stats_fp == NULL) return;
+
+    if (++stats_secs >= STATS_INTERVAL) {
+	stats_dump(stats_fp);
+	stats_secs = 0;
+    }
+}
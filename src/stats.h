@@ -0,0 +1,114 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Definitions for the performance statistics module.
+ *
+ * Version:	@(#)stats.h	1.0.2	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ *		Redistribution and  use  in source  and binary forms, with
+ *		or  without modification, are permitted  provided that the
+ *		following conditions are met:
+ *
+ *		1. Redistributions of  source  code must retain the entire
+ *		   above notice, this list of conditions and the following
+ *		   disclaimer.
+ *
+ *		2. Redistributions in binary form must reproduce the above
+ *		   copyright  notice,  this list  of  conditions  and  the
+ *		   following disclaimer in  the documentation and/or other
+ *		   materials provided with the distribution.
+ *
+ *		3. Neither the  name of the copyright holder nor the names
+ *		   of  its  contributors may be used to endorse or promote
+ *		   products  derived from  this  software without specific
+ *		   prior written permission.
+ *
+ * THIS SOFTWARE  IS  PROVIDED BY THE  COPYRIGHT  HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND  ANY EXPRESS  OR  IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE  ARE  DISCLAIMED. IN  NO  EVENT  SHALL THE COPYRIGHT
+ * HOLDER OR  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL,  EXEMPLARY,  OR  CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES;  LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON  ANY
+ * THEORY OF  LIABILITY, WHETHER IN  CONTRACT, STRICT  LIABILITY, OR  TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING  IN ANY  WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef EMU_STATS_H
+# define EMU_STATS_H
+
+
+#define STATS_HIST	32			/* histogram buckets (log2) */
+#define STATS_INTERVAL	10			/* seconds between dumps */
+
+
+/* Types of statistics. */
+enum {
+    STATS_TYPE_COUNTER = 0,			/* simple event counter */
+    STATS_TYPE_HIST,				/* histogram of values */
+    STATS_TYPE_TABLE				/* table of counters */
+};
+
+/*
+ * A single named statistic.
+ *
+ * These are normally static objects in the module that updates
+ * them, set up with one of the initializer macros below, and
+ * registered once during its init or reset, so updating them is
+ * just an increment. Histograms count values in power-of-two
+ * buckets, and tables are indexed (by port number, for example)
+ * with only the non-zero entries being reported.
+ */
+typedef struct _stats_ {
+    struct _stats_ *next;			/* registered list */
+    const char	*name;
+    int		type;
+
+    uint32_t	*table;				/* table entries */
+    int		size;				/* number of entries */
+
+    uint64_t	count;				/* events, or samples */
+    uint64_t	sum;				/* sum of all samples */
+    uint64_t	hist[STATS_HIST];		/* histogram buckets */
+} stats_t;
+
+
+#define STATS_COUNTER(n)	{ NULL, (n), STATS_TYPE_COUNTER }
+#define STATS_HISTOGRAM(n)	{ NULL, (n), STATS_TYPE_HIST }
+#define STATS_TABLE(n,t,s)	{ NULL, (n), STATS_TYPE_TABLE, (t), (s) }
+
+
+/* Update a counter. */
+#define stats_inc(s)		(s)->count++
+#define stats_add(s,v)		(s)->count += (v)
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void	stats_register(stats_t *);
+extern void	stats_hist_add(stats_t *, uint64_t val);
+extern void	stats_reset(void);
+
+extern int	stats_open(const wchar_t *fn);
+extern void	stats_close(void);
+extern void	stats_dump(FILE *fp);
+extern void	stats_onesec(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif	/*EMU_STATS_H*/
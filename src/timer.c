@@ -8,7 +8,7 @@
  *
  *		System timer module.
  *
- * Version:	@(#)timer.c	1.0.5	2019/05/17
+ * Version:	@(#)timer.c	1.0.10	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -41,6 +41,8 @@
 #include <string.h>
 #include <wchar.h>
 #include "emu.h"
+#include "state.h"
+#include "stats.h"
 #include "timer.h"
 
 
@@ -55,6 +57,7 @@ tmrval_t		timer_count = 0;
 
 static struct {
     int		present;
+    int		queued;				/* on the expired heap */
 
     tmrval_t	*count;
     tmrval_t	*enable;
@@ -65,52 +68,184 @@ static struct {
 static int	present = 0;
 static tmrval_t	latch = 0;
 
+/*
+ * Min-heap of expired timers, ordered by their count at the
+ * time they were queued (and by index, to keep the order in
+ * which equal timers fire the same as before.)
+ *
+ * The counts are owned by the devices, which change them at
+ * will, so a timer's key is re-checked when it is popped.
+ */
+typedef struct {
+    tmrval_t	key;
+    int		idx;
+} heap_t;
 
-void
-timer_process(void)
+static heap_t	heap[TIMERS_MAX];
+static int	heap_len = 0;
+
+static stats_t	timer_fired = STATS_COUNTER("timer.callbacks");
+
+
+static __inline int
+heap_less(int a, int b)
 {
-    tmrval_t diff = latch - timer_count;	/* get actual elapsed time */
-    tmrval_t enable[TIMERS_MAX];
-    int c, process = 0;
+    if (heap[a].key != heap[b].key)
+	return(heap[a].key < heap[b].key);
 
-    latch = 0;
+    return(heap[a].idx < heap[b].idx);
+}
+
+
+static void
+heap_push(int c)
+{
+    heap_t tmp;
+    int i, p;
+
+    if (timers[c].queued)
+	return;
+    timers[c].queued = 1;
+
+    i = heap_len++;
+    heap[i].key = *timers[c].count;
+    heap[i].idx = c;
+
+    while (i > 0) {
+	p = (i - 1) >> 1;
+	if (! heap_less(i, p))
+		break;
+
+	tmp = heap[i];
+	heap[i] = heap[p];
+	heap[p] = tmp;
+	i = p;
+    }
+}
+
+
+static int
+heap_pop(tmrval_t *key)
+{
+    heap_t tmp;
+    int c, i, l, r, m;
+
+    c = heap[0].idx;
+    *key = heap[0].key;
+    timers[c].queued = 0;
+
+    heap[0] = heap[--heap_len];
+
+    i = 0;
+    for (;;) {
+	l = (i << 1) + 1;
+	r = l + 1;
+	m = i;
+	if ((l < heap_len) && heap_less(l, m))
+		m = l;
+	if ((r < heap_len) && heap_less(r, m))
+		m = r;
+	if (m == i)
+		break;
+
+	tmp = heap[i];
+	heap[i] = heap[m];
+	heap[m] = tmp;
+	i = m;
+    }
+
+    return(c);
+}
+
+
+/* Run all expired timers on the heap, lowest count first. */
+static void
+timer_dispatch(void)
+{
+    tmrval_t key;
+    int c;
+
+    while (heap_len > 0) {
+	c = heap_pop(&key);
+
+	if (! *timers[c].enable || (*timers[c].count > (tmrval_t)0))
+		continue;
+
+	/* Count was changed while queued, re-queue with the new value. */
+	if (*timers[c].count != key) {
+		heap_push(c);
+		continue;
+	}
+
+	stats_inc(&timer_fired);
+	timers[c].callback(timers[c].priv);
+
+	if (*timers[c].enable && (*timers[c].count <= (tmrval_t)0))
+		heap_push(c);
+    }
+}
+
+
+/*
+ * Take the elapsed time off all enabled timers, and queue the
+ * ones that expired. Returns the lowest count of the others,
+ * which is the next deadline if nothing was queued.
+ */
+static tmrval_t
+timer_scan(tmrval_t diff)
+{
+    tmrval_t lowest = 0x7fffffffffffffff;
+    int c;
 
     for (c = 0; c < present; c++) {
 	/* This is needed to avoid timer crashes on hard reset. */
 	if ((timers[c].enable == NULL) || (timers[c].count == NULL))
 		continue;
 
-	enable[c] = *timers[c].enable;
-	if (enable[c]) {
+	if (*timers[c].enable) {
 		*timers[c].count = *timers[c].count - diff;
 		if (*timers[c].count <= (tmrval_t)0)
-			process = 1;
+			heap_push(c);
+		else if (*timers[c].count < lowest)
+			lowest = *timers[c].count;
 	}
     }
 
-    if (! process)
-	return;
+    return(lowest);
+}
 
-    for (;;) {
-	tmrval_t lowest = 1LL;
-	int lowest_c;
-
-	for (c = 0; c < present; c++) {
-		if (enable[c]) {
-			if (*timers[c].count < lowest) {
-				lowest = *timers[c].count;
-				lowest_c = c;
-			}
-		}
-	}
 
-	if (lowest > 0)
-		break;
+/* Run the expired timers, and return the next deadline. */
+static tmrval_t
+timer_expire(void)
+{
+    tmrval_t diff = latch - timer_count;	/* get actual elapsed time */
+    tmrval_t next;
+
+    latch = 0;
+
+    next = timer_scan(diff);
 
-	timers[lowest_c].callback(timers[lowest_c].priv);
+    /*
+     * Run the expired timers. Their callbacks may have moved
+     * other timers to or past their deadline, so keep going
+     * until none are left, rather than rescanning the table
+     * after every callback.
+     */
+    while (heap_len > 0) {
+	timer_dispatch();
+
+	next = timer_scan(0);
+    }
 
-	enable[lowest_c] = *timers[lowest_c].enable;
-    }              
+    return(next);
+}
+
+
+void
+timer_process(void)
+{
+    (void)timer_expire();
 }
 
 
@@ -122,7 +257,10 @@ timer_update_outstanding(void)
     latch = 0x7fffffffffffffff;
 
     for (c = 0; c < present; c++) {
-	if (*timers[c].enable && *timers[c].count < latch)
+	if ((timers[c].enable == NULL) || (timers[c].count == NULL))
+		continue;
+
+	if (*timers[c].enable && (*timers[c].count < latch))
 		latch = *timers[c].count;
     }
 
@@ -130,12 +268,29 @@ timer_update_outstanding(void)
 }
 
 
+/*
+ * Same as timer_process() followed by timer_update_outstanding(),
+ * but the last pass over the timers also finds the next deadline,
+ * so that it does not take another one.
+ */
+void
+timer_run(void)
+{
+    latch = timer_expire();
+
+    timer_count = latch = (latch + ((1 << TIMER_SHIFT) - 1));
+}
+
+
 void
 timer_reset(void)
 {
     present = 0;
+    heap_len = 0;
 
     latch = timer_count = 0;
+
+    stats_register(&timer_fired);
 }
 
 
@@ -164,6 +319,7 @@ timer_add(void (*func)(priv_t), priv_t priv, tmrval_t *count, tmrval_t *enable)
     }
 
     timers[present].present = 1;
+    timers[present].queued = 0;
     timers[present].callback = func;
     timers[present].priv = priv;
     timers[present].count = count;
@@ -172,3 +328,75 @@ timer_add(void (*func)(priv_t), priv_t priv, tmrval_t *count, tmrval_t *enable)
 
     return present - 1;
 }
+
+
+/* Save the timer state, including the devices' counters. */
+void
+timer_state_save(state_t *s)
+{
+    tmrval_t val;
+    int32_t n = present;
+    int c;
+
+    state_begin(s, "timer", 1);
+
+    state_put(s, timer_start);
+    state_put(s, timer_count);
+    state_put(s, latch);
+
+    state_put(s, n);
+    for (c = 0; c < present; c++) {
+	val = (timers[c].count != NULL) ? *timers[c].count : 0;
+	state_put(s, val);
+	val = (timers[c].enable != NULL) ? *timers[c].enable : 0;
+	state_put(s, val);
+    }
+
+    state_end(s);
+}
+
+
+/*
+ * Restore the timer state.
+ *
+ * The timers themselves are set up by the devices, which are
+ * the same ones (in the same order) as when the state was saved,
+ * so we only need to restore their counters.
+ */
+int
+timer_state_load(state_t *s)
+{
+    tmrval_t val;
+    int32_t n;
+    int c;
+
+    if (state_open(s, "timer") != 1)
+	return(0);
+
+    state_get(s, timer_start);
+    state_get(s, timer_count);
+    state_get(s, latch);
+
+    if (! state_get(s, n))
+	return(0);
+    if (n != present) {
+	ERRLOG("TIMER: state has %i timers, machine has %i!\n", n, present);
+	return(0);
+    }
+
+    for (c = 0; c < present; c++) {
+	state_get(s, val);
+	if (timers[c].count != NULL)
+		*timers[c].count = val;
+
+	/* Do not write to the shared 'always enabled' flag. */
+	state_get(s, val);
+	if ((timers[c].enable != NULL) && (*timers[c].enable != val))
+		*timers[c].enable = val;
+
+	timers[c].queued = 0;
+    }
+    heap_len = 0;
+
+    return(state_end(s));
+}
@@ -8,7 +8,7 @@
  *
  *		Definitions for the system timer module.
  *
- * Version:	@(#)timer.h	1.0.6	2021/03/12
+ * Version:	@(#)timer.h	1.0.8	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -62,10 +62,8 @@ extern tmrval_t	timer_count;
                 tmrval_t __diff = timer_start - (cycles);	\
 		timer_count -= __diff;				\
                 timer_start = cycles;				\
-		if (timer_count <= 0) {				\
-			timer_process();			\
-			timer_update_outstanding();		\
-		}						\
+		if (timer_count <= 0)				\
+			timer_run();				\
 	} while (0)
 
 #define timer_clock()						\
@@ -79,16 +77,22 @@ extern tmrval_t	timer_count;
                         timer_start = cycles * cpu_clock_multi;	\
                 }						\
 		timer_count -= __diff;				\
-		timer_process();				\
-        	timer_update_outstanding();			\
+		timer_run();					\
 	} while (0)
 
 
 extern void	timer_process(void);
 extern void	timer_update_outstanding(void);
+extern void	timer_run(void);
 extern void	timer_reset(void);
+
 extern int	timer_add(void (*callback)(priv_t), priv_t priv,
 			  tmrval_t *count, tmrval_t *enable);
 
+#ifdef EMU_STATE_H
+extern void	timer_state_save(state_t *);
+extern int	timer_state_load(state_t *);
+#endif
+
 
 #endif	/*EMU_TIMER_H*/
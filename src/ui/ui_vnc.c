@@ -10,7 +10,7 @@
  *
  * TODO:	Implement screenshots, and Audio Redirection.
  *
- * Version:	@(#)ui_vnc.c	1.0.15	2021/03/24
+ * Version:	@(#)ui_vnc.c	1.0.17	2026/10/18
  *
  * Author:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Based on raw code by RichardG, <richardg867@gmail.com>
@@ -57,6 +57,7 @@
 #include "../config.h"
 #include "../device.h"
 #include "../plat.h"
+#include "../stats.h"
 #include "../ui/ui.h"
 #if USE_LIBPNG
 # include "../misc/png.h"
@@ -77,6 +78,9 @@
 #define VNC_MIN_Y	200
 #define VNC_MAX_Y	2048
 
+#define VNC_IDLE	8		// unchanged updates before slowing down
+#define VNC_MAX_DELAY	100		// slowest update interval, in ms
+
 
 #if USE_VNC == 1
 # define FUNC(x)	rfb##x
@@ -140,6 +144,16 @@ static int		updatingSize;
 static int		allowedX,
 			allowedY;
 static int		ptr_x, ptr_y, ptr_but;
+static volatile int	vnc_full;		// next update checks all lines
+static int		vnc_idle,		// unchanged updates in a row
+			vnc_delay;		// current minimum update interval
+static uint32_t		vnc_last;		// time of last update
+static uint32_t		vnc_tmp[VNC_MAX_X];
+
+static stats_t		st_updates = STATS_COUNTER("vnc.updates");
+static stats_t		st_skipped = STATS_COUNTER("vnc.skipped");
+static stats_t		st_rects = STATS_COUNTER("vnc.rects");
+static stats_t		st_lines = STATS_COUNTER("vnc.lines");
 
 
 /* Local handlers for VNCserver event logging. */
@@ -230,6 +244,10 @@ vnc_newclient(rfbClientPtr cl)
     cl->clientGoneHook = vnc_clientgone;
 
     vnc_dbglog("new client: %s\n", cl->host);
+
+    /* Make sure they get a fresh screen. */
+    vnc_full = 1;
+
     if (++clients == 1) {
 	/* Reset the mouse. */
 	ptr_x = allowedX/2;
@@ -262,33 +280,150 @@ vnc_display(rfbClientPtr cl)
 
 	allowedX = rfb->width;
 	allowedY = rfb->height;
+
+	/* Whatever was left out so far is in range now. */
+	vnc_full = 1;
     }
 }
 
 
+/*
+ * Update one line of the framebuffer.
+ *
+ * Only the part that actually differs is copied, and its
+ * horizontal extent is added to [*x1, *x2). Returns 1 if
+ * anything changed.
+ */
+static int
+vnc_line(uint32_t *dst, pel_t *src, int w, int *x1, int *x2)
+{
+    const uint32_t *s;
+    int l, r;
+
+    if (config.vid_grayscale || config.invert_display) {
+	video_transform_copy(vnc_tmp, src, w);
+	s = vnc_tmp;
+    } else
+	s = (const uint32_t *)src;
+
+    for (l = 0; (l < w) && (dst[l] == s[l]); l++)
+	;
+    if (l == w)
+	return(0);
+    for (r = w - 1; (r > l) && (dst[r] == s[r]); r--)
+	;
+
+    memcpy(&dst[l], &s[l], (r - l + 1) * 4);
+
+    if (l < *x1)
+	*x1 = l;
+    if (r >= *x2)
+	*x2 = r + 1;
+
+    return(1);
+}
+
+
+/*
+ * Update a range of lines, and tell the server which
+ * areas changed. Runs of changed lines are marked as
+ * one rectangle each.
+ *
+ * Only the area the clients can see is copied, so any
+ * change outside of it is still there to be found (and
+ * marked) once that area grows.
+ */
+static int
+vnc_lines(bitmap_t *scr, int x, int y, int y1, int y2, int w)
+{
+    int yy, x1, x2, top, n = 0;
+
+    if (w > allowedX)
+	w = allowedX;
+    if (y2 > allowedY)
+	y2 = allowedY;
+    if (w <= 0)
+	return(0);
+
+    x1 = w;
+    x2 = 0;
+    top = -1;
+    for (yy = y1; yy <= y2; yy++) {
+	if ((yy < y2) && (yy >= 0) && (yy < VNC_MAX_Y) &&
+	    ((y + yy) >= 0) && ((y + yy) < scr->h) &&
+	    vnc_line(&((uint32_t *)rfb->frameBuffer)[yy * VNC_MAX_X],
+		     &scr->line[y + yy][x], w, &x1, &x2)) {
+		stats_inc(&st_lines);
+		if (top < 0)
+			top = yy;
+		continue;
+	}
+
+	/* End of a run, mark it. */
+	if (top >= 0) {
+		FUNC(MarkRectAsModified)(rfb, x1, top, x2, yy);
+		stats_inc(&st_rects);
+		x1 = w;
+		x2 = 0;
+		top = -1;
+		n++;
+	}
+    }
+
+    return(n);
+}
+
+
 static void
 vnc_blit(bitmap_t *scr, int x, int y, int y1, int y2, int w, int h)
 {
-    uint32_t *p;
-    int yy;
+    const blit_rect_t *r;
+    uint32_t now;
+    int i, n, num;
 
 //INFO("VNC: blit(%i,%i, %i,%i, %i,%i)\n", x,y, y1,y2, w,h);
 
-    for (yy = y1; yy < y2; yy++) {
-	p = (uint32_t *)&(((uint32_t *)rfb->frameBuffer)[yy*VNC_MAX_X]);
-
-	if ((y+yy) >= 0 && (y+yy) < VNC_MAX_Y) {
-		if (config.vid_grayscale || config.invert_display)
-			video_transform_copy(p, &scr->line[y+yy][x], w);
-		  else
-			memcpy(p, &scr->line[y+yy][x], w*4);
-	}
+    if (w > VNC_MAX_X)
+	w = VNC_MAX_X;
+
+    /*
+     * Nobody is watching, a resize is still going on, or they
+     * got an update very recently and the screen has been quiet
+     * since. Skip this frame; the next update will look at the
+     * whole screen.
+     */
+    now = plat_timer_ms();
+    if ((clients == 0) || updatingSize ||
+	((now - vnc_last) < (uint32_t)vnc_delay)) {
+	video_blit_done();
+	vnc_full = 1;
+	stats_inc(&st_skipped);
+	return;
     }
- 
+    vnc_last = now;
+    stats_inc(&st_updates);
+
+    if (vnc_full) {
+	/* Check every line of the screen. */
+	vnc_full = 0;
+	n = vnc_lines(scr, x, y, 0, h, w);
+    } else if ((num = video_blit_get_rects(&r)) > 0) {
+	/* Only the lines the video card actually drew. */
+	for (i = n = 0; i < num; i++)
+		n += vnc_lines(scr, x, y, r[i].y, r[i].y + r[i].h, w);
+    } else
+	n = vnc_lines(scr, x, y, y1, y2, w);
+
     video_blit_done();
 
-    if (! updatingSize)
-	FUNC(MarkRectAsModified)(rfb, 0,0, allowedX,allowedY);
+    /* Slow down while the screen does not change. */
+    if (n > 0) {
+	vnc_idle = 0;
+	vnc_delay = 0;
+    } else if (++vnc_idle >= VNC_IDLE) {
+	vnc_delay = vnc_delay ? MIN(vnc_delay * 2, VNC_MAX_DELAY) : 10;
+	vnc_idle = 0;
+    }
 }
 
 
@@ -403,6 +538,13 @@ vnc_init(int fs)
     video_blit_set(vnc_blit);
 
     clients = 0;
+    vnc_full = 1;
+    vnc_idle = vnc_delay = 0;
+
+    stats_register(&st_updates);
+    stats_register(&st_skipped);
+    stats_register(&st_rects);
+    stats_register(&st_lines);
 
     vnc_dbglog("init complete.\n");
 
@@ -428,7 +570,8 @@ vnc_resize(int x, int y)
 	vnc_dbglog("updating resolution: %dx%d\n", x, y);
  
 	allowedX = (rfb->width < x) ? rfb->width : x;
-	allowedY = (rfb->width < y) ? rfb->width : y;
+	allowedY = (rfb->height < y) ? rfb->height : y;
+	vnc_full = 1;
  
 	rfb->width = x;
 	rfb->height = y;
@@ -0,0 +1,870 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Platform main support module for UNIX (POSIX) systems.
+ *
+ * Version:	@(#)unix.c	1.0.9	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free  Software  Foundation; either  version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is  distributed in the hope that it will be useful, but
+ * WITHOUT   ANY  WARRANTY;  without  even   the  implied  warranty  of
+ * MERCHANTABILITY  or FITNESS  FOR A PARTICULAR  PURPOSE. See  the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the:
+ *
+ *   Free Software Foundation, Inc.
+ *   59 Temple Place - Suite 330
+ *   Boston, MA 02111-1307
+ *   USA.
+ */
+#define UNICODE
+#include <sys/ipc.h>
+#include <sys/sem.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <locale.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <wchar.h>
+#include "../emu.h"
+#include "../version.h"
+#include "../config.h"
+#include "../device.h"
+#include "../ui/ui.h"
+#include "../plat.h"
+#include "../devices/video/video.h"
+#ifdef USE_VNC
+# include "../ui/ui_vnc.h"
+#endif
+#include "unix.h"
+
+
+/* Platform Public data, specific. */
+int		quited;				/* system exit requested */
+
+
+#define MAX_CLONES	64			/* max number of clones */
+#define CLONE_TEST_NUM	2			/* default clones in a test */
+#define CLONE_TEST_TIME	60			/* max seconds for a test */
+
+
+/* Local data. */
+static pthread_mutex_t blit_mutex = PTHREAD_MUTEX_INITIALIZER;
+static thread_t	*thMain;			/* main thread */
+static volatile int save_request;		/* save state requested */
+static volatile int clone_request;		/* clones requested */
+static pid_t	clones[MAX_CLONES];		/* running clones */
+static int	num_clones,
+		last_clone,
+		failed_clones;
+static int	pool_sem = -1;			/* worker pool semaphore */
+
+
+/* The list with supported VidAPI modules. */
+const vidapi_t *plat_vidapis[] = {
+    &none_vidapi,
+
+#ifdef USE_VNC
+    &vnc_vidapi,
+#endif
+
+    NULL
+};
+
+
+/* Convert a wide pathname to the host's multibyte form. */
+static void
+path_to_mb(char *dst, const wchar_t *src, int size)
+{
+    if (wcstombs(dst, src, size) == (size_t)-1)
+	dst[0] = '\0';
+    dst[size - 1] = '\0';
+}
+
+
+/* Stop the emulator on a termination signal. */
+static void
+sig_quit(UNUSED(int sig))
+{
+    quited = 1;
+}
+
+
+/* Ask the main loop to save the machine state. */
+static void
+sig_save(UNUSED(int sig))
+{
+    save_request = 1;
+}
+
+
+/* Ask the main loop to clone the running machine. */
+static void
+sig_clone(UNUSED(int sig))
+{
+    clone_request = 1;
+}
+
+
+/*
+ * Stop using the worker pool.
+ *
+ * The semaphore belongs to the original, so only that removes
+ * it; a clone just forgets about it.
+ */
+static void
+unix_pool_close(void)
+{
+    if ((pool_sem >= 0) && (clone_id == 0))
+	(void)semctl(pool_sem, 0, IPC_RMID);
+
+    pool_sem = -1;
+}
+
+
+/*
+ * Set up the worker pool shared by the original and its clones.
+ *
+ * This is a SysV semaphore counting the free workers. A machine
+ * takes one before it runs a slice, and puts it back afterwards,
+ * so no more than 'num' machines are running at any time, and
+ * whichever one is ready first gets the next free worker.
+ *
+ * Both operations use SEM_UNDO, so if a clone dies while it has
+ * a worker, the kernel gives that worker back to the pool.
+ */
+static void
+unix_pool_init(int num)
+{
+    union semun {
+	int		val;
+	struct semid_ds	*buf;
+	unsigned short	*array;
+    } arg;
+
+    pool_sem = semget(IPC_PRIVATE, 1, IPC_CREAT | 0600);
+    if (pool_sem < 0) {
+	ERRLOG("UNIX: unable to create worker pool: %s\n", strerror(errno));
+	return;
+    }
+
+    arg.val = num;
+    if (semctl(pool_sem, 0, SETVAL, arg) < 0) {
+	ERRLOG("UNIX: unable to fill worker pool: %s\n", strerror(errno));
+	unix_pool_close();
+    }
+}
+
+
+/*
+ * Fork one or more clones of the running machine.
+ *
+ * The machine is paused, and then the process is forked, so
+ * every clone starts out with an exact copy of the machine
+ * state, with the host sharing the guest memory between all
+ * of them until it gets modified.
+ *
+ * Only the calling thread survives a fork, so all other threads
+ * (for the blitter, video, sound, network and so on) are stopped
+ * first, and the host network and sound are closed. After the
+ * fork, both processes start them again through their normal
+ * paths, and each clone starts its own emulator thread. Clones
+ * do not get the host network back. If any thread is left that
+ * we do not know how to stop, we do not clone at all.
+ *
+ * The original stays paused while any of its clones are still
+ * running, so its disk images do not change underneath them.
+ *
+ * Returns 1 in a clone, 0 in the original process.
+ */
+static int
+unix_clone(int num)
+{
+    pid_t pid;
+    int i, id, n;
+
+    if (clone_id != 0) {
+	ERRLOG("UNIX: clone %i can not be cloned again.\n", clone_id);
+	return(0);
+    }
+
+    if ((num_clones + num) > MAX_CLONES)
+	num = MAX_CLONES - num_clones;
+    if (num <= 0) return(0);
+
+    pc_pause(1);
+
+    /* Wait a while for the emulator thread to settle down. */
+    plat_delay_ms(100);
+
+    /* All clones share one pool of workers, if we have one. */
+    if ((clone_workers > 0) && (pool_sem < 0))
+	unix_pool_init(clone_workers);
+
+    /* Stop everything that can not be carried over. */
+    if (! pc_fork_stop()) {
+	pc_pause(0);
+	return(0);
+    }
+    n = thread_count(thMain);
+    if (n > 0) {
+	ERRLOG("UNIX: %i device thread(s) can not be stopped, not cloning!\n", n);
+	pc_fork_start(0);
+	pc_pause(0);
+	return(0);
+    }
+
+    /* Make sure nothing is half-drawn or buffered while forking. */
+    plat_blitter(1);
+    fflush(NULL);
+
+    for (i = 0; i < num; i++) {
+	id = ++last_clone;
+
+	pid = fork();
+	if (pid < 0) {
+		ERRLOG("UNIX: unable to create clone: %s\n", strerror(errno));
+		break;
+	}
+
+	if (pid == 0) {
+		/* We are a clone now. */
+		thread_fork_child();
+		plat_blitter(0);
+		num_clones = 0;
+
+		if (! pc_clone(id))
+			_exit(3);
+
+		pc_fork_start(1);
+
+		thMain = thread_create(pc_thread, &quited);
+
+		pc_pause(0);
+
+		return(1);
+	}
+
+	INFO("UNIX: started clone %i as process %i\n", id, (int)pid);
+	clones[num_clones++] = pid;
+    }
+
+    plat_blitter(0);
+
+    pc_fork_start(0);
+
+    /* If no clones could be started, just carry on. */
+    if (num_clones == 0)
+	pc_pause(0);
+
+    return(0);
+}
+
+
+/* Collect any clones that have exited. */
+static void
+unix_clone_wait(void)
+{
+    int i, status;
+    pid_t pid;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+	for (i = 0; i < num_clones; i++) {
+		if (clones[i] != pid) continue;
+
+		INFO("UNIX: clone process %i exited with status %i\n",
+		     (int)pid, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+		if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+			failed_clones++;
+		clones[i] = clones[--num_clones];
+		break;
+	}
+    }
+
+    /* Once all clones are done, the original can continue. */
+    if (num_clones == 0) {
+	unix_pool_close();
+
+	pc_pause(0);
+    }
+}
+
+
+/*
+ * Quick test of the cloning.
+ *
+ * We start a few clones, let each of them run for a number of
+ * frames and exit, and check that they all do so in time and
+ * without errors. Returns 0 if all went well, 1 if not, or -1
+ * in a clone, which should just carry on running.
+ */
+static int
+unix_clone_test(void)
+{
+    uint32_t start;
+    int i, num;
+
+    num = (clone_count > 0) ? clone_count : CLONE_TEST_NUM;
+    INFO("UNIX: testing %i clones, %i frames each\n", num, clone_test);
+
+    failed_clones = 0;
+    if (unix_clone(num))
+	return(-1);
+
+    /* Any clones we could not start also count as failed. */
+    failed_clones += (num - num_clones);
+
+    start = plat_timer_ms();
+    while ((num_clones > 0) && !quited) {
+	plat_delay_ms(100);
+
+	unix_clone_wait();
+
+	if ((plat_timer_ms() - start) >= (CLONE_TEST_TIME * 1000)) {
+		ERRLOG("UNIX: %i clones did not finish in time!\n", num_clones);
+		for (i = 0; i < num_clones; i++) {
+			(void)kill(clones[i], SIGKILL);
+			(void)waitpid(clones[i], NULL, 0);
+		}
+		failed_clones += num_clones;
+		num_clones = 0;
+	}
+    }
+
+    if (failed_clones > 0) {
+	ERRLOG("UNIX: clone test failed, %i of %i clones failed.\n",
+	       failed_clones, num);
+	return(1);
+    }
+
+    INFO("UNIX: clone test passed.\n");
+
+    return(0);
+}
+
+
+/* For UNIX systems, this is the start of the application. */
+int
+main(int argc, char *argv[])
+{
+    wchar_t **argw;
+    uint32_t old_time, new_time;
+    int i, len;
+
+    /* We need the host locale for the wide/multibyte conversions. */
+    (void)setlocale(LC_ALL, "");
+
+    /* Convert the commandline arguments to wide strings. */
+    argw = (wchar_t **)mem_alloc(sizeof(wchar_t *) * (argc + 1));
+    for (i = 0; i < argc; i++) {
+	len = (int)mbstowcs(NULL, argv[i], 0) + 1;
+	argw[i] = (wchar_t *)mem_alloc(sizeof(wchar_t) * len);
+	mbstowcs(argw[i], argv[i], len);
+    }
+    argw[argc] = NULL;
+
+    /* Initialize the version data. */
+    pc_version("UNIX");
+
+    /*
+     * Set up the basic pathname info for the application.
+     *
+     * We log to stderr, so stdout is free for the guest's
+     * serial ports and such.
+     */
+    (void)pc_setup(0, (wchar_t **)stderr);
+
+    /* There is no window, so never start fullscreen. */
+    config.vid_fullscreen = 0;
+
+    /* Set the (only) language we have. */
+    (void)ui_lang_set(0x0409);
+
+    /* Set up standard emulator stuff, read config file. */
+    if (pc_setup(argc, argw) <= 0)
+	return(1);
+
+    /* There is no settings dialog in headless mode. */
+    if (settings_only) {
+	ERRLOG("UNIX: no settings dialog available in this version!\n");
+	return(1);
+    }
+
+    /* Now set up the machine. */
+    switch (pc_init()) {
+	case 1:		// all good
+		break;
+
+	case 2:		// configuration error, user wants to re-config
+		ERRLOG("UNIX: please fix the configuration file first.\n");
+		/*FALLTHROUGH*/
+
+	default:	// general failure, or user wants to exit
+		return(2);
+    }
+
+    /* Initialize the configured Video API, or fall back to none. */
+    if (! vidapi_set(config.vid_api)) {
+	ERRLOG("UNIX: renderer '%s' not available, using 'none'.\n",
+	       vidapi_get_internal_name(config.vid_api));
+	if (! vidapi_set(0))
+		return(5);
+    }
+
+    /* Fire up the machine. */
+    pc_reset_hard_init();
+
+    /* Set the PAUSE mode depending on the renderer. */
+    pc_pause(0);
+
+    /* Make sure we can be stopped cleanly. */
+    signal(SIGINT, sig_quit);
+    signal(SIGTERM, sig_quit);
+#ifdef SIGHUP
+    signal(SIGHUP, sig_quit);
+#endif
+    signal(SIGUSR1, sig_save);
+    signal(SIGUSR2, sig_clone);
+
+    /* Start the main thread to do the real work. */
+    plat_start();
+
+    /* If requested, run clones of the machine right away. */
+    if (clone_test > 0) {
+	i = unix_clone_test();
+	if (i >= 0) {
+		plat_stop();
+		return((i > 0) ? 6 : 0);
+	}
+    } else if (clone_count > 0)
+	(void)unix_clone(clone_count);
+
+    /* All we do here is drive the once-per-second updates. */
+    old_time = plat_timer_ms();
+    while (! quited) {
+	plat_delay_ms(100);
+
+	/* Save the machine state if asked to. */
+	if (save_request) {
+		save_request = 0;
+		if (state_path[0] != L'\0')
+			(void)pc_save_state(state_path);
+		  else
+			ERRLOG("UNIX: no state file configured, not saved.\n");
+	}
+
+	/* Clone the running machine if asked to. */
+	if (clone_request) {
+		clone_request = 0;
+		(void)unix_clone((clone_count > 0) ? clone_count : 1);
+	}
+
+	/* Keep an eye on our clones, if we have any. */
+	if (num_clones > 0)
+		unix_clone_wait();
+
+	new_time = plat_timer_ms();
+	if ((new_time - old_time) >= 1000) {
+		pc_onesec();
+		old_time += 1000;
+	}
+    }
+
+    /* Stop any clones we still have. */
+    for (i = 0; i < num_clones; i++)
+	(void)kill(clones[i], SIGTERM);
+    while (num_clones > 0) {
+	if (waitpid(clones[--num_clones], NULL, 0) < 0)
+		break;
+    }
+    unix_pool_close();
+
+    /* Close down the emulator. */
+    plat_stop();
+
+    return(0);
+}
+
+
+/*
+ * We do this here since there is platform-specific stuff
+ * going on here, and we do it in a function separate from
+ * main() so we can call it from the UI module as well.
+ */
+void
+plat_start(void)
+{
+    /* We have not stopped yet. */
+    quited = 0;
+
+    /* Start the emulator, really. */
+    thMain = thread_create(pc_thread, &quited);
+}
+
+
+/* Cleanly stop the emulator. */
+void
+plat_stop(void)
+{
+    quited = 1;
+
+    /* Wait a while for things to shut down. */
+    plat_delay_ms(100);
+
+    /* Now close down the virtual machine. */
+    pc_close(thMain);
+    thMain = NULL;
+}
+
+
+void
+plat_get_exe_name(wchar_t *bufp, int size)
+{
+    char temp[PATH_MAX];
+    ssize_t i;
+
+    i = readlink("/proc/self/exe", temp, sizeof(temp) - 1);
+    if (i < 0)
+	i = 0;
+    temp[i] = '\0';
+
+    mbstowcs(bufp, temp, size);
+    bufp[size - 1] = L'\0';
+}
+
+
+void
+plat_tempfile(wchar_t *bufp, const wchar_t *prefix, const wchar_t *suffix)
+{
+    struct timespec ts;
+    struct tm *info;
+    char temp[1024];
+
+    if (prefix != NULL)
+	sprintf(temp, "%ls-", prefix);
+      else
+	strcpy(temp, "");
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    info = localtime(&ts.tv_sec);
+    strftime(&temp[strlen(temp)], 32, "%Y%m%d-%H%M%S", info);
+    sprintf(&temp[strlen(temp)], "-%03ld%ls",
+	    ts.tv_nsec / 1000000L, suffix);
+    mbstowcs(bufp, temp, strlen(temp)+1);
+}
+
+
+int
+plat_getcwd(wchar_t *bufp, int max)
+{
+    char temp[PATH_MAX];
+
+    if (getcwd(temp, sizeof(temp)) == NULL)
+	temp[0] = '\0';
+    mbstowcs(bufp, temp, max);
+
+    return(0);
+}
+
+
+int
+plat_chdir(const wchar_t *path)
+{
+    char temp[PATH_MAX];
+
+    path_to_mb(temp, path, sizeof(temp));
+
+    return(chdir(temp));
+}
+
+
+/* Open a file, using Unicode pathname. */
+FILE *
+plat_fopen(const wchar_t *path, const wchar_t *mode)
+{
+    char temp[PATH_MAX], tmode[16];
+
+    path_to_mb(temp, path, sizeof(temp));
+    path_to_mb(tmode, mode, sizeof(tmode));
+
+    return(fopen(temp, tmode));
+}
+
+
+/* Open a file, using Unicode pathname, with 64bit pointers. */
+FILE *
+plat_fopen64(const wchar_t *path, const wchar_t *mode)
+{
+    char temp[PATH_MAX], tmode[16];
+
+    path_to_mb(temp, path, sizeof(temp));
+    path_to_mb(tmode, mode, sizeof(tmode));
+
+#if defined(__linux__) && defined(_LARGEFILE64_SOURCE)
+    return(fopen64(temp, tmode));
+#else
+    return(fopen(temp, tmode));
+#endif
+}
+
+
+void
+plat_remove(const wchar_t *path)
+{
+    char temp[PATH_MAX];
+
+    path_to_mb(temp, path, sizeof(temp));
+
+    (void)remove(temp);
+}
+
+
+/* Make sure a path ends with a trailing slash. */
+void
+plat_append_slash(wchar_t *path)
+{
+    if (path[wcslen(path)-1] != L'/')
+	wcscat(path, L"/");
+}
+
+
+/* Check if the given path is absolute or not. */
+int
+plat_path_abs(const wchar_t *path)
+{
+    return(path[0] == L'/');
+}
+
+
+/* Return the last element of a pathname. */
+wchar_t *
+plat_get_basename(const wchar_t *path)
+{
+    int c = (int)wcslen(path);
+
+    while (c > 0) {
+	if (path[c] == L'/')
+	   return((wchar_t *)&path[c]);
+       c--;
+    }
+
+    return((wchar_t *)path);
+}
+
+
+/* Return the 'directory' element of a pathname. */
+void
+plat_get_dirname(wchar_t *dest, const wchar_t *path)
+{
+    int c = (int)wcslen(path);
+    wchar_t *ptr;
+
+    ptr = (wchar_t *)path;
+
+    while (c > 0) {
+	if (path[c] == L'/') {
+		ptr = (wchar_t *)&path[c];
+		break;
+	}
+ 	c--;
+    }
+
+    /* Copy to destination. */
+    while (path < ptr)
+	*dest++ = *path++;
+    *dest = L'\0';
+}
+
+
+wchar_t *
+plat_get_filename(const wchar_t *path)
+{
+    int c = (int)wcslen(path) - 1;
+
+    while (c > 0) {
+	if (path[c] == L'/')
+	   return((wchar_t *)&path[c+1]);
+       c--;
+    }
+
+    return((wchar_t *)path);
+}
+
+
+wchar_t *
+plat_get_extension(const wchar_t *path)
+{
+    int c = (int)wcslen(path) - 1;
+
+    if (c <= 0)
+	return((wchar_t *)path);
+
+    while (c && path[c] != L'.')
+		c--;
+
+    if (!c)
+	return((wchar_t *)&path[wcslen(path)]);
+
+    return((wchar_t *)&path[c+1]);
+}
+
+
+void
+plat_append_filename(wchar_t *dest, const wchar_t *s1, const wchar_t *s2)
+{
+    dest[0] = L'\0';
+
+    wcscat(dest, s1);
+    plat_append_slash(dest);
+    wcscat(dest, s2);
+}
+
+
+int
+plat_dir_check(const wchar_t *path)
+{
+    char temp[PATH_MAX];
+    struct stat st;
+
+    path_to_mb(temp, path, sizeof(temp));
+
+    if (stat(temp, &st) != 0)
+	return(0);
+
+    return(S_ISDIR(st.st_mode) ? 1 : 0);
+}
+
+
+int
+plat_dir_create(const wchar_t *path)
+{
+    char temp[PATH_MAX];
+
+    path_to_mb(temp, path, sizeof(temp));
+
+    return(mkdir(temp, 0755) == 0);
+}
+
+
+/* Read the high-precision timer, in nanoseconds. */
+uint64_t
+plat_timer_read(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return(((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec);
+}
+
+
+uint32_t
+plat_timer_ms(void)
+{
+    static uint64_t start = 0;
+
+    if (start == 0) {
+	start = plat_timer_read();
+	DEBUG("UNIX: main timer precision: 1000000000\n");
+    }
+
+    return((uint32_t)((plat_timer_read() - start) / 1000000ULL));
+}
+
+
+void
+plat_delay_ms(uint32_t count)
+{
+    struct timespec ts;
+
+    ts.tv_sec = count / 1000;
+    ts.tv_nsec = (long)(count % 1000) * 1000000L;
+
+    while (nanosleep(&ts, &ts) != 0)
+	;
+}
+
+
+void
+plat_blitter(int own)
+{
+    if (own)
+	pthread_mutex_lock(&blit_mutex);
+    else
+	pthread_mutex_unlock(&blit_mutex);
+}
+
+
+/*
+ * Take a worker from the pool for a slice, or give it back.
+ *
+ * If the pool stops working for some reason (such as the original
+ * removing it), we stop using it, and just run as if there was
+ * none. We only ever give back a worker we actually took, so no
+ * workers appear out of nowhere.
+ */
+void
+plat_slice(int begin)
+{
+    static int have_token = 0;
+    struct sembuf op;
+    int i;
+
+    if (pool_sem < 0) return;
+
+    if (!begin && !have_token) return;
+
+    op.sem_num = 0;
+    op.sem_op = begin ? -1 : 1;
+    op.sem_flg = SEM_UNDO;
+    while (((i = semop(pool_sem, &op, 1)) < 0) && (errno == EINTR))
+	;
+    if (i == 0) {
+	have_token = begin;
+	return;
+    }
+    have_token = 0;
+
+    ERRLOG("UNIX: worker pool failed (%s), no longer using it.\n",
+	   strerror(errno));
+    unix_pool_close();
+}
+
+
+/*
+ * Get number of VidApi entries.
+ *
+ * This has to be in this module because only we know
+ * the actual size of the plat_vidapis[] array. Not a
+ * nice way to do it, but so it is...
+ */
+int
+vidapi_count(void)
+{
+    return((sizeof(plat_vidapis)/sizeof(vidapi_t *)) - 1);
+}
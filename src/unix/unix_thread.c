@@ -0,0 +1,379 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Implement threads and mutexes for POSIX (pthreads) platforms.
+ *
+ * Version:	@(#)unix_thread.c	1.0.5	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free  Software  Foundation; either  version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is  distributed in the hope that it will be useful, but
+ * WITHOUT   ANY  WARRANTY;  without  even   the  implied  warranty  of
+ * MERCHANTABILITY  or FITNESS  FOR A PARTICULAR  PURPOSE. See  the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the:
+ *
+ *   Free Software Foundation, Inc.
+ *   59 Temple Place - Suite 330
+ *   Boston, MA 02111-1307
+ *   USA.
+ */
+#define _GNU_SOURCE			/* for pthread_timedjoin_np */
+#include <pthread.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <wchar.h>
+#include "../emu.h"
+#include "../plat.h"
+
+
+typedef struct _thread {
+    pthread_t		thread;
+
+    void		(*func)(void *);
+    void		*param;
+    volatile int	done;			// function has returned
+
+    struct _thread	*next;
+} unix_thread_t;
+
+/* Win32-style auto-reset event. */
+typedef struct _event {
+    pthread_cond_t	cond;
+    pthread_mutex_t	mutex;
+    int			state;
+} unix_event_t;
+
+typedef struct _mutex {
+    pthread_mutex_t	mutex;
+} unix_mutex_t;
+
+
+/*
+ * We keep track of the threads we create, so we can check
+ * that they were all stopped before the process forks.
+ */
+static pthread_mutex_t	list_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unix_thread_t	*threads;
+
+
+/* Remove an item from one of the lists. */
+#define LIST_REMOVE(head, type, item)					\
+    do {								\
+	type **pp;							\
+	pthread_mutex_lock(&list_mutex);				\
+	for (pp = &(head); *pp != NULL; pp = &(*pp)->next) {		\
+		if (*pp == (item)) {					\
+			*pp = (item)->next;				\
+			break;						\
+		}							\
+	}								\
+	pthread_mutex_unlock(&list_mutex);				\
+    } while (0)
+
+#define LIST_ADD(head, item)						\
+    do {								\
+	pthread_mutex_lock(&list_mutex);				\
+	(item)->next = (head);						\
+	(head) = (item);						\
+	pthread_mutex_unlock(&list_mutex);				\
+    } while (0)
+
+
+/* Convert a relative timeout (in msec) to an absolute time. */
+static void
+abs_time(struct timespec *ts, int timeout)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+
+    ts->tv_sec += timeout / 1000;
+    ts->tv_nsec += (long)(timeout % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+	ts->tv_nsec -= 1000000000L;
+	ts->tv_sec++;
+    }
+}
+
+
+static void *
+thread_run(void *arg)
+{
+    unix_thread_t *thr = (unix_thread_t *)arg;
+
+    thr->func(thr->param);
+
+    thr->done = 1;
+
+    return(NULL);
+}
+
+
+static void
+mutex_init(pthread_mutex_t *mutex)
+{
+    pthread_mutexattr_t attr;
+
+    /* Win32 mutexes can be re-entered by their owner. */
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+
+thread_t *
+thread_create(void (*func)(void *param), void *param)
+{
+    unix_thread_t *thr = (unix_thread_t *)mem_alloc(sizeof(unix_thread_t));
+
+    thr->func = func;
+    thr->param = param;
+    thr->done = 0;
+
+    if (pthread_create(&thr->thread, NULL, thread_run, thr) != 0) {
+	free(thr);
+	return(NULL);
+    }
+
+    LIST_ADD(threads, thr);
+
+    return((thread_t *)thr);
+}
+
+
+void
+thread_kill(thread_t *arg)
+{
+    unix_thread_t *thr = (unix_thread_t *)arg;
+
+    if (arg == NULL) return;
+
+    pthread_cancel(thr->thread);
+    pthread_join(thr->thread, NULL);
+
+    LIST_REMOVE(threads, unix_thread_t, thr);
+
+    free(thr);
+}
+
+
+int
+thread_wait(thread_t *arg, int timeout)
+{
+    unix_thread_t *thr = (unix_thread_t *)arg;
+#ifdef __linux__
+    struct timespec ts;
+#endif
+
+    if (arg == NULL) return(0);
+
+#ifdef __linux__
+    if (timeout != -1) {
+	abs_time(&ts, timeout);
+	if (pthread_timedjoin_np(thr->thread, NULL, &ts) != 0) return(1);
+	LIST_REMOVE(threads, unix_thread_t, thr);
+	free(thr);
+	return(0);
+    }
+#endif
+
+    if (pthread_join(thr->thread, NULL) != 0) return(1);
+    LIST_REMOVE(threads, unix_thread_t, thr);
+    free(thr);
+
+    return(0);
+}
+
+
+event_t *
+thread_create_event(void)
+{
+    unix_event_t *ev = (unix_event_t *)mem_alloc(sizeof(unix_event_t));
+
+    pthread_cond_init(&ev->cond, NULL);
+    pthread_mutex_init(&ev->mutex, NULL);
+    ev->state = 0;
+
+    return((event_t *)ev);
+}
+
+
+void
+thread_set_event(event_t *arg)
+{
+    unix_event_t *ev = (unix_event_t *)arg;
+
+    if (arg == NULL) return;
+
+    pthread_mutex_lock(&ev->mutex);
+    ev->state = 1;
+    pthread_cond_signal(&ev->cond);
+    pthread_mutex_unlock(&ev->mutex);
+}
+
+
+void
+thread_reset_event(event_t *arg)
+{
+    unix_event_t *ev = (unix_event_t *)arg;
+
+    if (arg == NULL) return;
+
+    pthread_mutex_lock(&ev->mutex);
+    ev->state = 0;
+    pthread_mutex_unlock(&ev->mutex);
+}
+
+
+int
+thread_wait_event(event_t *arg, int timeout)
+{
+    unix_event_t *ev = (unix_event_t *)arg;
+    struct timespec ts;
+    int ret = 0;
+
+    if (arg == NULL) return(0);
+
+    if (timeout != -1)
+	abs_time(&ts, timeout);
+
+    pthread_mutex_lock(&ev->mutex);
+    while (! ev->state) {
+	if (timeout == -1)
+		ret = pthread_cond_wait(&ev->cond, &ev->mutex);
+	  else
+		ret = pthread_cond_timedwait(&ev->cond, &ev->mutex, &ts);
+	if (ret == ETIMEDOUT) break;
+    }
+
+    /* Auto-reset, like the Win32 events we emulate. */
+    if (ev->state) {
+	ev->state = 0;
+	ret = 0;
+    }
+    pthread_mutex_unlock(&ev->mutex);
+
+    return(ret ? 1 : 0);
+}
+
+
+void
+thread_destroy_event(event_t *arg)
+{
+    unix_event_t *ev = (unix_event_t *)arg;
+
+    if (arg == NULL) return;
+
+    pthread_cond_destroy(&ev->cond);
+    pthread_mutex_destroy(&ev->mutex);
+
+    free(ev);
+}
+
+
+mutex_t *
+thread_create_mutex(UNUSED(const wchar_t *name))
+{
+    unix_mutex_t *mtx;
+
+    mtx = (unix_mutex_t *)mem_alloc(sizeof(unix_mutex_t));
+
+    mutex_init(&mtx->mutex);
+
+    return((mutex_t *)mtx);
+}
+
+
+void
+thread_close_mutex(mutex_t *mutex)
+{
+    unix_mutex_t *mtx = (unix_mutex_t *)mutex;
+
+    if (mutex == NULL) return;
+
+    pthread_mutex_destroy(&mtx->mutex);
+
+    free(mtx);
+}
+
+
+int
+thread_wait_mutex(mutex_t *mutex)
+{
+    if (mutex == NULL) return(0);
+
+    if (pthread_mutex_lock(&((unix_mutex_t *)mutex)->mutex) == 0) return(1);
+
+    return(0);
+}
+
+
+int
+thread_release_mutex(mutex_t *mutex)
+{
+    if (mutex == NULL) return(0);
+
+    return(pthread_mutex_unlock(&((unix_mutex_t *)mutex)->mutex) == 0);
+}
+
+
+/*
+ * Count the threads that are still running, not counting 'skip'.
+ *
+ * Only the thread calling fork() survives in the child process,
+ * so all other threads must have been stopped (by their owners,
+ * through their normal shutdown paths) before forking. This lets
+ * the caller check that this was actually done.
+ */
+int
+thread_count(thread_t *skip)
+{
+    unix_thread_t *thr;
+    int n = 0;
+
+    pthread_mutex_lock(&list_mutex);
+    for (thr = threads; thr != NULL; thr = thr->next) {
+	if ((thr != (unix_thread_t *)skip) && !thr->done)
+		n++;
+    }
+    pthread_mutex_unlock(&list_mutex);
+
+    return(n);
+}
+
+
+/*
+ * Forget all threads of the parent in the child process after a
+ * fork(). None of them exist here, and the caller will start any
+ * threads it needs through the normal paths.
+ */
+void
+thread_fork_child(void)
+{
+    unix_thread_t *thr;
+
+    pthread_mutex_init(&list_mutex, NULL);
+
+    while ((thr = threads) != NULL) {
+	threads = thr->next;
+	free(thr);
+    }
+}
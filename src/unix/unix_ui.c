@@ -0,0 +1,483 @@
+/*
+ * VARCem	Virtual ARchaeological Computer EMulator.
+ *		An emulator of (mostly) x86-based PC systems and devices,
+ *		using the ISA,EISA,VLB,MCA  and PCI system buses, roughly
+ *		spanning the era between 1981 and 1995.
+ *
+ *		This file is part of the VARCem Project.
+ *
+ *		Implement the (headless) User Interface module for UNIX.
+ *
+ *		There is no window, menu or status bar; all requests for
+ *		those are silently ignored, and message boxes are written
+ *		to the console. Questions are always answered with "no",
+ *		so the emulator never waits for a user who is not there.
+ *
+ * Version:	@(#)unix_ui.c	1.0.2	2026/10/18
+ *
+ * Author:	agent, <agent@local>
+ *
+ *		Copyright 2026 agent.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free  Software  Foundation; either  version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is  distributed in the hope that it will be useful, but
+ * WITHOUT   ANY  WARRANTY;  without  even   the  implied  warranty  of
+ * MERCHANTABILITY  or FITNESS  FOR A PARTICULAR  PURPOSE. See  the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the:
+ *
+ *   Free Software Foundation, Inc.
+ *   59 Temple Place - Suite 330
+ *   Boston, MA 02111-1307
+ *   USA.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include "../emu.h"
+#include "../version.h"
+#include "../ui/ui.h"
+#include "../plat.h"
+#include "../devices/input/game/joystick.h"
+#include "../devices/ports/serial.h"
+#include "../devices/video/video.h"
+#include "unix.h"
+
+
+/* The strings table, built from the default language file. */
+#include "../ui/lang/VARCem.str"
+#define STRTBL(id,str)	{ id, L"" str },
+
+static const string_t strings[] = {
+#include "../ui/lang/VARCem.def"
+    { 0, NULL }
+};
+
+
+static wchar_t	wtitle[512];
+
+
+/* Discard the rendered frame, and tell the video core we are done. */
+static void
+none_blit(bitmap_t *b, int x, int y, int y1, int y2, int w, int h)
+{
+    video_blit_done();
+}
+
+
+static int
+none_init(int fs)
+{
+    video_blit_set(none_blit);
+
+    return(1);
+}
+
+
+static void
+none_close(void)
+{
+    video_blit_set(NULL);
+}
+
+
+static int
+none_available(void)
+{
+    return(1);
+}
+
+
+const vidapi_t none_vidapi = {
+    "none",
+    "None (headless)",
+    1,
+    none_init, none_close, NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    none_available
+};
+
+
+/* Show a message on the console. */
+int
+ui_msgbox(int flags, const void *arg)
+{
+    wchar_t temp[512];
+    const wchar_t *str;
+    const char *cap;
+    int ret = 0;
+
+    switch(flags & 0x1f) {
+	case MBX_WARNING:	/* warning message */
+		cap = "Warning";
+		ret = 1;
+		break;
+
+	case MBX_ERROR:		/* error message */
+		cap = (flags & MBX_FATAL) ? "Fatal Error" : "Error";
+		break;
+
+	case MBX_QUESTION:	/* question */
+		cap = "Question";
+		ret = 1;
+		break;
+
+	case MBX_CONFIG:	/* configuration */
+		cap = "Configuration Error";
+		ret = 1;
+		break;
+
+	case MBX_INFO:		/* just an informational message */
+	default:
+		cap = EMU_NAME;
+		break;
+    }
+
+    /* If ANSI string, convert it. */
+    str = (const wchar_t *)arg;
+    if (flags & MBX_ANSI) {
+	mbstowcs(temp, (const char *)arg, sizeof_w(temp));
+	temp[sizeof_w(temp) - 1] = L'\0';
+	str = temp;
+    } else if (((uintptr_t)arg) < ((uintptr_t)65636ULL)) {
+	/* Low values are string ID's, not pointers. */
+	str = get_string((int)((intptr_t)arg & 0xffff));
+    }
+
+    fprintf(stderr, "%s: %ls\n", cap, (str != NULL) ? str : L"");
+    if (ret)
+	fprintf(stderr, "%s: answering \"no\".\n", cap);
+
+    return(ret);
+}
+
+
+/* Set the window title (we just remember it.) */
+wchar_t *
+ui_window_title(const wchar_t *s)
+{
+    if (s != NULL) {
+	wcsncpy(wtitle, s, sizeof_w(wtitle) - 1);
+	wtitle[sizeof_w(wtitle) - 1] = L'\0';
+    }
+
+    return(wtitle);
+}
+
+
+void
+ui_plat_reset(void)
+{
+}
+
+
+void
+ui_resize(int x, int y)
+{
+}
+
+
+void
+ui_show_cursor(int on)
+{
+}
+
+
+void
+ui_show_render(int on)
+{
+}
+
+
+void
+menu_add_item(int idm, int type, int id, const wchar_t *str)
+{
+}
+
+
+void
+menu_enable_item(int idm, int val)
+{
+}
+
+
+void
+menu_set_item(int idm, int val)
+{
+}
+
+
+void
+menu_set_radio_item(int idm, int num, int val)
+{
+}
+
+
+void
+sb_setup(int parts, const sbpart_t *data)
+{
+}
+
+
+void
+sb_set_icon(int part, int icon)
+{
+}
+
+
+void
+sb_set_text(int part, const wchar_t *str)
+{
+}
+
+
+void
+sb_set_tooltip(int part, const wchar_t *str)
+{
+}
+
+
+void
+sb_menu_create(int part)
+{
+}
+
+
+void
+sb_menu_add_item(int part, int idm, const wchar_t *str)
+{
+}
+
+
+void
+sb_menu_enable_item(int part, int idm, int val)
+{
+}
+
+
+void
+sb_menu_set_item(int part, int idm, int val)
+{
+}
+
+
+void
+dlg_about(void)
+{
+    fprintf(stderr, "%s %s\n", EMU_NAME, emu_fullversion);
+}
+
+
+void
+dlg_localize(void)
+{
+}
+
+
+/* No settings dialog, so tell the caller nothing was changed. */
+int
+dlg_settings(int ask)
+{
+    return(0);
+}
+
+
+void
+dlg_new_image(int drive, int part, int is_zip, int is_mo)
+{
+}
+
+
+void
+dlg_sound_gain(void)
+{
+}
+
+
+/* No file dialog, so always behave as if "Cancel" was clicked. */
+int
+dlg_file(const wchar_t *filt, const wchar_t *ifn, wchar_t *fn, int save)
+{
+    return(0);
+}
+
+
+void
+plat_mouse_capture(int on)
+{
+}
+
+
+void
+plat_fullscreen(int on)
+{
+}
+
+
+int
+plat_get_kbd_state(void)
+{
+    return(0);
+}
+
+
+void
+plat_set_kbd_state(int flags)
+{
+}
+
+
+/* We only have the built-in language. */
+void
+plat_lang_scan(void)
+{
+    lang_t lang;
+
+    memset(&lang, 0x00, sizeof(lang));
+    lang.id = 0x0409;
+    ui_lang_add(&lang, 0);
+}
+
+
+void
+plat_lang_set(int id)
+{
+}
+
+
+const string_t *
+plat_lang_load(lang_t *ptr)
+{
+    return(strings);
+}
+
+
+void
+joystick_init(void)
+{
+}
+
+
+void
+joystick_close(void)
+{
+}
+
+
+void
+joystick_process(void)
+{
+}
+
+
+void
+plat_midi_init(void)
+{
+}
+
+
+void
+plat_midi_close(void)
+{
+}
+
+
+void
+plat_midi_play_msg(uint8_t *msg)
+{
+}
+
+
+void
+plat_midi_play_sysex(uint8_t *sysex, unsigned int len)
+{
+}
+
+
+int
+plat_midi_write(uint8_t val)
+{
+    return(0);
+}
+
+
+int
+plat_midi_get_num_devs(void)
+{
+    return(0);
+}
+
+
+void
+plat_midi_get_dev_name(int num, char *s)
+{
+    *s = '\0';
+}
+
+
+priv_t
+plat_serial_open(const char *port, int tmo)
+{
+    ERRLOG("UNIX: host serial port '%s' not supported!\n", port);
+
+    return(NULL);
+}
+
+
+void
+plat_serial_close(priv_t arg)
+{
+}
+
+
+int
+plat_serial_active(priv_t arg, int flg)
+{
+    return(0);
+}
+
+
+int
+plat_serial_params(priv_t arg, char dbit, char par, char sbit)
+{
+    return(0);
+}
+
+
+int
+plat_serial_flush(priv_t arg)
+{
+    return(0);
+}
+
+
+int
+plat_serial_speed(priv_t arg, long speed)
+{
+    return(0);
+}
+
+
+int
+plat_serial_write(priv_t arg, uint8_t val)
+{
+    return(0);
+}
+
+
+int
+plat_serial_read(priv_t arg, uint8_t *bufp, int max)
+{
+    return(0);
+}
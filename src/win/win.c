@@ -8,7 +8,7 @@
  *
  *		Platform main support module for Windows.
  *
- * Version:	@(#)win.c	1.0.35	2021/02/18
+ * Version:	@(#)win.c	1.0.36	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -589,6 +589,13 @@ plat_blitter(int own)
 }
 
 
+/* We run just one machine, so there is no worker pool. */
+void
+plat_slice(UNUSED(int begin))
+{
+}
+
+
 /*
  * Get number of VidApi entries.
  *
@@ -8,7 +8,7 @@
  *
  *		Rendering module for Microsoft Direct3D 9.
  *
- * Version:	@(#)win_d3d.cpp	1.0.21	2021/03/18
+ * Version:	@(#)win_d3d.cpp	1.0.22	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -169,15 +169,58 @@ d3d_size(RECT w_rect, double *l, double *t, double *r, double *b, int w, int h)
 }
 
 
+/*
+ * Upload the screen buffer to the texture.
+ *
+ * The texture keeps its contents, so only the lines the video
+ * card says it drew are locked and copied, or all of y1..y2 if
+ * it did not say. Returns 0 if the texture could not be locked.
+ */
+static int
+d3d_upload(bitmap_t *scr, int x, int y, int y1, int y2, int w)
+{
+    const blit_rect_t *rects;
+    D3DLOCKED_RECT dr;
+    RECT r;
+    uint32_t *dst;
+    int i, num, yy;
+
+    num = video_blit_get_rects(&rects);
+    for (i = 0; i < (num ? num : 1); i++) {
+	r.top    = num ? MAX(rects[i].y, y1) : y1;
+	r.left   = 0;
+	r.bottom = num ? MIN(rects[i].y + rects[i].h, y2) : y2;
+	r.right  = 2047;
+	if (r.top >= r.bottom) continue;
+
+	if (d3dTexture->LockRect(0, &dr, &r, 0) != D3D_OK)
+		return(0);
+
+	for (yy = r.top; yy < r.bottom; yy++) {
+		if (scr == NULL) break;
+		if ((y + yy) < 0 || (y + yy) >= scr->h) continue;
+
+		dst = (uint32_t *)((uintptr_t)dr.pBits + ((yy - r.top) * dr.Pitch));
+		if (config.vid_grayscale || config.invert_display)
+			video_transform_copy(dst, &scr->line[yy + y][x], w);
+		else
+			memcpy(dst, &scr->line[yy + y][x], w * 4);
+	}
+
+	d3dTexture->UnlockRect(0);
+    }
+
+    return(1);
+}
+
+
 static void
 d3d_blit_fs(bitmap_t *scr, int x, int y, int y1, int y2, int w, int h)
 {
     HRESULT hr = D3D_OK;
     HRESULT hbsr = D3D_OK;
     VOID* pVoid = 0;
-    D3DLOCKED_RECT dr;
     RECT w_rect;
-    int yy;
     double l = 0, t = 0, r = 0, b = 0;
 
     if (! is_enabled) {
@@ -190,33 +233,12 @@ d3d_blit_fs(bitmap_t *scr, int x, int y, int y1, int y2, int w, int h)
 	return; /*Nothing to do*/
     }
 
-    if (hr == D3D_OK && !(y1 == 0 && y2 == 0)) {
-	RECT lock_rect;
-
-	lock_rect.top    = y1;
-	lock_rect.left   = 0;
-	lock_rect.bottom = y2;
-	lock_rect.right  = 2047;
-
-	hr = d3dTexture->LockRect(0, &dr, &lock_rect, 0);
-	if (hr == D3D_OK) {
-		for (yy = y1; yy < y2; yy++) {
-			if (scr) {
-				if (config.vid_grayscale || config.invert_display)
-					video_transform_copy((uint32_t *)((uintptr_t)dr.pBits + ((yy - y1) * dr.Pitch)), &scr->line[yy + y][x], w);
-				else
-					memcpy((void *)((uintptr_t)dr.pBits + ((yy - y1) * dr.Pitch)), &scr->line[yy + y][x], w * 4);
-			}
-		}
-
-		video_blit_done();
-		d3dTexture->UnlockRect(0);
-	} else {
-		video_blit_done();
-		return;
-	}
-    } else
+    if (! d3d_upload(scr, x, y, y1, y2, w)) {
 	video_blit_done();
+	return;
+    }
+
+    video_blit_done();
 
     d3d_verts[0].tu = d3d_verts[2].tu = d3d_verts[3].tu = 0;
     d3d_verts[0].tv = d3d_verts[3].tv = d3d_verts[4].tv = 0;
@@ -294,9 +316,7 @@ d3d_blit(bitmap_t *b, int x, int y, int y1, int y2, int w, int h)
     HRESULT hr = D3D_OK;
     HRESULT hbsr = D3D_OK;
     VOID* pVoid = 0;
-    D3DLOCKED_RECT dr;
     RECT r;
-    int yy;
 
     if (! is_enabled) {
 	video_blit_done();
@@ -308,31 +328,13 @@ d3d_blit(bitmap_t *b, int x, int y, int y1, int y2, int w, int h)
 	return; /*Nothing to do*/
     }
 
-    r.top    = y1;
-    r.left   = 0;
-    r.bottom = y2;
-    r.right  = 2047;
-
-    hr = d3dTexture->LockRect(0, &dr, &r, 0);
-    if (hr == D3D_OK) {	
-	for (yy = y1; yy < y2; yy++) {
-		if (b) {
-			if ((y + yy) >= 0 && (y + yy) < screen->h) {
-				if (config.vid_grayscale || config.invert_display)
-					video_transform_copy((uint32_t *)((uintptr_t)dr.pBits + ((yy - y1) * dr.Pitch)), &b->line[yy + y][x], w);
-				else
-					memcpy((void *)((uintptr_t)dr.pBits + ((yy - y1) * dr.Pitch)), &b->line[yy + y][x], w * 4);
-			}
-		}
-	}
-
-	video_blit_done();
-	d3dTexture->UnlockRect(0);
-    } else {
+    if (! d3d_upload(b, x, y, y1, y2, w)) {
 	video_blit_done();
 	return;
     }
 
+    video_blit_done();
+
     d3d_verts[0].tu = d3d_verts[2].tu = d3d_verts[3].tu = 0;//0.5 / 2048.0;
     d3d_verts[0].tv = d3d_verts[3].tv = d3d_verts[4].tv = 0;//0.5 / 2048.0;
     d3d_verts[1].tu = d3d_verts[4].tu = d3d_verts[5].tu = (float)w / 2048.0f;
@@ -8,7 +8,7 @@
  *
  *		Rendering module for Microsoft DirectDraw 9.
  *
- * Version:	@(#)win_ddraw.cpp	1.0.24	2021/03/18
+ * Version:	@(#)win_ddraw.cpp	1.0.25	2026/10/18
  *
  * Authors:	Fred N. van Kempen, <decwiz@yahoo.com>
  *		Miran Grca, <mgrca8@gmail.com>
@@ -228,6 +228,40 @@ ddraw_fs_size(RECT w_rect, RECT *r_dest, int w, int h)
 }
 
 
+/*
+ * Copy the screen buffer to the locked surface.
+ *
+ * The surface keeps its contents, so only the lines the video
+ * card says it drew are copied, or all of y1..y2 if it did not
+ * say.
+ */
+static void
+ddraw_copy(bitmap_t *scr, DDSURFACEDESC2 *ddsd, int x, int y, int y1, int y2, int w)
+{
+    const blit_rect_t *r;
+    int i, num, yy, ys, ye;
+    uint32_t *dst;
+
+    if (scr == NULL) return;
+
+    num = video_blit_get_rects(&r);
+    for (i = 0; i < (num ? num : 1); i++) {
+	ys = num ? MAX(r[i].y, y1) : y1;
+	ye = num ? MIN(r[i].y + r[i].h, y2) : y2;
+
+	for (yy = ys; yy < ye; yy++) {
+		if ((y + yy) < 0 || (y + yy) >= scr->h) continue;
+
+		dst = (uint32_t *)((uintptr_t)ddsd->lpSurface + (yy * ddsd->lPitch));
+		if (config.vid_grayscale || config.invert_display)
+			video_transform_copy(dst, &scr->line[y + yy][x], w);
+		else
+			memcpy(dst, &scr->line[y + yy][x], w * 4);
+	}
+    }
+}
+
+
 static void
 ddraw_blit_fs(bitmap_t *scr, int x, int y, int y1, int y2, int w, int h)
 {
@@ -235,7 +269,6 @@ ddraw_blit_fs(bitmap_t *scr, int x, int y, int y1, int y2, int w, int h)
     RECT r_src, r_dest, w_rect;
     DDBLTFX ddbltfx;
     HRESULT hr;
-    int yy;
 
     if (! is_enabled) {
 	video_blit_done();
@@ -263,14 +296,7 @@ ddraw_blit_fs(bitmap_t *scr, int x, int y, int y1, int y2, int w, int h)
 	return;
     }
 
-    for (yy = y1; yy < y2; yy++) {
-	if (scr) {
-		if (config.vid_grayscale || config.invert_display)
-			video_transform_copy((uint32_t *)((uintptr_t)ddsd.lpSurface + (yy * ddsd.lPitch)), &scr->line[y + yy][x], w);
-		else
-			memcpy((void *)((uintptr_t)ddsd.lpSurface + (yy * ddsd.lPitch)), &scr->line[y + yy][x], w * 4);
-	}
-    }
+    ddraw_copy(scr, &ddsd, x, y, y1, y2, w);
 
     video_blit_done();
 
@@ -314,7 +340,6 @@ ddraw_blit(bitmap_t *scr, int x, int y, int y1, int y2, int w, int h)
     RECT r_src, r_dest;
     HRESULT hr;
     POINT po;
-    int yy;
 
     if (! is_enabled) {
 	video_blit_done();
@@ -343,16 +368,7 @@ ddraw_blit(bitmap_t *scr, int x, int y, int y1, int y2, int w, int h)
 	return;
     }
 
-    for (yy = y1; yy < y2; yy++) {
-	if (scr) {
-		if ((y + yy) >= 0 && (y + yy) < scr->h) {
-			if (config.vid_grayscale || config.invert_display)
-				video_transform_copy((uint32_t *) &(((uint8_t *) ddsd.lpSurface)[yy * ddsd.lPitch]), &scr->line[y + yy][x], w);
-			else
-				memcpy((uint32_t *) &(((uint8_t *) ddsd.lpSurface)[yy * ddsd.lPitch]), &scr->line[y + yy][x], w * 4);
-		}
-	}
-    }
+    ddraw_copy(scr, &ddsd, x, y, y1, y2, w);
 
     video_blit_done();
 